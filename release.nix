@@ -23,6 +23,8 @@ let
         "^src/algo/.*\.?pp"
         "^src/external"
         "^src/external/.*\.?pp"
+        "^src/bench"
+        "^src/bench/.*\.?pp"
         "^meson\.build"
       ];
       mesonFlags = []
@@ -4,6 +4,7 @@
 
 #include "../pempek_assert.hpp"
 #include <fstream>
+#include <limits>
 #include <chrono>
 #include <ctime>
 #include "../json_workload.hpp"
@@ -46,6 +47,8 @@ ConservativeBackfilling::ConservativeBackfilling(Workload *workload, SchedulingD
 
 ConservativeBackfilling::~ConservativeBackfilling()
 {
+    //the speculative worker may still be compressing the schedule
+    end_speculation(-1, {});
 }
 
 void ConservativeBackfilling::on_start_from_checkpoint(double date,const rapidjson::Value & batsim_event){
@@ -127,6 +130,13 @@ void ConservativeBackfilling::on_requested_call(double date,batsched_tools::CALL
         case batsched_tools::call_me_later_types::CHECKPOINT_BATSCHED:
             _need_to_checkpoint = true;
             break;
+        case batsched_tools::call_me_later_types::WAKE_UP:
+        case batsched_tools::call_me_later_types::MONITORING_STAGE:
+            //requested by the energy variants only
+            break;
+        case batsched_tools::call_me_later_types::DECISION_QUANTUM:
+            //handled by the drivers, see on_decision_quantum_call
+            break;
         }
         //sometimes we get back a call me later at the wrong time, this handles that
         double difference = _decision->remove_call_me_later(cml_in,date,_workload);
@@ -139,10 +149,34 @@ void ConservativeBackfilling::on_requested_call(double date,batsched_tools::CALL
 }
 
 
+bool ConservativeBackfilling::needs_decisions(double date)
+{
+    if (decisions_triggered())
+        return true;
+    //killed jobs are resubmitted and rescheduled over several calls, and reservations start on their own
+    if (_killed_jobs || !_resubmitted_jobs.empty() || _start_a_reservation)
+        return true;
+    //a planned job can only start once the present leaves the first time slice
+    if (_schedule.nb_slices() > 1 && Rational(date) >= _schedule.begin()->end)
+        return true;
+    return schedule_notifications_due(date);
+}
+
+double ConservativeBackfilling::next_forced_decision_date(double date)
+{
+    (void) date;
+    if (_schedule.nb_slices() > 1)
+        return (double)_schedule.begin()->end;
+    return std::numeric_limits<double>::infinity();
+}
+
 void ConservativeBackfilling::make_decisions(double date,
                                              SortableJobOrder::UpdateInformation *update_info,
                                              SortableJobOrder::CompareInformation *compare_info)
 {
+    //a precomputed compression is only kept for the plain completion it was computed for
+    if (_compression.pending && !compression_matches(date))
+        drop_compression();
     if (_exit_make_decisions)
     {   
         _exit_make_decisions = false;     
@@ -401,11 +435,7 @@ LOG_F(INFO,"here");
     }
     
 
-    _decision->add_generic_notification("queue_size",std::to_string(_queue->nb_jobs()),date);
-    _decision->add_generic_notification("schedule_size",std::to_string(_schedule.size()),date);
-    _decision->add_generic_notification("number_running_jobs",std::to_string(_schedule.get_number_of_running_jobs()),date);
-    _decision->add_generic_notification("utilization",std::to_string(_schedule.get_utilization()),date);
-    _decision->add_generic_notification("utilization_no_resv",std::to_string(_schedule.get_utilization_no_resv()),date);
+    ISchedulingAlgorithm::send_schedule_notifications(date);
 }
 
 
@@ -504,6 +534,11 @@ auto sort_original_submit = [](const Job * j1,const Job * j2)->bool{
         //     Take the decision to run j now
         if (_output_svg == "all")
             _schedule.output_to_svg("CONSERVATIVE_BF  " + std::string( _need_to_compress? "needed":"") + " compress");
+        if (adopt_compression(date))
+        {
+            _need_to_compress = false;
+            return;
+        }
         int scheduled = 0;
         for (auto job_it = _queue->begin(); job_it != _queue->end(); )
         {
@@ -551,6 +586,133 @@ auto sort_original_submit = [](const Job * j1,const Job * j2)->bool{
 
 
 
+void ConservativeBackfilling::speculate(double date)
+{
+    (void) date;
+    if (_speculative_worker == nullptr || _compression.pending || _speculative_worker->started())
+        return;
+    //only the plain completion path is precomputed: nothing else may be going on
+    if (_output_svg != "none" || _queue->is_empty() || _killed_jobs || !_resubmitted_jobs.empty() ||
+        _start_a_reservation || checkpoint_under_way() || _schedule.in_transaction())
+        return;
+
+    //the expected event is the completion of the running jobs that end first, at their walltime
+    _compression.ended_jobs.clear();
+    auto first_slice = _schedule.begin();
+    for (auto slice = first_slice; slice != _schedule.end() && _compression.ended_jobs.empty(); ++slice)
+    {
+        auto next_slice = std::next(slice);
+        for (const auto & allocated : first_slice->allocated_jobs)
+            if (next_slice == _schedule.end() || !next_slice->contains_job(allocated.first))
+                _compression.ended_jobs.insert(allocated.first->id);
+        _compression.date = slice->end.convert_to<double>();
+    }
+    if (_compression.ended_jobs.empty())
+        return;
+    _compression.queue.clear();
+    _compression.started.clear();
+    _nb_speculations++;
+    _speculative_worker->start([this](const std::atomic<bool> & cancelled)
+    {
+        return compress_speculatively(cancelled);
+    });
+}
+
+void ConservativeBackfilling::end_speculation(double date, const std::vector<std::string> & completed_jobs)
+{
+    if (_speculative_worker == nullptr)
+        return;
+    //a compression kept for a message that was not decided is stale once the next one comes
+    if (_compression.pending)
+        drop_compression();
+    if (!_speculative_worker->started())
+        return;
+    bool expected = date == _compression.date &&
+                    std::set<std::string>(completed_jobs.begin(), completed_jobs.end()) == _compression.ended_jobs;
+    //a cancelled compression rolls its transaction back itself
+    bool done = _speculative_worker->finish(!expected);
+    if (done && expected)
+        _compression.pending = true;
+    else if (done)
+        _schedule.rollback();
+}
+
+bool ConservativeBackfilling::compress_speculatively(const std::atomic<bool> & cancelled)
+{
+    //the same steps as make_decisions on the completion of the ended jobs, queue sorting aside
+    _schedule.begin_transaction();
+    for (const std::string & ended_job_id : _compression.ended_jobs)
+        _schedule.remove_job_if_exists((*_workload)[ended_job_id]);
+    _schedule.update_first_slice(_compression.date);
+    int scheduled = 0;
+    for (auto job_it = _queue->begin(); job_it != _queue->end(); ++job_it)
+    {
+        if (_workload->_queue_depth != -1 && scheduled >= _workload->_queue_depth)
+            break;
+        if (cancelled)
+        {
+            _schedule.rollback();
+            return false;
+        }
+        const Job * job = (*job_it)->job;
+        _compression.queue.push_back(job);
+        _schedule.remove_job_if_exists(job);
+        JobAlloc alloc = _schedule.add_job_first_fit(job, _selector, false);
+        if (!alloc.used_machines.is_empty())
+        {
+            if (alloc.started_in_first_slice)
+                _compression.started.push_back({job, alloc.used_machines});
+            else
+                scheduled++;
+        }
+    }
+    return true;
+}
+
+bool ConservativeBackfilling::compression_matches(double date) const
+{
+    return date == _compression.date && _decision_triggers == TRIGGER_QUEUE && !checkpoint_under_way() &&
+           !_killed_jobs && _resubmitted_jobs.empty() && !_start_a_reservation && _jobs_released_recently.empty() &&
+           _jobs_killed_recently.empty() &&
+           std::set<std::string>(_jobs_ended_recently.begin(), _jobs_ended_recently.end()) == _compression.ended_jobs;
+}
+
+void ConservativeBackfilling::drop_compression()
+{
+    _schedule.rollback();
+    _compression.pending = false;
+}
+
+bool ConservativeBackfilling::adopt_compression(double date)
+{
+    if (!_compression.pending)
+        return false;
+    _compression.pending = false;
+    //the queue was sorted again since, the compression holds if it goes through the same jobs
+    auto job_it = _queue->begin();
+    for (const Job * job : _compression.queue)
+    {
+        if (job_it == _queue->end() || (*job_it)->job != job)
+        {
+            //back to the schedule make_decisions had before the compression
+            _schedule.rollback();
+            for (const std::string & ended_job_id : _jobs_ended_recently)
+                _schedule.remove_job_if_exists((*_workload)[ended_job_id]);
+            _schedule.update_first_slice(date);
+            return false;
+        }
+        ++job_it;
+    }
+    _schedule.commit();
+    for (const auto & started : _compression.started)
+    {
+        _decision->add_execute_job(started.first->id, started.second, date);
+        _queue->remove_job(started.first);
+    }
+    _nb_speculation_hits++;
+    return true;
+}
+
 void ConservativeBackfilling::handle_killed_jobs(std::vector<std::string> & recently_queued_jobs, double date)
 {
     auto sort_original_submit = [](const Job * j1,const Job * j2)->bool{
@@ -682,7 +844,8 @@ void ConservativeBackfilling::handle_killed_jobs(std::vector<std::string> & rece
                         batsched_tools::CALL_ME_LATERS cml;
                         cml.forWhat = batsched_tools::call_me_later_types::RESERVATION_START;
                         cml.id = _decision->get_nb_call_me_laters();
-                        cml.extra_data = batsched_tools::string_format("{\"job_id\":'%s'}",reservation.job->id);
+                        cml.job_id = reservation.job->id;
+                        cml.extra_data = batsched_tools::string_format("{\"job_id\":\"%s\"}",reservation.job->id.c_str());
                         _decision->add_call_me_later(date,reservation.job->start,cml);
                     }
                     else if (reservation.alloc->started_in_first_slice)
@@ -792,7 +955,8 @@ void ConservativeBackfilling::handle_killed_jobs(std::vector<std::string> & rece
                         batsched_tools::CALL_ME_LATERS cml;
                         cml.forWhat = batsched_tools::call_me_later_types::RESERVATION_START;
                         cml.id = _decision->get_nb_call_me_laters();
-                        cml.extra_data = batsched_tools::string_format("{\"job_id\":\"%s\"}",reservation.job->id);
+                        cml.job_id = reservation.job->id;
+                        cml.extra_data = batsched_tools::string_format("{\"job_id\":\"%s\"}",reservation.job->id.c_str());
                         _decision->add_call_me_later(date,reservation.job->start,cml);
                     }
                     else if (reservation.alloc->started_in_first_slice)
@@ -928,7 +1092,8 @@ void ConservativeBackfilling::handle_reservations(std::vector<std::string> & rec
                         batsched_tools::CALL_ME_LATERS cml;
                         cml.forWhat = batsched_tools::call_me_later_types::RESERVATION_START;
                         cml.id = _decision->get_nb_call_me_laters();
-                        cml.extra_data = batsched_tools::string_format("{'job_id':'%s'}",reservation.job->id);
+                        cml.job_id = reservation.job->id;
+                        cml.extra_data = batsched_tools::string_format("{\"job_id\":\"%s\"}",reservation.job->id.c_str());
                         _decision->add_call_me_later(date,reservation.job->start,cml);
                     }
                     else
@@ -1063,7 +1228,8 @@ void ConservativeBackfilling::handle_reservations(std::vector<std::string> & rec
                         batsched_tools::CALL_ME_LATERS cml;
                         cml.forWhat = batsched_tools::call_me_later_types::RESERVATION_START;
                         cml.id = _decision->get_nb_call_me_laters();
-                        cml.extra_data = batsched_tools::string_format("{'job_id':'%s'}",reservation.job->id);
+                        cml.job_id = reservation.job->id;
+                        cml.extra_data = batsched_tools::string_format("{\"job_id\":\"%s\"}",reservation.job->id.c_str());
                         _decision->add_call_me_later(date,reservation.job->start,cml);
                     }
                     else
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <list>
+#include <set>
 
 #include "../isalgorithm.hpp"
 #include "../external/pointers.hpp"
@@ -35,16 +36,46 @@ public:
     virtual void make_decisions(double date,
                                 SortableJobOrder::UpdateInformation * update_info,
                                 SortableJobOrder::CompareInformation * compare_info);
+    /**
+     * @brief False when no event can change the schedule and the present is still in its first time slice
+     */
+    virtual bool needs_decisions(double date);
+    /**
+     * @brief The end of the first time slice: the schedule cannot be updated past it without make_decisions
+     */
+    virtual double next_forced_decision_date(double date);
     virtual void on_checkpoint_batsched(double date);
     virtual void on_ingest_variables(const rapidjson::Document & doc,double date);
     virtual void on_first_jobs_submitted(double date);
+    /**
+     * @brief Precomputes the compression of the schedule for the completion of the running jobs that end first
+     */
+    virtual void speculate(double date);
+    virtual void end_speculation(double date, const std::vector<std::string> & completed_jobs);
 
 private:
+    //a compression of the schedule computed in a schedule transaction, while waiting for the next message
+    struct CompressionSpeculation
+    {
+        bool pending = false; //!< the compression is done and the schedule still in its transaction
+        double date = -1; //!< the expected completion date
+        std::set<std::string> ended_jobs; //!< the jobs expected to complete
+        std::vector<const Job *> queue; //!< the queued jobs the compression went through, in order
+        std::vector<std::pair<const Job *, IntervalSet>> started; //!< the jobs the compression starts
+    };
+
+    bool compress_speculatively(const std::atomic<bool> & cancelled);
+    bool compression_matches(double date) const;
+    void drop_compression();
+    bool adopt_compression(double date);
+
     void handle_killed_jobs(std::vector<std::string> & recently_queued_jobs,double date);
     void handle_reservations(std::vector<std::string> & recently_released_reservations,
                             std::vector<std::string>& recently_queued_jobs,
                             double date);
     void handle_schedule(std::vector<std::string>& recently_queued_jobs,double date);
+
+    CompressionSpeculation _compression;
     
     
 
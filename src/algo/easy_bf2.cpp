@@ -123,6 +123,13 @@ void EasyBackfilling2::on_requested_call(double date,batsched_tools::CALL_ME_LAT
             case batsched_tools::call_me_later_types::CHECKPOINT_BATSCHED:
                 _need_to_checkpoint = true;
                 break;
+            case batsched_tools::call_me_later_types::WAKE_UP:
+            case batsched_tools::call_me_later_types::MONITORING_STAGE:
+                //requested by the energy variants only
+                break;
+            case batsched_tools::call_me_later_types::DECISION_QUANTUM:
+                //handled by the drivers, see on_decision_quantum_call
+                break;
         }
 
 
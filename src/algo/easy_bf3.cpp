@@ -37,12 +37,8 @@ void EasyBackfilling3::on_simulation_start(double date, const rapidjson::Value &
     _nb_available_machines = _nb_machines;
     PPK_ASSERT_ERROR(_available_machines.size() == (unsigned int) _nb_machines);
 
-    /* @note LH: total number of jobs in queue/schedule will be at most the number of machines.
-        Removing the memory reservations will decrease performance and it is worth noting that
-        both the schedule and queue are pointer vectors, so reserved memory will be negligible */
-    _scheduled_jobs.reserve(_nb_machines);
-    _waiting_jobs.reserve(_nb_machines);
-
+    // @note the queue policy is only known once the simulation starts, before any job is queued
+    _waiting_jobs.set_original_order(_queue_policy == "ORIGINAL-FCFS");
 }
 
 void EasyBackfilling3::on_simulation_end(double date)
@@ -130,6 +126,13 @@ void EasyBackfilling3::on_requested_call(double date,batsched_tools::CALL_ME_LAT
         case batsched_tools::call_me_later_types::CHECKPOINT_BATSCHED:
             _need_to_checkpoint = true;
             break;
+        case batsched_tools::call_me_later_types::WAKE_UP:
+        case batsched_tools::call_me_later_types::MONITORING_STAGE:
+            //requested by the energy variants only
+            break;
+        case batsched_tools::call_me_later_types::DECISION_QUANTUM:
+            //handled by the drivers, see on_decision_quantum_call
+            break;
     }
 }
 
@@ -153,7 +156,7 @@ void EasyBackfilling3::on_no_more_static_job_to_submit_received(double date){
 void EasyBackfilling3::on_start_from_checkpoint(double date,const rapidjson::Value & batsim_event)
 {
     ISchedulingAlgorithm::on_start_from_checkpoint_normal(date,batsim_event);
-    
+    _waiting_jobs.set_original_order(_queue_policy == "ORIGINAL-FCFS");
 }
 
 void EasyBackfilling3::on_checkpoint_batsched(double date){
@@ -166,11 +169,11 @@ void EasyBackfilling3::on_checkpoint_batsched(double date){
         <<"{\n";
         CLOG_F(CCU_DEBUG,"Checkpointing _waiting_jobs");
         f<<std::fixed<<std::setprecision(15)<<std::boolalpha
-        <<"\t\"_waiting_jobs\":"                << batsched_tools::vector_to_json_string(_waiting_jobs,false)         <<","<<std::endl;
+        <<"\t\"_waiting_jobs\":"                << batsched_tools::vector_to_json_string(_waiting_jobs.to_vector(),false)         <<","<<std::endl;
 
         CLOG_F(CCU_DEBUG,"Checkpointing _scheduled_jobs");
         f<<std::fixed<<std::setprecision(15)<<std::boolalpha
-        <<"\t\"_scheduled_jobs\":"              << batsched_tools::vector_to_json_string(_scheduled_jobs)       <<","<<std::endl;
+        <<"\t\"_scheduled_jobs\":"              << batsched_tools::vector_to_json_string(_scheduled_jobs.to_vector())       <<","<<std::endl;
 
         CLOG_F(CCU_DEBUG,"Checkpointing _tmp_job");
         
@@ -214,13 +217,21 @@ void EasyBackfilling3::on_ingest_variables(const rapidjson::Document & doc,doubl
     CLOG_F(CCU_DEBUG,"here");
     //ingestM(_waiting_jobs,easy_bf3Doc,easy_bf3Doc);
     CLOG_F(CCU_DEBUG,"here");
-    ingestM(_scheduled_jobs,easy_bf3Doc,easy_bf3Doc);
+    PPK_ASSERT_ERROR(easy_bf3Doc.HasMember("_scheduled_jobs"),"ingesting 'easy_bf3Doc' failed, no '_scheduled_jobs' in json");
+    _scheduled_jobs.clear();
+    for (batsched_tools::Scheduled_Job * sj : ingest(std::vector<batsched_tools::Scheduled_Job *>(),easy_bf3Doc["_scheduled_jobs"]))
+        _scheduled_jobs.insert(sj);
     CLOG_F(CCU_DEBUG,"here");
     ingestM(_tmp_job,easy_bf3Doc,easy_bf3Doc);
     CLOG_F(CCU_DEBUG,"here");
     ingestM(_p_job,easy_bf3Doc,easy_bf3Doc);
     CLOG_F(CCU_DEBUG,"here");
     ingestM(_can_run,easy_bf3Doc,easy_bf3Doc);
+    // @note the jobs that were running are executed again, they must not wait in the queue as well
+    for (auto pair : _workload->get_jobs())
+        if (pair.second->checkpoint_job_data->state == batsched_tools::JobState::JOB_STATE_RUNNING &&
+            delete_waiting_job(pair.first))
+            CLOG_F(CCU_DEBUG,"job is being removed from _waiting_jobs: %s",pair.first.c_str());
     ISchedulingAlgorithm::execute_jobs_in_running_state(date);  
 
 }
@@ -228,7 +239,7 @@ void EasyBackfilling3::on_ingest_variables(const rapidjson::Document & doc,doubl
 void EasyBackfilling3::on_first_jobs_submitted(double date){}
 std::string EasyBackfilling3::queue_to_string()
 {
-    return batsched_tools::vector_to_json_string(_waiting_jobs,false);
+    return batsched_tools::vector_to_json_string(_waiting_jobs.to_vector(),false);
     
 }
 /*********************************************************
@@ -303,7 +314,7 @@ void EasyBackfilling3::make_decisions(double date,
         }
         else
         {
-            _waiting_jobs.push_back(new_job);
+            _waiting_jobs.insert(new_job);
             recently_queued_jobs.push_back(new_job_id);
         }
     }
@@ -339,7 +350,7 @@ void EasyBackfilling3::make_decisions(double date,
 
                 if(_can_run){
                     _decision->add_execute_job(new_job_id, _tmp_job->allocated_machines, date);
-                    _waiting_jobs.erase(wj_it);
+                    delete_waiting_job(wj_it);
                     _reject_possible = false;
                     _repairs_done = 0;
                 }
@@ -353,7 +364,7 @@ void EasyBackfilling3::make_decisions(double date,
         auto job_it = _waiting_jobs.begin();
         while (job_it != _waiting_jobs.end() && _nb_available_machines > 0)
         {
-            Job * job = *job_it;
+            Job * job = job_it->job;
 
             if(job == priority_job_after) check_priority_job(job, date);
             else check_backfill_job(job, date);
@@ -380,7 +391,7 @@ void EasyBackfilling3::make_decisions(double date,
             for (auto iter = _waiting_jobs.begin();iter != _waiting_jobs.end();)
             {
 
-                _decision->add_reject_job(date,(*iter)->id,batsched_tools::REJECT_TYPES::NOT_ENOUGH_AVAILABLE_RESOURCES);
+                _decision->add_reject_job(date,iter->job->id,batsched_tools::REJECT_TYPES::NOT_ENOUGH_AVAILABLE_RESOURCES);
                 iter = _waiting_jobs.erase(iter);
             }
         }
@@ -401,15 +412,17 @@ void EasyBackfilling3::make_decisions(double date,
     _decision->add_generic_notification("utilization",to_string(NOTIFY_MACHINE_UTIL), date);
 }
 
+bool EasyBackfilling3::needs_decisions(double date)
+{
+    (void) date;
+    return decisions_triggered() || _need_to_backfill || !_my_kill_jobs.empty();
+}
+
 void EasyBackfilling3::sort_queue_while_handling_priority_job(Job * priority_job_before,
                                                              Job *& priority_job_after,
                                                              SortableJobOrder::UpdateInformation * update_info)
 {
-    // @note LH: set how queue should compare jobs
-    CompareQueue compare(_queue_policy == "ORIGINAL-FCFS");
-    // @note LH: sort the queue
-    heap_sort_queue(_waiting_jobs.size(), compare);
-
+    // @note the waiting jobs are kept sorted as they are queued, there is nothing to sort here
     // Let the new priority job be computed
     priority_job_after = get_first_waiting_job();
 
@@ -526,149 +539,33 @@ void EasyBackfilling3::handle_scheduled_job(const Job * job, double date){
     _tmp_job->start_time = date;
     _tmp_job->est_finish_time = date + tmp_walltime;
     _tmp_job->allocated_machines = _available_machines.left(job->nb_requested_resources);
-    // @note add the job to the schedule
-    _scheduled_jobs.push_back(_tmp_job);
+    // @note add the job to the schedule, in order of estimated finish time
+    _scheduled_jobs.insert(_tmp_job);
 
     // @note remove allocated nodes from intervalset and subtract from machine count
     _available_machines -= _tmp_job->allocated_machines;
     _nb_available_machines -= _tmp_job->requested_resources;
-    heap_sort_schedule(_scheduled_jobs.size());
 }
 
 //@note LH: added function that handles deallocating finished jobs
 void EasyBackfilling3::handle_finished_job(string job_id, double date){
     // @note LH: get finished job from schedule
-    auto fj_it = find_if(_scheduled_jobs.begin(), _scheduled_jobs.end(), 
-        [job_id](batsched_tools::Scheduled_Job *sj){ 
-            return (sj->id == job_id);
-    });
+    auto fj_it = _scheduled_jobs.find(job_id);
 
-    // @note LH: if the job exists, find it, and retrieve it
+    // @note LH: if the job exists, retrieve it
     if(fj_it != _scheduled_jobs.end()){
-        auto fj_idx = distance(_scheduled_jobs.begin(), fj_it);
-        _tmp_job = _scheduled_jobs.at(fj_idx);
-        
+        batsched_tools::Scheduled_Job * finished_job = *fj_it;
+
         // @note LH: return allocated machines to intervalset and add to machine count
-        _available_machines.insert(_tmp_job->allocated_machines - _repair_machines);
+        _available_machines.insert(finished_job->allocated_machines - _repair_machines);
         _nb_available_machines = _available_machines.size();
 
-        // @note deallocate finished job struct
-        delete _tmp_job;
+        // @note the schedule deallocates the finished job struct
         _tmp_job=nullptr;
-        // @note LH: delete the job pointer in the schedule
         _scheduled_jobs.erase(fj_it);
     }
 }
 
-/*********************************************************
- *         SCHEDULE & QUEUE HEAP SORT ADDITIONS          *
-**********************************************************/
-
-//@note LH: added helper sub-function to turn schedule into a maximum heap
-void EasyBackfilling3::max_heapify_schedule(int root, int size){
-    // @note find the max root node, left node, and right node
-    int max = root, left = (2 * root) + 1, right = left + 1;
-
-    // @note LH: if left exists -AND- left is more than max, set left as new max
-    if (left < size && _scheduled_jobs[left]->est_finish_time > _scheduled_jobs[max]->est_finish_time){
-        max = left;
-    }
-
-    // @note LH: if right exists -AND- right is more than max, set right as new max
-    if (right < size && _scheduled_jobs[right]->est_finish_time  > _scheduled_jobs[max]->est_finish_time){
-        max = right;
-    }
-
-    // @note swap[max_root(max),last_node(size)] and continue sorting
-    if (max != root) {
-        swap(_scheduled_jobs[root], _scheduled_jobs[max]);
-        max_heapify_schedule(max, size);
-    }
-}
-
-//@note LH: added heaper function for heap sorting the schedule
-void EasyBackfilling3::heap_sort_schedule(int size){
-    //@note LH: no need to sort if there is less than 2 jobs
-    if(size < 2) return;
-
-    // @note LH: build the new max heap
-    for(int i = (size/2)-1; i >= 0; --i){
-        max_heapify_schedule(i, size);
-    }
-
-    // @note LH: sort the new max heap
-    for(int j = size-1; j >= 0; --j){
-        swap(_scheduled_jobs[0], _scheduled_jobs[j]);
-        max_heapify_schedule(0, j);
-    }
-}
-
-// @note LH: added helper function to set if queue should sort by orginal submission times 
-EasyBackfilling3::CompareQueue::CompareQueue(bool compare_original) : compare_original(compare_original) {}
-
-inline bool EasyBackfilling3::CompareQueue::operator()(Job* jobA, Job* jobB) const {
-    // @note LH: get the numeric part of a jobs id string 
-    auto extractNumericId = [](const std::string& str_id) {
-        size_t pos1 = str_id.find('!') + 1;
-        size_t pos2 = str_id.find_first_not_of("0123456789", pos1);
-        return std::stoi(str_id.substr(pos1, pos2 - pos1));
-    };
-    //original submit has to do with real checkpointing.  submission_times[0] has to do with simulated checkpointing
-    // @note LH: compare_orginal is true if _queue_policy is "ORIGINAL_FCFS"
-    if (compare_original) {
-        // @note LH: if submission times are the same, sort by id 
-        if (jobA->submission_times[0] == jobB->submission_times[0]) {
-            return extractNumericId(jobA->id) > extractNumericId(jobB->id);
-        }
-         // @note LH: otherwise sort by subbmission time
-        return jobA->submission_times[0] > jobB->submission_times[0];
-    } else {
-        if (jobA->original_submit == jobB->original_submit) {
-            return extractNumericId(jobA->id) > extractNumericId(jobB->id);
-        }
-        return jobA->original_submit > jobB->original_submit;
-    }
-}
-
-//@note LH: added helper sub-function to turn the queue into a maximum heap
-void EasyBackfilling3::max_heapify_queue(int root, int size, const CompareQueue &comp){  
-    // @note LH: find the max root node, left node, and right node
-    int max = root, left = (2 * root) + 1, right = left + 1;
-
-    // @note LH: if left exists -AND- left is more than max, set left as new max
-    if (left < size && comp(_waiting_jobs[left], _waiting_jobs[max])) {
-        max = left;
-    }
-
-    // @note LH: if right exists -AND- right is more than max, set right as new max
-    if (right < size && comp(_waiting_jobs[right], _waiting_jobs[max])) {
-        max = right;
-    }
-
-    // @note swap[max_root(max),last_node(size)] and continue sorting
-    if (max != root) {
-        swap(_waiting_jobs[root], _waiting_jobs[max]);
-        max_heapify_queue(max, size, comp);
-    }
-}
-
-//@note LH: added helper function for heap sorting the queue
-void EasyBackfilling3::heap_sort_queue(int size, const CompareQueue &comp){
-    //@note LH: no need to sort if there is less than 2 jobs
-    if(size < 2) return;
-
-    // @note LH: build the new max heap
-    for(int i = (size/2)-1; i >= 0; --i){
-        max_heapify_queue(i, size, comp);
-    }
-
-    // @note LH: sort the new max heap
-    for(int j = size-1; j >= 0; --j){
-        swap(_waiting_jobs[0], _waiting_jobs[j]);
-        max_heapify_queue(0, j, comp);
-    }
-}
-
 /*********************************************************
  *              QUEUE REPLACEMENT ADDITIONS              *
 **********************************************************/
@@ -681,8 +578,8 @@ Job * EasyBackfilling3::get_first_waiting_job(){
     {
         for(auto iter=_waiting_jobs.begin();iter != _waiting_jobs.end();iter++)
         {
-            if ((*iter)->nb_requested_resources <= (_nb_machines - _repair_machines.size()))
-                return (*iter);
+            if (iter->job->nb_requested_resources <= (_nb_machines - _repair_machines.size()))
+                return iter->job;
             else
                 continue;
         }
@@ -692,22 +589,16 @@ Job * EasyBackfilling3::get_first_waiting_job(){
 }
 
 //@note LH: added helper function to find and return waiting job iterator 
-vector<Job *>::iterator EasyBackfilling3::find_waiting_job(string job_id){
-    auto iter = find_if(_waiting_jobs.begin(), _waiting_jobs.end(), [job_id](Job *wj){ 
-        return wj->id == job_id;
-    });
-    return iter;
+WaitingJobs::iterator EasyBackfilling3::find_waiting_job(const string & job_id){
+    return _waiting_jobs.find(job_id);
 }
 
 //@note LH: added overloaded helper function to delete waiting job by string id
-vector<Job *>::iterator EasyBackfilling3::delete_waiting_job(string wjob_id){
-    vector<Job *>::iterator wj_it = find_waiting_job(wjob_id);
-    return delete_waiting_job(wj_it);
+bool EasyBackfilling3::delete_waiting_job(const string & wjob_id){
+    return _waiting_jobs.erase(wjob_id);
 }
 
-//@note LH: added overloaded helper function to delete waiting job by list iterator
-vector<Job *>::iterator EasyBackfilling3::delete_waiting_job(vector<Job *>::iterator wj_iter){
+//@note LH: added overloaded helper function to delete waiting job by iterator
+WaitingJobs::iterator EasyBackfilling3::delete_waiting_job(WaitingJobs::iterator wj_iter){
     return _waiting_jobs.erase(wj_iter);
 }
-
-
@@ -9,6 +9,7 @@
 //added
 #include "../machine.hpp"
 #include "../batsched_tools.hpp"
+#include "../job_lists.hpp"
 #include <random>
 #include <regex>
 
@@ -36,6 +37,11 @@ public:
     virtual void make_decisions(double date,
                                 SortableJobOrder::UpdateInformation * update_info,
                                 SortableJobOrder::CompareInformation * compare_info);
+    /**
+     * @brief False when no event can change the decisions: the jobs only start on submissions, ends and
+     *        machine changes
+     */
+    virtual bool needs_decisions(double date);
     void sort_queue_while_handling_priority_job(Job * priority_job_before,
                                                 Job *& priority_job_after,
                                                 SortableJobOrder::UpdateInformation * update_info);
@@ -62,26 +68,20 @@ protected:
     void handle_finished_job(std::string job_id, double date);
 
     // @note LH: Additions for replacing the queue class
-    struct CompareQueue{
-        bool compare_original;
-        CompareQueue(bool compare_original = false);
-        inline bool operator()(Job* jobA, Job* jobB) const;
-    };
-    void max_heapify_queue(int root, int size, const CompareQueue& comp);
-    void heap_sort_queue(int size, const CompareQueue& comp);
-    
-    std::vector<Job *>::iterator find_waiting_job(std::string job_id);
-    std::vector<Job *>::iterator delete_waiting_job(std::vector<Job *>::iterator wj_iter);
-    std::vector<Job *>::iterator delete_waiting_job(std::string waiting_job_id);
+    WaitingJobs::iterator find_waiting_job(const std::string & job_id);
+    WaitingJobs::iterator delete_waiting_job(WaitingJobs::iterator wj_iter);
+    bool delete_waiting_job(const std::string & waiting_job_id);
     Job * get_first_waiting_job();
-    void max_heapify_schedule(int root, int size);
-    void heap_sort_schedule(int size);
     std::string queue_to_string();
 
+    // @note waiting jobs in queue order, kept sorted as jobs are queued and removed
+    WaitingJobs _waiting_jobs;
+
     // @note LH: Additions for replacing the schedule class
     
     batsched_tools::Scheduled_Job * _tmp_job = nullptr;
-    std::vector<batsched_tools::Scheduled_Job *> _scheduled_jobs;
+    // @note running jobs in order of estimated finish time, owned by the list
+    ScheduledJobs _scheduled_jobs;
 
 
     // @note LH: Struct to keep track of priority job
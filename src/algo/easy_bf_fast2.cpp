@@ -39,6 +39,11 @@ void easy_bf_fast2::on_start_from_checkpoint(double date,const rapidjson::Value
 }
 void easy_bf_fast2::on_ingest_variables(const rapidjson::Document & doc,double date)
 {
+    if (_share_packing)
+    {
+        _free_cores.set_machines(_machines, _nb_machines);
+        _free_cores.add(_available_core_machines);
+    }
     ISchedulingAlgorithm::execute_jobs_in_running_state(date);
 }
 void easy_bf_fast2::on_simulation_start(double date,
@@ -52,6 +57,8 @@ void easy_bf_fast2::on_simulation_start(double date,
 
     if (batsim_config.HasMember("core-percent"))
         _core_percent = batsim_config["core-percent"].GetDouble();
+    if (_share_packing)
+        _free_cores.set_machines(_machines, _nb_machines);
    
     _available_machines.insert(IntervalSet::ClosedInterval(0, _nb_machines - 1));
     _nb_available_machines = _nb_machines;
@@ -101,20 +108,18 @@ void easy_bf_fast2::on_machine_down_for_repair(batsched_tools::KILL_TYPES forWha
         
         //ok there are jobs to kill
         std::string killed_jobs;
-            for(auto key_value : _current_allocations)
+            for (const std::string & job_id : _decision->running_jobs().jobs_on(machine))
             {
-                if (!((key_value.second.machines & machine).is_empty())){
-                    Job * job_ref = (*_workload)[key_value.first];
-                    auto msg = new batsched_tools::Job_Message;
-                    msg->id = key_value.first;
-                    msg->forWhat = forWhat;
-                    _my_kill_jobs.insert(std::make_pair(job_ref,msg));
-                   if (killed_jobs.empty())
+                Job * job_ref = (*_workload)[job_id];
+                auto msg = new batsched_tools::Job_Message;
+                msg->id = job_id;
+                msg->forWhat = forWhat;
+                _my_kill_jobs.insert(std::make_pair(job_ref,msg));
+                if (killed_jobs.empty())
                     killed_jobs = job_ref->id;
                 else
                     killed_jobs=batsched_tools::string_format("%s %s",killed_jobs.c_str(),job_ref->id.c_str());
             }
-        }
         BLOG_F(blog_types::FAILURES,"%s,\"%s\"",blog_failure_event::KILLING_JOBS.c_str(),killed_jobs.c_str());
     }
 }
@@ -125,19 +130,17 @@ void easy_bf_fast2::on_machine_instant_down_up(batsched_tools::KILL_TYPES forWha
     //if there are no running jobs, then there are none to kill
     if (!_running_jobs.empty()){
         std::string killed_jobs;
-        for(auto key_value : _current_allocations)   
-	    {
-		    if (!((key_value.second.machines & machine).is_empty())){
-                Job * job_ref = (*_workload)[key_value.first];
-                auto msg = new batsched_tools::Job_Message;
-                msg->id = key_value.first;
-                msg->forWhat = forWhat;
-                _my_kill_jobs.insert(std::make_pair(job_ref,msg));
-                if (killed_jobs.empty())
-                    killed_jobs = job_ref->id;
-                else
-                    killed_jobs=batsched_tools::string_format("%s %s",killed_jobs.c_str(),job_ref->id.c_str());
-            }
+        for (const std::string & job_id : _decision->running_jobs().jobs_on(machine))
+        {
+            Job * job_ref = (*_workload)[job_id];
+            auto msg = new batsched_tools::Job_Message;
+            msg->id = job_id;
+            msg->forWhat = forWhat;
+            _my_kill_jobs.insert(std::make_pair(job_ref,msg));
+            if (killed_jobs.empty())
+                killed_jobs = job_ref->id;
+            else
+                killed_jobs=batsched_tools::string_format("%s %s",killed_jobs.c_str(),job_ref->id.c_str());
         }
         BLOG_F(blog_types::FAILURES,"%s,\"%s\"",blog_failure_event::KILLING_JOBS.c_str(), killed_jobs.c_str());
     }
@@ -166,6 +169,13 @@ void easy_bf_fast2::on_requested_call(double date,batsched_tools::CALL_ME_LATERS
         case batsched_tools::call_me_later_types::CHECKPOINT_BATSCHED:
             _need_to_checkpoint = true;
             break;
+        case batsched_tools::call_me_later_types::WAKE_UP:
+        case batsched_tools::call_me_later_types::MONITORING_STAGE:
+            //requested by the energy variants only
+            break;
+        case batsched_tools::call_me_later_types::DECISION_QUANTUM:
+            //handled by the drivers, see on_decision_quantum_call
+            break;
     }
 }
     
@@ -318,25 +328,24 @@ bool easy_bf_fast2::handle_newly_finished_jobs()
 {
    //LOG_F(INFO,"line 410");
    std::vector<int> mapping = {0};
-   std::string prefix = "a";
     bool job_ended = false;
     for (const std::string & ended_job_id : _jobs_ended_recently)
     {
         job_ended = true;
         Job * finished_job = (*_workload)[ended_job_id];
-        const batsched_tools::Allocation & alloc = _current_allocations[ended_job_id];
+        //a copy: the allocation is erased before its horizon point
+        const batsched_tools::Allocation alloc = _current_allocations[ended_job_id];
         if (_share_packing && finished_job->nb_requested_resources == 1)
         {
                 //first get the machine it was running on
                 int machine_number = alloc.machines[0];
-                Machine* current_machine = (*_machines)(prefix,machine_number);
 
                 //now increase cores_available on that machine
-                current_machine->cores_available += 1;
                 //if that increase means no jobs are running on that machine (all its cores are available) then put it back in the mix
-                if (current_machine->cores_available == int(current_machine->core_count * _core_percent))
+                if (_free_cores.release_core(machine_number, _core_percent))
                 {
                     _available_core_machines -= alloc.machines;  // we subtract a core machine because it is now a regular machine
+                    _free_cores.remove(machine_number);
                     _available_machines.insert(alloc.machines); // we insert the machine into available machines
                     _nb_available_machines += 1; // we increase available machines by 1
                 }
@@ -405,7 +414,6 @@ void easy_bf_fast2::handle_machines_coming_available(double date)
 void easy_bf_fast2::handle_ended_job_execution(bool job_ended,double date)
 {
     std::vector<int> mapping = {0};
-    std::string prefix = "a";
     // If jobs have finished, execute jobs as long as they fit
     std::list<Job *>::iterator job_it =_pending_jobs.begin();
     if (job_ended || (!_machines_that_became_available_recently.is_empty()))
@@ -431,19 +439,12 @@ void easy_bf_fast2::handle_ended_job_execution(bool job_ended,double date)
                 //ok the job can be share-packed:
                 bool found = false;
                 //first check if there is a share-packing machine available:
-                //it is a 1 resource job, iterate over the available core machines until it finds one to put the job on.
-                for (auto it = _available_core_machines.elements_begin(); it != _available_core_machines.elements_end(); ++it)
+                //it is a 1 resource job, take the first available core machine able to handle another job
+                int machine_number = _free_cores.first_fit();
+                if (machine_number != -1)
                 {
-                    //is this machine able to handle another job?
-                    Machine* current_machine = (*_machines)(prefix,*it);
-                    if (current_machine->cores_available >= 1)
-                    {                                
-                        //it is able to handle another job
-                        found = true;
-                        alloc.machines = *it;
-                        break;
-                    }
-                                 
+                    found = true;
+                    alloc.machines = machine_number;
                 }
                 //LOG_F(INFO,"line 529");
                 if (found == true)
@@ -453,14 +454,13 @@ void easy_bf_fast2::handle_ended_job_execution(bool job_ended,double date)
                     _e_counter+=1;
                     executed = true;
                     //update data structures
-                    Machine* current_machine = (*_machines)(prefix,alloc.machines[0]);
                     point.nb_released_machines = _priority_job->nb_requested_resources;
                     point.date = date + (double)_priority_job->walltime;
                     point.machines = alloc.machines;
                     alloc.horizon_it = insert_horizon_point(point);
 
                     
-                    current_machine->cores_available -=1;
+                    _free_cores.take_core(alloc.machines[0]);
                     _current_allocations[_priority_job->id] = alloc;
                     _running_jobs.insert(_priority_job->id);
 
@@ -483,8 +483,8 @@ void easy_bf_fast2::handle_ended_job_execution(bool job_ended,double date)
                     alloc.horizon_it = insert_horizon_point(point);
 
                     //update data structures
-                    Machine* current_machine = (*_machines)(prefix,alloc.machines[0]);
-                    current_machine->cores_available -= 1;
+                    _free_cores.add(alloc.machines[0]);
+                    _free_cores.take_core(alloc.machines[0]);
                     _available_core_machines += alloc.machines;
                     _available_machines -= alloc.machines;
                     _nb_available_machines -= 1;
@@ -536,37 +536,30 @@ void easy_bf_fast2::handle_ended_job_execution(bool job_ended,double date)
                     {
                     LOG_F(INFO,"line 611");
                         bool found = false;
-                        //it is a 1 resource job, iterate over the available core machines until it finds one to put the job on.
-                        for (auto it = _available_core_machines.elements_begin(); it != _available_core_machines.elements_end(); ++it)
-                        {
-                            //is this machine able to handle another job?
-                            Machine* current_machine = (*_machines)(prefix,*it);
-                            if (current_machine->cores_available >= 1)
-                            {                                
-                                //it is able to handle another job, execute a job on it and subtract from cores_available
-                                alloc.machines = *it;
-                                
-                                _decision->add_execute_job(pending_job_id,alloc.machines,date,mapping);
-                                executed2 = true;
-                                _e_counter+=1;
-                                point.nb_released_machines = pending_job->nb_requested_resources;
-                                point.date = date + (double)pending_job->walltime;
-                                point.machines = alloc.machines;
-                                alloc.horizon_it = insert_horizon_point(point);
-                                
-                                //update data structures
-                                current_machine->cores_available -=1;
-                                _current_allocations[pending_job_id] = alloc;
-                                _running_jobs.insert(pending_job_id);
-                                job_it = _pending_jobs.erase(job_it);
-                                _p_counter+=1;
-                                erased = true;
-                                found = true;
-                                    
-                            }
-                            if (found == true)
-                                break; 
-                        }  
+                        //it is a 1 resource job, take the first available core machine able to handle another job
+                        int machine_number = _free_cores.first_fit();
+                        if (machine_number != -1)
+                        {                                
+                            //it is able to handle another job, execute a job on it and subtract from cores_available
+                            alloc.machines = machine_number;
+                            
+                            _decision->add_execute_job(pending_job_id,alloc.machines,date,mapping);
+                            executed2 = true;
+                            _e_counter+=1;
+                            point.nb_released_machines = pending_job->nb_requested_resources;
+                            point.date = date + (double)pending_job->walltime;
+                            point.machines = alloc.machines;
+                            alloc.horizon_it = insert_horizon_point(point);
+                            
+                            //update data structures
+                            _free_cores.take_core(machine_number);
+                            _current_allocations[pending_job_id] = alloc;
+                            _running_jobs.insert(pending_job_id);
+                            job_it = _pending_jobs.erase(job_it);
+                            _p_counter+=1;
+                            erased = true;
+                            found = true;
+                        }
                         // there were no available core machines to put it on, try to put on a new core machine
                         if (found == false && _nb_available_machines > 0)
                         {
@@ -583,8 +576,8 @@ void easy_bf_fast2::handle_ended_job_execution(bool job_ended,double date)
                             point.machines = alloc.machines;
                             alloc.horizon_it = insert_horizon_point(point);
                             //update data structures
-                            Machine* current_machine = (*_machines)(prefix,alloc.machines[0]);
-                            current_machine->cores_available -= 1;
+                            _free_cores.add(alloc.machines[0]);
+                            _free_cores.take_core(alloc.machines[0]);
                             _available_core_machines += alloc.machines;
                             _available_machines -= alloc.machines;
                             _nb_available_machines -= 1;
@@ -661,46 +654,37 @@ void easy_bf_fast2::handle_ended_job_execution(bool job_ended,double date)
                    
                     LOG_F(INFO,"line 721");
                     bool found = false;
-                    //it is a 1 resource job, iterate over the available core machines until it finds one to put the job on.
-                    for (auto it = _available_core_machines.elements_begin(); it != _available_core_machines.elements_end(); ++it)
-                    {
-                        //is this machine able to handle another job?
-                        Machine* current_machine = (*_machines)(prefix,*it);
-                        //LOG_F(INFO,"line 728");
-                        if (current_machine->cores_available >= 1)
-                        {                                
-                            found = true;
-                            //LOG_F(INFO,"line 731");
-                            if (date + pending_job->walltime <= _priority_job->completion_time)
-                            {
-                                //it is able to handle another job, execute a job on it and subtract from cores_available
-                                alloc.machines = *it;
-                                
-                                _decision->add_execute_job(pending_job_id,alloc.machines,date,mapping);
-                                execute = true;
-                                _e_counter+=1;
-                                point.nb_released_machines = pending_job->nb_requested_resources;
-                                point.date = date + (double)pending_job->walltime;
-                                point.machines = alloc.machines;
-                                alloc.horizon_it = insert_horizon_point(point);
-                                //LOG_F(INFO,"line 744");
-                                //update data structures
-                                current_machine->cores_available -=1;
-                                _current_allocations[pending_job_id] = alloc;
-                                _running_jobs.insert(pending_job_id);
-                                job_it = _pending_jobs.erase(job_it);
-                                _p_counter+=1;
-                                erased = true;
-                                
-                                
-                            }
-                            else
-                                LOG_F(INFO,"date %f walltime %f completion_time %f",
-                                 date,pending_job->walltime,_priority_job->completion_time);
+                    //it is a 1 resource job, take the first available core machine able to handle another job
+                    int machine_number = _free_cores.first_fit();
+                    if (machine_number != -1)
+                    {                                
+                        found = true;
+                        //LOG_F(INFO,"line 731");
+                        if (date + pending_job->walltime <= _priority_job->completion_time)
+                        {
+                            //it is able to handle another job, execute a job on it and subtract from cores_available
+                            alloc.machines = machine_number;
+                            
+                            _decision->add_execute_job(pending_job_id,alloc.machines,date,mapping);
+                            execute = true;
+                            _e_counter+=1;
+                            point.nb_released_machines = pending_job->nb_requested_resources;
+                            point.date = date + (double)pending_job->walltime;
+                            point.machines = alloc.machines;
+                            alloc.horizon_it = insert_horizon_point(point);
+                            //LOG_F(INFO,"line 744");
+                            //update data structures
+                            _free_cores.take_core(machine_number);
+                            _current_allocations[pending_job_id] = alloc;
+                            _running_jobs.insert(pending_job_id);
+                            job_it = _pending_jobs.erase(job_it);
+                            _p_counter+=1;
+                            erased = true;
                         }
-                        if (found == true)
-                            break; 
-                    }  
+                        else
+                            LOG_F(INFO,"date %f walltime %f completion_time %f",
+                             date,pending_job->walltime,_priority_job->completion_time);
+                    }
                     // there were no available core machines to put it on, try to put on a new core machine
                     if (found == false && _nb_available_machines > 0)
                     {
@@ -718,8 +702,8 @@ void easy_bf_fast2::handle_ended_job_execution(bool job_ended,double date)
                             point.machines = alloc.machines;
                             alloc.horizon_it = insert_horizon_point(point);
                             //update data structures
-                            Machine* current_machine = (*_machines)(prefix,alloc.machines[0]);
-                            current_machine->cores_available -= 1;
+                            _free_cores.add(alloc.machines[0]);
+                            _free_cores.take_core(alloc.machines[0]);
                             _available_core_machines += alloc.machines;
                             _available_machines -= alloc.machines;
                             _nb_available_machines -= 1;
@@ -789,7 +773,6 @@ void easy_bf_fast2::handle_newly_released_jobs(double date)
     int counter = 0;
     int pending = 0;
     std::vector<int> mapping = {0};
-    std::string prefix = "a";
     // Handle newly released jobs
     for (const std::string & new_job_id : _jobs_released_recently)
     {
@@ -812,18 +795,12 @@ void easy_bf_fast2::handle_newly_released_jobs(double date)
             //first check all core machines running right now
             
             bool found = false;
-            for (auto it = _available_core_machines.elements_begin(); it != _available_core_machines.elements_end(); ++it)
+            int machine_number = _free_cores.first_fit();
+            if (machine_number != -1)
             {
-                //is this machine able to handle another job?
-                Machine* current_machine = (*_machines)(prefix,*it);
-                if (current_machine->cores_available >= 1)
-                {                                
-                    //it is able to handle another job
-                    found = true;
-                    alloc.machines = *it;
-                    break;
-                }
-                                 
+                //it is able to handle another job
+                found = true;
+                alloc.machines = machine_number;
             }
             if (found == true)
             {
@@ -841,8 +818,7 @@ void easy_bf_fast2::handle_newly_released_jobs(double date)
                     point.machines = alloc.machines;
                     alloc.horizon_it = insert_horizon_point(point);
 
-                    Machine * current_machine = (*_machines)(prefix,alloc.machines[0]);
-                    current_machine->cores_available -=1;
+                    _free_cores.take_core(alloc.machines[0]);
                     _current_allocations[new_job_id] = alloc;
                     _running_jobs.insert(new_job_id);
                     
@@ -869,8 +845,8 @@ void easy_bf_fast2::handle_newly_released_jobs(double date)
 
 
                     //update data structures
-                    Machine* current_machine = (*_machines)(prefix,alloc.machines[0]);
-                    current_machine->cores_available -= 1;
+                    _free_cores.add(alloc.machines[0]);
+                    _free_cores.take_core(alloc.machines[0]);
                     _available_core_machines += alloc.machines;
                     _available_machines -= alloc.machines;
                     _nb_available_machines -= 1;
@@ -936,28 +912,21 @@ void easy_bf_fast2::handle_newly_released_jobs(double date)
 
 
 
-std::list<batsched_tools::FinishedHorizonPoint>::iterator easy_bf_fast2::insert_horizon_point(const batsched_tools::FinishedHorizonPoint &point)
+batsched_tools::FinishedHorizons::iterator easy_bf_fast2::insert_horizon_point(const batsched_tools::FinishedHorizonPoint &point)
 {
-    // The data structure is sorted, we can therefore traverse it in order
-    // until finding an insertion point.
-    for (auto it = _horizons.begin(); it != _horizons.end(); ++it)
-    {
-        if (point.date < it->date)
-        {
-            // Insertion point is before the current iterator.
-            return _horizons.insert(it, point);
-        }
-    }
-
-    // Insertion point not found. Insertion at end.
-    return _horizons.insert(_horizons.end(), point);
+    // The horizons are sorted by date, points of the same date stay in insertion order.
+    return _horizons.insert(point);
 }
 
 double easy_bf_fast2::compute_priority_job_expected_earliest_starting_time()
 {
-    std::string prefix = "a";
     int nb_available = _nb_available_machines;
     int required = _priority_job->nb_requested_resources;
+    // Without share-packing every point releases whole machines: the horizons keep the released machines
+    // up to the last shadow time, only the points between the old and the new shadow time are visited.
+    if (!_share_packing)
+        return _horizons.earliest_date(nb_available, required);
+
     //LOG_F(INFO,"line 1294");
     //make a shallow copy of machines_by_int if share-packing
     std::map<int,Machine *> machines_by_int_copy;
@@ -965,7 +934,7 @@ double easy_bf_fast2::compute_priority_job_expected_earliest_starting_time()
     {
         for (auto it = _available_core_machines.elements_begin(); it != _available_core_machines.elements_end(); ++it)
             {
-                Machine* current_machine = (*_machines)(prefix,*it);
+                Machine* current_machine = _free_cores.machine(*it);
                 Machine* a_machine = new Machine();
                 //all we need to copy are cores_available and core_count
                 a_machine->cores_available = current_machine->cores_available;
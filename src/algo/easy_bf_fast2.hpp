@@ -71,6 +71,6 @@ private:
     //backfilling
     double compute_priority_job_expected_earliest_starting_time();
 
-    std::list<batsched_tools::FinishedHorizonPoint>::iterator insert_horizon_point(const batsched_tools::FinishedHorizonPoint & point);
+    batsched_tools::FinishedHorizons::iterator insert_horizon_point(const batsched_tools::FinishedHorizonPoint & point);
 
 };
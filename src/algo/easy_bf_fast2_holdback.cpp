@@ -36,6 +36,13 @@ void easy_bf_fast2_holdback::on_start_from_checkpoint(double date,const rapidjso
 }
 void easy_bf_fast2_holdback::on_ingest_variables(const rapidjson::Document & doc,double date)
 {
+    if (_share_packing)
+    {
+        _free_cores.set_machines(_machines, _nb_machines);
+        _free_cores.add(_available_core_machines);
+        _heldback_free_cores.set_machines(_machines, _nb_machines);
+        _heldback_free_cores.add(_heldback_machines);
+    }
     ISchedulingAlgorithm::execute_jobs_in_running_state(date);
 }
 void easy_bf_fast2_holdback::on_simulation_start(double date,
@@ -63,7 +70,12 @@ void easy_bf_fast2_holdback::on_simulation_start(double date,
         _available_machines -= _heldback_machines;
         _unavailable_machines +=_heldback_machines;
     }
-    
+    if (_share_packing)
+    {
+        _free_cores.set_machines(_machines, _nb_machines);
+        _heldback_free_cores.set_machines(_machines, _nb_machines);
+        _heldback_free_cores.add(_heldback_machines);
+    }
 
 }      
 void easy_bf_fast2_holdback::on_simulation_end(double date){
@@ -126,19 +138,17 @@ void easy_bf_fast2_holdback::on_machine_down_for_repair(batsched_tools::KILL_TYP
         
         //ok there are jobs to kill
         std::string killed_jobs;
-        for(auto key_value : _current_allocations)
+        for (const std::string & job_id : _decision->running_jobs().jobs_on(machine))
         {
-            if (!((key_value.second.machines & machine).is_empty())){
-                Job * job_ref = (*_workload)[key_value.first];
-                auto msg = new batsched_tools::Job_Message;
-                msg->id = key_value.first;
-                msg->forWhat = forWhat;
-                _my_kill_jobs.insert(std::make_pair(job_ref,msg));
-                if (killed_jobs.empty())
-                    killed_jobs = job_ref->id;
-                else
-                    killed_jobs=batsched_tools::string_format("%s %s",killed_jobs.c_str(),job_ref->id.c_str());
-            }
+            Job * job_ref = (*_workload)[job_id];
+            auto msg = new batsched_tools::Job_Message;
+            msg->id = job_id;
+            msg->forWhat = forWhat;
+            _my_kill_jobs.insert(std::make_pair(job_ref,msg));
+            if (killed_jobs.empty())
+                killed_jobs = job_ref->id;
+            else
+                killed_jobs=batsched_tools::string_format("%s %s",killed_jobs.c_str(),job_ref->id.c_str());
         }
         BLOG_F(blog_types::FAILURES,"%s,\"%s\"",blog_failure_event::KILLING_JOBS.c_str(),killed_jobs.c_str());
     }
@@ -154,17 +164,15 @@ void easy_bf_fast2_holdback::on_machine_instant_down_up(batsched_tools::KILL_TYP
     BLOG_F(blog_types::FAILURES,"Machine Instant Down Up: %d",number);
     //if there are no running jobs, then there are none to kill
     if (!_running_jobs.empty()){
-        for(auto key_value : _current_allocations)   
-	    {
-		    if (!((key_value.second.machines & machine).is_empty())){
-                	Job * job_ref = (*_workload)[key_value.first];
-                    auto msg = new batsched_tools::Job_Message;
-                    msg->id = key_value.first;
-                    msg->forWhat = forWhat;
-                    _my_kill_jobs.insert(std::make_pair(job_ref,msg));
-	                BLOG_F(blog_types::FAILURES,"Killing Job: %s",key_value.first.c_str());
-            }
-	    }
+        for (const std::string & job_id : _decision->running_jobs().jobs_on(machine))
+        {
+            Job * job_ref = (*_workload)[job_id];
+            auto msg = new batsched_tools::Job_Message;
+            msg->id = job_id;
+            msg->forWhat = forWhat;
+            _my_kill_jobs.insert(std::make_pair(job_ref,msg));
+            BLOG_F(blog_types::FAILURES,"Killing Job: %s",job_id.c_str());
+        }
     }
 }
 /*void easy_bf_fast2_holdback::on_job_fault_notify_event(double date, std::string job){
@@ -198,6 +206,13 @@ void easy_bf_fast2_holdback::on_requested_call(double date,batsched_tools::CALL_
         case batsched_tools::call_me_later_types::CHECKPOINT_BATSCHED:
             _need_to_checkpoint = true;
             break;
+        case batsched_tools::call_me_later_types::WAKE_UP:
+        case batsched_tools::call_me_later_types::MONITORING_STAGE:
+            //requested by the energy variants only
+            break;
+        case batsched_tools::call_me_later_types::DECISION_QUANTUM:
+            //handled by the drivers, see on_decision_quantum_call
+            break;
     }
     
 
@@ -339,7 +354,6 @@ bool easy_bf_fast2_holdback::handle_newly_finished_jobs()
    LOG_F(INFO,"here");
    //LOG_F(INFO,"line 410");
    std::vector<int> mapping = {0};
-   std::string prefix="a";
     bool job_ended = false;
     for (const std::string & ended_job_id : _jobs_ended_recently)
     {
@@ -347,24 +361,21 @@ bool easy_bf_fast2_holdback::handle_newly_finished_jobs()
         LOG_F(INFO,"here");
         Job * finished_job = (*_workload)[ended_job_id];
         LOG_F(INFO,"here");
-        const batsched_tools::Allocation & alloc = _current_allocations[ended_job_id];
+        //a copy: the allocation is erased before its horizon point
+        const batsched_tools::Allocation alloc = _current_allocations[ended_job_id];
         LOG_F(INFO,"here");
         if (_share_packing && finished_job->nb_requested_resources == 1)
         {
                 //first get the machine it was running on
                 int machine_number = alloc.machines[0];
-                Machine* current_machine = (*_machines)(prefix,machine_number);
-
-                //now increase cores_available on that machine
-                current_machine->cores_available += 1;
-                //if that machine was part of heldback machines then that's all that needs to be done
-                bool skip = false;
+                //if that machine was part of heldback machines then giving the core back is all that needs to be done
                 if (_share_packing_holdback > 0 && !((_heldback_machines & alloc.machines).is_empty()))
-                    skip = true;
-                //if that increase means no jobs are running on that machine (all its cores are available) then put it back in the mix
-                if (!skip && current_machine->cores_available == int(current_machine->core_count * _core_percent))
+                    _heldback_free_cores.release_core(machine_number, _core_percent);
+                //if no jobs are running on that machine anymore (all its cores are available) then put it back in the mix
+                else if (_free_cores.release_core(machine_number, _core_percent))
                 {
                     _available_core_machines -= alloc.machines;  // we subtract a core machine because it is now a regular machine
+                    _free_cores.remove(machine_number);
                     _available_machines.insert(alloc.machines); // we insert the machine into available machines
                     _nb_available_machines += 1; // we increase available machines by 1
                 }
@@ -437,7 +448,6 @@ void easy_bf_fast2_holdback::handle_machines_coming_available(double date)
 void easy_bf_fast2_holdback::handle_ended_job_execution(bool job_ended,double date)
 {
     std::vector<int> mapping = {0};
-    std::string prefix = "a";
     // If jobs have finished, execute jobs as long as they fit
     std::list<Job *>::iterator job_it =_pending_jobs.begin();
     if (job_ended)
@@ -467,15 +477,11 @@ void easy_bf_fast2_holdback::handle_ended_job_execution(bool job_ended,double da
                 bool found = false;
                 if (_share_packing_holdback > 0)
                 {
-                    for (auto it = _heldback_machines.elements_begin(); it != _heldback_machines.elements_end(); ++it)
+                    int machine_number = _heldback_free_cores.first_fit();
+                    if (machine_number != -1)
                     {
-                        Machine* current_machine = (*_machines)(prefix,*it);
-                        if (current_machine->cores_available >= 1)
-                        {
-                            found = true;
-                            alloc.machines = *it;
-                            break;
-                        }
+                        found = true;
+                        alloc.machines = machine_number;
                     }
                     if (found == true)
                     {
@@ -486,8 +492,7 @@ void easy_bf_fast2_holdback::handle_ended_job_execution(bool job_ended,double da
                         //the job doesn't get put into the horizons because it is not part of backfilling
                         alloc.has_horizon = false;
 
-                        Machine * current_machine = (*_machines)(prefix,alloc.machines[0]);
-                        current_machine->cores_available -=1;
+                        _heldback_free_cores.take_core(alloc.machines[0]);
                         _current_allocations[_priority_job->id] = alloc;
                         _running_jobs.insert(_priority_job->id);
                         _priority_job = nullptr;
@@ -500,19 +505,12 @@ void easy_bf_fast2_holdback::handle_ended_job_execution(bool job_ended,double da
                     if (executed == false) //(not able to run on heldback machines )
                     {
                         //first check if there is a share-packing machine available:
-                        //it is a 1 resource job, iterate over the available core machines until it finds one to put the job on.
-                        for (auto it = _available_core_machines.elements_begin(); it != _available_core_machines.elements_end(); ++it)
+                        //it is a 1 resource job, take the first available core machine able to handle another job
+                        int machine_number = _free_cores.first_fit();
+                        if (machine_number != -1)
                         {
-                            //is this machine able to handle another job?
-                            Machine* current_machine = (*_machines)(prefix,*it);
-                            if (current_machine->cores_available >= 1)
-                            {                                
-                                //it is able to handle another job
-                                found = true;
-                                alloc.machines = *it;
-                                break;
-                            }
-                                        
+                            found = true;
+                            alloc.machines = machine_number;
                         }
                         //LOG_F(INFO,"line 529");
                         if (found == true)
@@ -522,14 +520,13 @@ void easy_bf_fast2_holdback::handle_ended_job_execution(bool job_ended,double da
                             _e_counter+=1;
                             executed = true;
                             //update data structures
-                            Machine* current_machine = (*_machines)(prefix,alloc.machines[0]);
                             point.nb_released_machines = _priority_job->nb_requested_resources;
                             point.date = date + (double)_priority_job->walltime;
                             point.machines = alloc.machines;
                             alloc.horizon_it = insert_horizon_point(point);
 
                             
-                            current_machine->cores_available -=1;
+                            _free_cores.take_core(alloc.machines[0]);
                             _current_allocations[_priority_job->id] = alloc;
                             _running_jobs.insert(_priority_job->id);
 
@@ -552,8 +549,8 @@ void easy_bf_fast2_holdback::handle_ended_job_execution(bool job_ended,double da
                             alloc.horizon_it = insert_horizon_point(point);
 
                             //update data structures
-                            Machine* current_machine = (*_machines)(prefix,alloc.machines[0]);
-                            current_machine->cores_available -= 1;
+                            _free_cores.add(alloc.machines[0]);
+                            _free_cores.take_core(alloc.machines[0]);
                             _available_core_machines += alloc.machines;
                             _available_machines -= alloc.machines;
                             _nb_available_machines -= 1;
@@ -612,15 +609,11 @@ void easy_bf_fast2_holdback::handle_ended_job_execution(bool job_ended,double da
                         if (_share_packing_holdback > 0)
                         {
                             //we can run it on a heldback machine as long as one is available.
-                            for (auto it = _heldback_machines.elements_begin(); it != _heldback_machines.elements_end(); ++it)
+                            int machine_number = _heldback_free_cores.first_fit();
+                            if (machine_number != -1)
                             {
-                                Machine* current_machine = (*_machines)(prefix,*it);
-                                if (current_machine->cores_available >= 1)
-                                {
-                                    found = true;
-                                    alloc.machines = *it;
-                                    break;
-                                }
+                                found = true;
+                                alloc.machines = machine_number;
                             }
                             if (found == true)
                             {
@@ -632,8 +625,7 @@ void easy_bf_fast2_holdback::handle_ended_job_execution(bool job_ended,double da
                                 //the job doesn't get put into the horizons because it is not part of backfilling
                                 alloc.has_horizon = false;
 
-                                Machine * current_machine = (*_machines)(prefix,alloc.machines[0]);
-                                current_machine->cores_available -=1;
+                                _heldback_free_cores.take_core(alloc.machines[0]);
                                 _current_allocations[pending_job_id] = alloc;
                                 _running_jobs.insert(pending_job_id);
                                  job_it = _pending_jobs.erase(job_it);
@@ -645,37 +637,31 @@ void easy_bf_fast2_holdback::handle_ended_job_execution(bool job_ended,double da
                         if (executed2 == false)
                         {
                             //no it was not able to be put on a heldback machine, try putting it on a normal share-packing machine.
-                            //it is a 1 resource job, iterate over the available core machines until it finds one to put the job on.
-                            for (auto it = _available_core_machines.elements_begin(); it != _available_core_machines.elements_end(); ++it)
-                            {
-                                //is this machine able to handle another job?
-                                Machine* current_machine = (*_machines)(prefix,*it);
-                                if (current_machine->cores_available >= 1)
-                                {                                
-                                    //it is able to handle another job, execute a job on it and subtract from cores_available
-                                    alloc.machines = *it;
-                                    
-                                    _decision->add_execute_job(pending_job_id,alloc.machines,date,mapping);
-                                    executed2 = true;
-                                    _e_counter+=1;
-                                    point.nb_released_machines = pending_job->nb_requested_resources;
-                                    point.date = date + (double)pending_job->walltime;
-                                    point.machines = alloc.machines;
-                                    alloc.horizon_it = insert_horizon_point(point);
-                                    
-                                    //update data structures
-                                    current_machine->cores_available -=1;
-                                    _current_allocations[pending_job_id] = alloc;
-                                    _running_jobs.insert(pending_job_id);
-                                    job_it = _pending_jobs.erase(job_it);
-                                    _p_counter+=1;
-                                    erased = true;
-                                    found = true;
-                                        
-                                }
-                                if (found == true)
-                                    break; 
-                            }  
+                            //it is a 1 resource job, take the first available core machine able to handle another job
+                            int machine_number = _free_cores.first_fit();
+                            if (machine_number != -1)
+                            {                                
+                                //it is able to handle another job, execute a job on it and subtract from cores_available
+                                alloc.machines = machine_number;
+
+                                _decision->add_execute_job(pending_job_id,alloc.machines,date,mapping);
+                                executed2 = true;
+                                _e_counter+=1;
+                                point.nb_released_machines = pending_job->nb_requested_resources;
+                                point.date = date + (double)pending_job->walltime;
+                                point.machines = alloc.machines;
+                                alloc.horizon_it = insert_horizon_point(point);
+
+                                //update data structures
+                                _free_cores.take_core(machine_number);
+                                _current_allocations[pending_job_id] = alloc;
+                                _running_jobs.insert(pending_job_id);
+                                job_it = _pending_jobs.erase(job_it);
+                                _p_counter+=1;
+                                erased = true;
+                                found = true;
+
+                            }
                             // there were no available core machines to put it on, try to put on a new core machine
                             if (found == false && _nb_available_machines > 0)
                             {
@@ -692,8 +678,8 @@ void easy_bf_fast2_holdback::handle_ended_job_execution(bool job_ended,double da
                                 point.machines = alloc.machines;
                                 alloc.horizon_it = insert_horizon_point(point);
                                 //update data structures
-                                Machine* current_machine = (*_machines)(prefix,alloc.machines[0]);
-                                current_machine->cores_available -= 1;
+                                _free_cores.add(alloc.machines[0]);
+                                _free_cores.take_core(alloc.machines[0]);
                                 _available_core_machines += alloc.machines;
                                 _available_machines -= alloc.machines;
                                 _nb_available_machines -= 1;
@@ -772,15 +758,11 @@ void easy_bf_fast2_holdback::handle_ended_job_execution(bool job_ended,double da
                         bool found = false;
                         if (_share_packing_holdback > 0)
                         {
-                            for (auto it = _heldback_machines.elements_begin(); it != _heldback_machines.elements_end(); ++it)
+                            int machine_number = _heldback_free_cores.first_fit();
+                            if (machine_number != -1)
                             {
-                                Machine* current_machine = (*_machines)(prefix,*it);
-                                if (current_machine->cores_available >= 1)
-                                {
-                                    found = true;
-                                    alloc.machines = *it;
-                                    break;
-                                }
+                                found = true;
+                                alloc.machines = machine_number;
                             }
                             if (found == true)
                             {
@@ -792,8 +774,7 @@ void easy_bf_fast2_holdback::handle_ended_job_execution(bool job_ended,double da
                                 //the job doesn't get put into the horizons because it is not part of backfilling
                                 alloc.has_horizon = false;
 
-                                Machine * current_machine = (*_machines)(prefix,alloc.machines[0]);
-                                current_machine->cores_available -=1;
+                                _heldback_free_cores.take_core(alloc.machines[0]);
                                 _current_allocations[pending_job_id] = alloc;
                                 _running_jobs.insert(pending_job_id);
                                  job_it = _pending_jobs.erase(job_it);
@@ -804,46 +785,40 @@ void easy_bf_fast2_holdback::handle_ended_job_execution(bool job_ended,double da
                    if (execute == false)//ok can't backfill on the heldback machines, try the normal machines
                    {
                         bool found = false;
-                        //it is a 1 resource job, iterate over the available core machines until it finds one to put the job on.
-                        for (auto it = _available_core_machines.elements_begin(); it != _available_core_machines.elements_end(); ++it)
-                        {
-                            //is this machine able to handle another job?
-                            Machine* current_machine = (*_machines)(prefix,*it);
-                            //LOG_F(INFO,"line 728");
-                            if (current_machine->cores_available >= 1)
-                            {                                
-                                found = true;
-                                //LOG_F(INFO,"line 731");
-                                if (date + pending_job->walltime <= _priority_job->completion_time)
-                                {
-                                    //it is able to handle another job, execute a job on it and subtract from cores_available
-                                    alloc.machines = *it;
-                                    
-                                    _decision->add_execute_job(pending_job_id,alloc.machines,date,mapping);
-                                    execute = true;
-                                    _e_counter+=1;
-                                    point.nb_released_machines = pending_job->nb_requested_resources;
-                                    point.date = date + (double)pending_job->walltime;
-                                    point.machines = alloc.machines;
-                                    alloc.horizon_it = insert_horizon_point(point);
-                                    //LOG_F(INFO,"line 744");
-                                    //update data structures
-                                    current_machine->cores_available -=1;
-                                    _current_allocations[pending_job_id] = alloc;
-                                    _running_jobs.insert(pending_job_id);
-                                    job_it = _pending_jobs.erase(job_it);
-                                    _p_counter+=1;
-                                    erased = true;
-                                    
-                                    
-                                }
-                                else
-                                    LOG_F(INFO,"date %f walltime %f completion_time %f",
-                                    date,pending_job->walltime,_priority_job->completion_time);
+                        //it is a 1 resource job, take the first available core machine able to handle another job
+                        int machine_number = _free_cores.first_fit();
+                        //LOG_F(INFO,"line 728");
+                        if (machine_number != -1)
+                        {                                
+                            found = true;
+                            //LOG_F(INFO,"line 731");
+                            if (date + pending_job->walltime <= _priority_job->completion_time)
+                            {
+                                //it is able to handle another job, execute a job on it and subtract from cores_available
+                                alloc.machines = machine_number;
+
+                                _decision->add_execute_job(pending_job_id,alloc.machines,date,mapping);
+                                execute = true;
+                                _e_counter+=1;
+                                point.nb_released_machines = pending_job->nb_requested_resources;
+                                point.date = date + (double)pending_job->walltime;
+                                point.machines = alloc.machines;
+                                alloc.horizon_it = insert_horizon_point(point);
+                                //LOG_F(INFO,"line 744");
+                                //update data structures
+                                _free_cores.take_core(machine_number);
+                                _current_allocations[pending_job_id] = alloc;
+                                _running_jobs.insert(pending_job_id);
+                                job_it = _pending_jobs.erase(job_it);
+                                _p_counter+=1;
+                                erased = true;
+
+
                             }
-                            if (found == true)
-                                break; 
-                        }  
+                            else
+                                LOG_F(INFO,"date %f walltime %f completion_time %f",
+                                date,pending_job->walltime,_priority_job->completion_time);
+                        }
                         // there were no available core machines to put it on, try to put on a new core machine
                         if (found == false && _nb_available_machines > 0)
                         {
@@ -861,8 +836,8 @@ void easy_bf_fast2_holdback::handle_ended_job_execution(bool job_ended,double da
                                 point.machines = alloc.machines;
                                 alloc.horizon_it = insert_horizon_point(point);
                                 //update data structures
-                                Machine* current_machine = (*_machines)(prefix,alloc.machines[0]);
-                                current_machine->cores_available -= 1;
+                                _free_cores.add(alloc.machines[0]);
+                                _free_cores.take_core(alloc.machines[0]);
                                 _available_core_machines += alloc.machines;
                                 _available_machines -= alloc.machines;
                                 _nb_available_machines -= 1;
@@ -933,7 +908,6 @@ void easy_bf_fast2_holdback::handle_newly_released_jobs(double date)
     int counter = 0;
     int pending = 0;
     std::vector<int> mapping = {0};
-    std::string prefix="a";
     // Handle newly released jobs
     for (const std::string & new_job_id : _jobs_released_recently)
     {
@@ -957,15 +931,11 @@ void easy_bf_fast2_holdback::handle_newly_released_jobs(double date)
             bool found = false;
             if (_share_packing_holdback > 0)
             {
-                for (auto it = _heldback_machines.elements_begin(); it != _heldback_machines.elements_end(); ++it)
+                int machine_number = _heldback_free_cores.first_fit();
+                if (machine_number != -1)
                 {
-                    Machine* current_machine = (*_machines)(prefix,*it);
-                    if (current_machine->cores_available >= 1)
-                    {
-                        found = true;
-                        alloc.machines = *it;
-                        break;
-                    }
+                    found = true;
+                    alloc.machines = machine_number;
                 }
                 if (found == true)
                 {
@@ -976,8 +946,7 @@ void easy_bf_fast2_holdback::handle_newly_released_jobs(double date)
                     //the job doesn't get put into the horizons because it is not part of backfilling
                     alloc.has_horizon = false;
 
-                    Machine * current_machine = (*_machines)(prefix,alloc.machines[0]);
-                    current_machine->cores_available -=1;
+                    _heldback_free_cores.take_core(alloc.machines[0]);
                     _current_allocations[new_job_id] = alloc;
                     _running_jobs.insert(new_job_id);
                      
@@ -988,18 +957,11 @@ void easy_bf_fast2_holdback::handle_newly_released_jobs(double date)
             if (executed == false)
             {
             
-                for (auto it = _available_core_machines.elements_begin(); it != _available_core_machines.elements_end(); ++it)
+                int machine_number = _free_cores.first_fit();
+                if (machine_number != -1)
                 {
-                    //is this machine able to handle another job?
-                    Machine* current_machine = (*_machines)(prefix,*it);
-                    if (current_machine->cores_available >= 1)
-                    {                                
-                        //it is able to handle another job
-                        found = true;
-                        alloc.machines = *it;
-                        break;
-                    }
-                                    
+                    found = true;
+                    alloc.machines = machine_number;
                 }
                 if (found == true)
                 {
@@ -1017,8 +979,7 @@ void easy_bf_fast2_holdback::handle_newly_released_jobs(double date)
                         point.machines = alloc.machines;
                         alloc.horizon_it = insert_horizon_point(point);
 
-                        Machine * current_machine = (*_machines)(prefix,alloc.machines[0]);
-                        current_machine->cores_available -=1;
+                        _free_cores.take_core(alloc.machines[0]);
                         _current_allocations[new_job_id] = alloc;
                         _running_jobs.insert(new_job_id);
                         
@@ -1045,8 +1006,8 @@ void easy_bf_fast2_holdback::handle_newly_released_jobs(double date)
 
 
                         //update data structures
-                        Machine* current_machine = (*_machines)(prefix,alloc.machines[0]);
-                        current_machine->cores_available -= 1;
+                        _free_cores.add(alloc.machines[0]);
+                        _free_cores.take_core(alloc.machines[0]);
                         _available_core_machines += alloc.machines;
                         _available_machines -= alloc.machines;
                         _nb_available_machines -= 1;
@@ -1118,28 +1079,21 @@ void easy_bf_fast2_holdback::handle_newly_released_jobs(double date)
 
 
 
-std::list<batsched_tools::FinishedHorizonPoint>::iterator easy_bf_fast2_holdback::insert_horizon_point(const batsched_tools::FinishedHorizonPoint &point)
+batsched_tools::FinishedHorizons::iterator easy_bf_fast2_holdback::insert_horizon_point(const batsched_tools::FinishedHorizonPoint &point)
 {
-    // The data structure is sorted, we can therefore traverse it in order
-    // until finding an insertion point.
-    for (auto it = _horizons.begin(); it != _horizons.end(); ++it)
-    {
-        if (point.date < it->date)
-        {
-            // Insertion point is before the current iterator.
-            return _horizons.insert(it, point);
-        }
-    }
-
-    // Insertion point not found. Insertion at end.
-    return _horizons.insert(_horizons.end(), point);
+    // The horizons are sorted by date, points of the same date stay in insertion order.
+    return _horizons.insert(point);
 }
 
 double easy_bf_fast2_holdback::compute_priority_job_expected_earliest_starting_time()
 {
-    std::string prefix="a";
     int nb_available = _nb_available_machines;
     int required = _priority_job->nb_requested_resources;
+    // Without share-packing every point releases whole machines: the horizons keep the released machines
+    // up to the last shadow time, only the points between the old and the new shadow time are visited.
+    if (!_share_packing)
+        return _horizons.earliest_date(nb_available, required);
+
     //LOG_F(INFO,"line 1294");
     //make a shallow copy of machines_by_int if share-packing
     std::map<int,Machine *> machines_by_int_copy;
@@ -1147,7 +1101,7 @@ double easy_bf_fast2_holdback::compute_priority_job_expected_earliest_starting_t
     {
         for (auto it = _available_core_machines.elements_begin(); it != _available_core_machines.elements_end(); ++it)
             {
-                Machine* current_machine = (*_machines)(prefix,*it);
+                Machine* current_machine = _free_cores.machine(*it);
                 Machine* a_machine = new Machine();
                 //all we need to copy are cores_available and core_count
                 a_machine->cores_available = current_machine->cores_available;
@@ -71,5 +71,7 @@ private:
  
     //backfilling
     double compute_priority_job_expected_earliest_starting_time();
-    std::list<batsched_tools::FinishedHorizonPoint>::iterator insert_horizon_point(const batsched_tools::FinishedHorizonPoint & point);
+    batsched_tools::FinishedHorizons::iterator insert_horizon_point(const batsched_tools::FinishedHorizonPoint & point);
+    //the heldback machines with a free core, kept apart from _free_cores as they never become regular machines
+    batsched_tools::FreeCoreIndex _heldback_free_cores;
 };
@@ -31,6 +31,7 @@ public:
 
 private:
     std::ofstream _output_file;
-    //QueueingTheoryWaitingTimeEstimator estimator;
+    QueueingTheoryWaitingTimeEstimator _estimator;
+    Rational _queueing_theory_period = 60*60*24*10;
 };
 
@@ -301,13 +301,26 @@ void EnergyBackfilling::on_machine_state_changed(double date, IntervalSet machin
     }
 }
 
-void EnergyBackfilling::on_requested_call(double date)
+void EnergyBackfilling::on_requested_call(double date, batsched_tools::CALL_ME_LATERS cml)
 {
-    (void) date;
+    if (cml.forWhat != batsched_tools::call_me_later_types::WAKE_UP &&
+        cml.forWhat != batsched_tools::call_me_later_types::MONITORING_STAGE)
+    {
+        ISchedulingAlgorithm::on_requested_call(date, cml);
+        return;
+    }
     PPK_ASSERT_ERROR(_nb_call_me_later_running > 0,
                      "Received a REQUESTED_CALL message from Batsim while there "
                      "was no running call_me_later request.");
     _nb_call_me_later_running--;
+    _decision->remove_call_me_later(cml, date, _workload);
+}
+
+void EnergyBackfilling::on_start_from_checkpoint(double date, const rapidjson::Value & batsim_config)
+{
+    (void) date;
+    (void) batsim_config;
+    PPK_ASSERT_ERROR(false, "Starting from a checkpoint is not supported by the energy algorithms");
 }
 
 void EnergyBackfilling::generate_machine_informations(int nb_machines)
@@ -468,7 +481,7 @@ void EnergyBackfilling::make_decisions(double date,
 
         if (new_job->nb_requested_resources > _nb_machines)
         {
-            _decision->add_reject_job(new_job_id, date);
+            _decision->add_reject_job(date, new_job_id, batsched_tools::REJECT_TYPES::NOT_ENOUGH_RESOURCES);
             ++_nb_jobs_completed;
         }
         else
@@ -481,32 +494,41 @@ void EnergyBackfilling::make_decisions(double date,
     // Let's update the sorting of the queue
     _queue->sort_queue(update_info, compare_info);
 
-    Schedule current_schedule = _schedule;
+    // The future schedule is only needed for its first slice, it is rolled back once the slice is known
+    _schedule.begin_transaction();
 
     if (_debug)
     {
-        LOG_F(1, "Schedule before put_jobs_into_schedule: %s", current_schedule.to_string().c_str());
+        LOG_F(1, "Schedule before put_jobs_into_schedule: %s", _schedule.to_string().c_str());
     }
 
-    put_jobs_into_schedule(current_schedule);
+    put_jobs_into_schedule(_schedule);
 
     if (_debug)
     {
-        LOG_F(1, "Schedule before sedate_machines_at_the_furthest_moment: %s", current_schedule.to_string().c_str());
+        LOG_F(1, "Schedule before sedate_machines_at_the_furthest_moment: %s", _schedule.to_string().c_str());
     }
 
-    sedate_machines_at_the_furthest_moment(current_schedule, _awake_machines);
+    sedate_machines_at_the_furthest_moment(_schedule, _awake_machines);
 
-    make_decisions_of_schedule(current_schedule);
+    Schedule::TimeSlice first_slice = *_schedule.begin();
+    _schedule.rollback();
+
+    make_decisions_of_first_slice(first_slice);
 }
 
 void EnergyBackfilling::make_decisions_of_schedule(const Schedule &schedule,
                                                    bool run_call_me_later_on_nothing_to_do)
+{
+    PPK_ASSERT_ERROR(schedule.nb_slices() > 0);
+    make_decisions_of_first_slice(*schedule.begin(), run_call_me_later_on_nothing_to_do);
+}
+
+void EnergyBackfilling::make_decisions_of_first_slice(const Schedule::TimeSlice &slice,
+                                                      bool run_call_me_later_on_nothing_to_do)
 {
     bool did_something = false;
 
-    PPK_ASSERT_ERROR(schedule.nb_slices() > 0);
-    const Schedule::TimeSlice & slice = *schedule.begin();
     PPK_ASSERT_ERROR(slice.begin == _schedule.first_slice_begin());
 
     map<int, IntervalSet> state_switches_to_do;
@@ -609,7 +631,10 @@ void EnergyBackfilling::make_decisions_of_schedule(const Schedule &schedule,
             // To avoid Batsim's deadlock, we should tell it to wait that we are ready.
 
             PPK_ASSERT_ERROR(_schedule.nb_slices() >= 1);
-            _decision->add_call_me_later(batsched_tools::call_me_later_types::FIXED_FAILURE,_nb_call_me_later_running,(double) _schedule.begin()->end + 1, (double) _schedule.begin()->begin);
+            batsched_tools::CALL_ME_LATERS cml;
+            cml.forWhat = batsched_tools::call_me_later_types::WAKE_UP;
+            cml.id = _decision->get_nb_call_me_laters();
+            _decision->add_call_me_later((double) _schedule.begin()->begin, (double) _schedule.begin()->end + 1, cml);
             _nb_call_me_later_running++;
         }
     }
@@ -739,7 +764,7 @@ void EnergyBackfilling::update_first_slice_taking_sleep_jobs_into_account(Ration
 
         IntervalSet wakable_machines_now, non_wakable_machines_now;
 
-        for (const auto mit : slice_it->allocated_jobs)
+        for (const auto & mit : slice_it->allocated_jobs)
         {
             const Job * job = mit.first;
             const IntervalSet & alloc = mit.second;
@@ -1256,67 +1281,89 @@ Rational EnergyBackfilling::find_earliest_moment_to_awaken_machines(Schedule &sc
     return schedule.first_slice_begin();
 }
 
+Rational EnergyBackfilling::EnergyEstimate::at(Rational horizon) const
+{
+    PPK_ASSERT_ERROR(horizon >= finite_horizon);
+    return energy + power_after * (horizon - finite_horizon);
+}
+
 Rational EnergyBackfilling::estimate_energy_of_schedule(const Schedule &schedule, Rational horizon) const
 {
     PPK_ASSERT_ERROR(horizon < schedule.infinite_horizon());
     Rational energy = 0;
 
     // Let's iterate the slices
-    for (auto slice_it = schedule.begin(); (slice_it->begin < horizon) && (slice_it != schedule.end()); ++slice_it)
+    for (auto slice_it = schedule.begin(); (slice_it != schedule.end()) && (slice_it->begin < horizon); ++slice_it)
     {
-        const Schedule::TimeSlice & slice = *slice_it;
-
-        Rational length = slice.length;
+        Rational length = slice_it->length;
         if (slice_it->end > horizon)
             length = horizon - slice_it->begin;
 
-        IntervalSet idle_machines = _all_machines;
+        energy += power_of_slice(*slice_it) * length;
+    }
 
-        for (auto mit : slice.allocated_jobs)
-        {
-            const Job * job = mit.first;
-            const IntervalSet & mr = mit.second;
+    return energy;
+}
 
-            idle_machines -= mr;
-            Rational job_power_in_slice = 0;
+EnergyBackfilling::EnergyEstimate EnergyBackfilling::estimate_energy_of_schedule(const Schedule &schedule) const
+{
+    PPK_ASSERT_ERROR(schedule.nb_slices() > 0);
+    EnergyEstimate estimate;
+    estimate.finite_horizon = schedule.finite_horizon();
+    estimate.energy = estimate_energy_of_schedule(schedule, estimate.finite_horizon);
 
-            if (is_fake_job(job->id))
-            {
-                if (is_switch_on_job(job->id))
-                    for (auto machine_it = mr.elements_begin(); machine_it != mr.elements_end(); ++machine_it)
-                        job_power_in_slice += _machine_informations.at(*machine_it)->switch_on_electrical_power;
-                else if (is_switch_off_job(job->id))
-                    for (auto machine_it = mr.elements_begin(); machine_it != mr.elements_end(); ++machine_it)
-                        job_power_in_slice += _machine_informations.at(*machine_it)->switch_off_electrical_power;
-                else if (is_ensured_sleep_job(job->id))
-                    for (auto machine_it = mr.elements_begin(); machine_it != mr.elements_end(); ++machine_it)
-                        job_power_in_slice += _machine_informations.at(*machine_it)->sleep_epower;
-                else if (is_potential_sleep_job(job->id))
-                    for (auto machine_it = mr.elements_begin(); machine_it != mr.elements_end(); ++machine_it)
-                        job_power_in_slice += _machine_informations.at(*machine_it)->sleep_epower;
-                else
-                    PPK_ASSERT_ERROR(false);
-            }
-            else
-            {
-                for (auto machine_it = mr.elements_begin(); machine_it != mr.elements_end(); ++machine_it)
-                    job_power_in_slice += _machine_informations.at(*machine_it)->compute_epower;
-            }
+    auto last_slice = schedule.end();
+    --last_slice;
+    estimate.power_after = power_of_slice(*last_slice);
+    return estimate;
+}
 
-            energy += job_power_in_slice * length;
-        }
+Rational EnergyBackfilling::power_of_slice(const Schedule::TimeSlice &slice) const
+{
+    Rational power = 0;
+    IntervalSet idle_machines = _all_machines;
 
-        // Let's add the energy of idle machines
-        for (auto machine_it = idle_machines.elements_begin(); machine_it != idle_machines.elements_end(); ++ machine_it)
-        {
-            int machine_id = *machine_it;
-            MachineInformation * minfo = _machine_informations.at(machine_id);
+    for (const auto & mit : slice.allocated_jobs)
+    {
+        const Job * job = mit.first;
+        const IntervalSet & mr = mit.second;
+
+        idle_machines -= mr;
 
-            energy += minfo->idle_epower * length;
+        if (is_fake_job(job->id))
+        {
+            if (is_switch_on_job(job->id))
+                for (auto machine_it = mr.elements_begin(); machine_it != mr.elements_end(); ++machine_it)
+                    power += _machine_informations.at(*machine_it)->switch_on_electrical_power;
+            else if (is_switch_off_job(job->id))
+                for (auto machine_it = mr.elements_begin(); machine_it != mr.elements_end(); ++machine_it)
+                    power += _machine_informations.at(*machine_it)->switch_off_electrical_power;
+            else if (is_ensured_sleep_job(job->id))
+                for (auto machine_it = mr.elements_begin(); machine_it != mr.elements_end(); ++machine_it)
+                    power += _machine_informations.at(*machine_it)->sleep_epower;
+            else if (is_potential_sleep_job(job->id))
+                for (auto machine_it = mr.elements_begin(); machine_it != mr.elements_end(); ++machine_it)
+                    power += _machine_informations.at(*machine_it)->sleep_epower;
+            else
+                PPK_ASSERT_ERROR(false);
+        }
+        else
+        {
+            for (auto machine_it = mr.elements_begin(); machine_it != mr.elements_end(); ++machine_it)
+                power += _machine_informations.at(*machine_it)->compute_epower;
         }
     }
 
-    return energy;
+    // Let's add the power of idle machines
+    for (auto machine_it = idle_machines.elements_begin(); machine_it != idle_machines.elements_end(); ++ machine_it)
+    {
+        int machine_id = *machine_it;
+        MachineInformation * minfo = _machine_informations.at(machine_id);
+
+        power += minfo->idle_epower;
+    }
+
+    return power;
 }
 
 bool EnergyBackfilling::is_switch_on_job(const std::string & job_id)
@@ -36,6 +36,20 @@ public:
         Rational max_bounded_slowdown = 0;
     };
 
+    /**
+     * @brief The estimated energy of a schedule, which can be evaluated at any horizon after its finite horizon
+     * @details Past the finite horizon the schedule is a single slice, whose power is constant.
+     *          This lets what-if schedules be compared after they have been rolled back.
+     */
+    struct EnergyEstimate
+    {
+        Rational finite_horizon = 0;
+        Rational energy = 0; //!< The energy consumed until the finite horizon
+        Rational power_after = 0; //!< The power consumed after the finite horizon
+
+        Rational at(Rational horizon) const;
+    };
+
     std::string machine_state_to_string(const MachineState & state);
 
     struct MachineInformation
@@ -90,7 +104,9 @@ public:
 
     virtual void on_machine_state_changed(double date, IntervalSet machines, int newState);
 
-    virtual void on_requested_call(double date);
+    virtual void on_requested_call(double date, batsched_tools::CALL_ME_LATERS cml);
+
+    virtual void on_start_from_checkpoint(double date, const rapidjson::Value & batsim_config);
 
     virtual void make_decisions(double date,
                                 SortableJobOrder::UpdateInformation * update_info,
@@ -101,6 +117,12 @@ protected:
     void clear_machine_informations();
 
     void make_decisions_of_schedule(const Schedule & schedule, bool run_call_me_later_on_nothing_to_do = true);
+    /**
+     * @brief Makes the decisions of a what-if schedule from its first time slice
+     * @details The what-if schedules are evaluated in a transaction on _schedule, and rolled back
+     *          before their decisions are applied to it: a copy of the first slice is all they leave.
+     */
+    void make_decisions_of_first_slice(const Schedule::TimeSlice & slice, bool run_call_me_later_on_nothing_to_do = true);
 
     void update_first_slice_taking_sleep_jobs_into_account(Rational date);
 
@@ -149,6 +171,8 @@ protected:
     Rational find_earliest_moment_to_awaken_machines(Schedule & schedule, const IntervalSet & machines_to_awaken) const;
 
     Rational estimate_energy_of_schedule(const Schedule & schedule, Rational horizon) const;
+    EnergyEstimate estimate_energy_of_schedule(const Schedule & schedule) const;
+    Rational power_of_slice(const Schedule::TimeSlice & slice) const;
 
     static bool is_switch_on_job(const std::string & job_id);
     static bool is_switch_off_job(const std::string & job_id);
@@ -80,7 +80,7 @@ void EnergyBackfillingDichotomy::make_decisions(double date,
 
         if (new_job->nb_requested_resources > _nb_machines)
         {
-            _decision->add_reject_job(new_job_id, date);
+            _decision->add_reject_job(date, new_job_id, batsched_tools::REJECT_TYPES::NOT_ENOUGH_RESOURCES);
             ++_nb_jobs_completed;
         }
         else
@@ -101,15 +101,20 @@ void EnergyBackfillingDichotomy::make_decisions(double date,
     // *******************************************************************
     // Let's compute global informations about the current online schedule
     // *******************************************************************
+    // The what-if schedules below change the first slice of _schedule: what is needed from it is copied first,
+    // online_first_slice must not be read once they started
     const Schedule::TimeSlice & online_first_slice = *_schedule.begin();
     IntervalSet sleeping_machines = compute_sleeping_machines(online_first_slice);
     IntervalSet awakenable_sleeping_machines = compute_potentially_awaken_machines(online_first_slice);
-    const IntervalSet & available_machines = online_first_slice.available_machines;
+    IntervalSet available_machines = online_first_slice.available_machines;
+
+    // Every what-if schedule is built in a transaction on _schedule then rolled back.
+    // What is needed to compare them (metrics, energy) and to apply the best one (its first slice) is kept aside.
 
     // ****************************************************************
     // Let's first compute the schedule in which all nodes are awakened
     // ****************************************************************
-    Schedule awakened_schedule = _schedule;
+    _schedule.begin_transaction();
 
     if (_comparison_type == SWITCH_ON)
     {
@@ -117,8 +122,8 @@ void EnergyBackfillingDichotomy::make_decisions(double date,
         for (auto machine_it = sleeping_machines.elements_begin(); machine_it != sleeping_machines.elements_end(); ++machine_it)
         {
             int machine_id = *machine_it;
-            Rational wake_up_moment = find_earliest_moment_to_awaken_machines(awakened_schedule, IntervalSet(machine_id));
-            awaken_machine(awakened_schedule, machine_id, wake_up_moment);
+            Rational wake_up_moment = find_earliest_moment_to_awaken_machines(_schedule, IntervalSet(machine_id));
+            awaken_machine(_schedule, machine_id, wake_up_moment);
         }
     }
     else if (_comparison_type == REMOVE_SLEEP_JOBS)
@@ -128,28 +133,28 @@ void EnergyBackfillingDichotomy::make_decisions(double date,
         {
             int machine_id = *machine_it;
             MachineInformation *minfo = _machine_informations.at(machine_id);
-            while (awakened_schedule.remove_job_if_exists(minfo->ensured_sleep_job));
-            while (awakened_schedule.remove_job_if_exists(minfo->potential_sleep_job));
+            while (_schedule.remove_job_if_exists(minfo->ensured_sleep_job));
+            while (_schedule.remove_job_if_exists(minfo->potential_sleep_job));
         }
     }
 
     // Let's add jobs into the schedule
-    put_jobs_into_schedule(awakened_schedule);
+    put_jobs_into_schedule(_schedule);
+    ScheduleMetrics awakened_sched_metrics = compute_metrics_of_schedule(_schedule);
+    _schedule.rollback();
 
     // *********************************************************************************
     // Let's determine if the online schedule respects our avg bds constraint.
     // If so, we should try to sedate machines. Otherwise, we should try to awaken some.
     // *********************************************************************************
-    Schedule online_schedule = _schedule;
-    put_jobs_into_schedule(online_schedule);
-
-    //Rational online_awakened_comparison_horizon = max(awakened_schedule.finite_horizon(), online_schedule.finite_horizon());
+    _schedule.begin_transaction();
+    put_jobs_into_schedule(_schedule);
 
-    // Let's compute the jobs metrics and energy of the two schedules
-    ScheduleMetrics online_sched_metrics = compute_metrics_of_schedule(online_schedule);
-    ScheduleMetrics awakened_sched_metrics = compute_metrics_of_schedule(awakened_schedule);
-    //Rational online_sched_energy = estimate_energy_of_schedule(online_schedule, online_awakened_comparison_horizon);
-    //Rational awakened_sched_energy = estimate_energy_of_schedule(awakened_schedule, online_awakened_comparison_horizon);
+    // Let's compute the jobs metrics and energy of the online schedule
+    ScheduleMetrics online_sched_metrics = compute_metrics_of_schedule(_schedule);
+    EnergyEstimate online_sched_energy = estimate_energy_of_schedule(_schedule);
+    Schedule::TimeSlice online_decisions_slice = *_schedule.begin();
+    _schedule.rollback();
 
     bool should_sedate_machines = false;
     if (online_sched_metrics.mean_slowdown <= awakened_sched_metrics.mean_slowdown * _tolerated_slowdown_loss_ratio)
@@ -161,6 +166,11 @@ void EnergyBackfillingDichotomy::make_decisions(double date,
 
     LOG_F(INFO, "should_sedate_machines=%d", should_sedate_machines);
 
+    // The best schedule found so far, starting with the online one
+    Schedule::TimeSlice best_decisions_slice = online_decisions_slice;
+    ScheduleMetrics best_sched_metrics = online_sched_metrics;
+    EnergyEstimate best_sched_energy = online_sched_energy;
+
     if (should_sedate_machines)
     {
          // Sleeping machines are not available since they compute "fake" jobs
@@ -168,10 +178,6 @@ void EnergyBackfillingDichotomy::make_decisions(double date,
 
         int nb_to_sedate_min = 1; // Online schedule is nb_to_sedate = 0
         int nb_to_sedate_max = sedatable_machines.size();
-
-        Schedule best_schedule = online_schedule;
-        ScheduleMetrics best_sched_metrics = online_sched_metrics;
-        //Rational best_sched_energy = online_sched_energy;
         int best_nb_to_sedate = 0;
 
         // Dichotomy
@@ -184,38 +190,39 @@ void EnergyBackfillingDichotomy::make_decisions(double date,
             _selector->select_resources_to_sedate(nb_to_sedate, available_machines, sedatable_machines, machines_to_sedate);
 
             // Create the schedule with the desired sedated machines
-            Schedule schedule = _schedule;
+            _schedule.begin_transaction();
 
             for (auto machine_it = machines_to_sedate.elements_begin(); machine_it != machines_to_sedate.elements_end(); ++machine_it)
             {
                 int machine_id = *machine_it;
-                sedate_machine(schedule, machine_id, schedule.begin());
+                sedate_machine(_schedule, machine_id, _schedule.begin());
             }
 
-            put_jobs_into_schedule(schedule);
+            put_jobs_into_schedule(_schedule);
 
             // Let's compute jobs metrics about the current schedule
-            ScheduleMetrics sched_metrics = compute_metrics_of_schedule(schedule);
+            ScheduleMetrics sched_metrics = compute_metrics_of_schedule(_schedule);
 
             // If the schedule respects the avg slowdown constraint
             if (sched_metrics.mean_slowdown <= awakened_sched_metrics.mean_slowdown * _tolerated_slowdown_loss_ratio)
             {
                 // Let's compute the energy of both schedules to compare them
-                Rational comparison_horizon = max(best_schedule.finite_horizon(), schedule.finite_horizon());
-                Rational best_sched_energy = estimate_energy_of_schedule(best_schedule, comparison_horizon);
-                Rational sched_energy = estimate_energy_of_schedule(schedule, comparison_horizon);
+                EnergyEstimate sched_energy_estimate = estimate_energy_of_schedule(_schedule);
+                Rational comparison_horizon = max(best_sched_energy.finite_horizon, sched_energy_estimate.finite_horizon);
+                Rational best_energy = best_sched_energy.at(comparison_horizon);
+                Rational sched_energy = sched_energy_estimate.at(comparison_horizon);
 
                 LOG_F(INFO, "Current schedule respects the mean slowdown constraint. "
                      "(best_energy, curr_energy) : (%g, %g)",
-                     (double)best_sched_energy, (double)sched_energy);
+                     (double)best_energy, (double)sched_energy);
 
                 // Let's update the best solution if needed
-                if ((sched_energy < best_sched_energy) ||
-                    ((sched_energy == best_sched_energy) && (nb_to_sedate > best_nb_to_sedate)))
+                if ((sched_energy < best_energy) ||
+                    ((sched_energy == best_energy) && (nb_to_sedate > best_nb_to_sedate)))
                 {
-                    best_schedule = schedule;
+                    best_decisions_slice = *_schedule.begin();
                     best_sched_metrics = sched_metrics;
-                    best_sched_energy = sched_energy;
+                    best_sched_energy = sched_energy_estimate;
                     best_nb_to_sedate = nb_to_sedate;
                 }
 
@@ -223,18 +230,14 @@ void EnergyBackfillingDichotomy::make_decisions(double date,
             }
             else
                 nb_to_sedate_max = nb_to_sedate - 1;
-        }
 
-        // Let's apply the decisions of the best schedule
-        make_decisions_of_schedule(best_schedule);
+            _schedule.rollback();
+        }
     }
     else
     {
         int nb_to_awaken_min = 1; // online schedule is nb_to_awaken = 0
         int nb_to_awaken_max = awakenable_sleeping_machines.size();
-
-        Schedule best_schedule = online_schedule;
-        ScheduleMetrics best_sched_metrics = online_sched_metrics;
         int best_nb_to_awaken = 0;
 
         // Dichotomy
@@ -246,37 +249,39 @@ void EnergyBackfillingDichotomy::make_decisions(double date,
             _selector->select_resources_to_awaken(nb_to_awaken, available_machines, awakenable_sleeping_machines, machines_to_awaken);
 
             // Create the schedule with the desired awakened machines
-            Schedule schedule = _schedule;
+            _schedule.begin_transaction();
 
             for (auto machine_it = machines_to_awaken.elements_begin(); machine_it != machines_to_awaken.elements_end(); ++machine_it)
             {
                 int machine_id = *machine_it;
-                Rational wake_up_date = find_earliest_moment_to_awaken_machines(schedule, IntervalSet(machine_id));
-                awaken_machine(schedule, machine_id, wake_up_date);
+                Rational wake_up_date = find_earliest_moment_to_awaken_machines(_schedule, IntervalSet(machine_id));
+                awaken_machine(_schedule, machine_id, wake_up_date);
             }
 
-            put_jobs_into_schedule(schedule);
+            put_jobs_into_schedule(_schedule);
 
-            ScheduleMetrics sched_metrics = compute_metrics_of_schedule(schedule);
+            ScheduleMetrics sched_metrics = compute_metrics_of_schedule(_schedule);
 
             // If the schedule respects our avg slowdown constraint
             if (sched_metrics.mean_slowdown <= awakened_sched_metrics.mean_slowdown * _tolerated_slowdown_loss_ratio)
             {
                 // Let's compute the energy of both schedules to compare them
-                Rational comparison_horizon = max(best_schedule.finite_horizon(), schedule.finite_horizon());
-                Rational best_sched_energy = estimate_energy_of_schedule(best_schedule, comparison_horizon);
-                Rational sched_energy = estimate_energy_of_schedule(schedule, comparison_horizon);
+                EnergyEstimate sched_energy_estimate = estimate_energy_of_schedule(_schedule);
+                Rational comparison_horizon = max(best_sched_energy.finite_horizon, sched_energy_estimate.finite_horizon);
+                Rational best_energy = best_sched_energy.at(comparison_horizon);
+                Rational sched_energy = sched_energy_estimate.at(comparison_horizon);
 
                 LOG_F(INFO, "Current schedule respects the mean slowdown constraint. "
                      "(best_energy, curr_energy) : (%g, %g)",
-                     (double)best_sched_energy, (double)sched_energy);
+                     (double)best_energy, (double)sched_energy);
 
                 // Let's update the best solution if needed
-                if ((sched_energy < best_sched_energy) ||
-                    ((sched_energy == best_sched_energy) && (nb_to_awaken < best_nb_to_awaken)))
+                if ((sched_energy < best_energy) ||
+                    ((sched_energy == best_energy) && (nb_to_awaken < best_nb_to_awaken)))
                 {
-                    best_schedule = schedule;
+                    best_decisions_slice = *_schedule.begin();
                     best_sched_metrics = sched_metrics;
+                    best_sched_energy = sched_energy_estimate;
                     best_nb_to_awaken = nb_to_awaken;
                 }
 
@@ -284,9 +289,11 @@ void EnergyBackfillingDichotomy::make_decisions(double date,
             }
             else
                 nb_to_awaken_min = nb_to_awaken + 1;
-        }
 
-        // Let's apply the decisions of the best schedule
-        make_decisions_of_schedule(best_schedule);
+            _schedule.rollback();
+        }
     }
+
+    // Let's apply the decisions of the best schedule
+    make_decisions_of_first_slice(best_decisions_slice);
 }
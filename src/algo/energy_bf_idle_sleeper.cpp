@@ -69,7 +69,7 @@ void EnergyBackfillingIdleSleeper::select_idle_machines_to_sedate(Rational curre
 }
 
 void EnergyBackfillingIdleSleeper::select_idle_machines_to_awaken(const Queue *queue,
-                                                                  const Schedule &schedule,
+                                                                  Schedule &schedule,
                                                                   ResourceSelector * priority_job_selector,
                                                                   const IntervalSet &idle_machines,
                                                                   AwakeningPolicy policy,
@@ -88,10 +88,11 @@ void EnergyBackfillingIdleSleeper::select_idle_machines_to_awaken(const Queue *q
     if (policy == AWAKEN_FOR_PRIORITY_JOB_ONLY)
         return;
 
-    Schedule schedule_copy = schedule;
+    // The priority job is inserted into the schedule to find its reserved machines, this is undone afterwards.
+    schedule.begin_transaction();
 
     // Let's try to backfill some jobs into the awakenable machines, and wake them up if needed.
-    IntervalSet awakable_machines = compute_potentially_awaken_machines(*schedule_copy.begin());
+    IntervalSet awakable_machines = compute_potentially_awaken_machines(*schedule.begin());
 
     if (awakable_machines.size() > (unsigned int)maximum_nb_machines_to_awaken)
         awakable_machines = awakable_machines.left(maximum_nb_machines_to_awaken);
@@ -106,12 +107,13 @@ void EnergyBackfillingIdleSleeper::select_idle_machines_to_awaken(const Queue *q
     JobAlloc priority_job_alloc;
     IntervalSet priority_job_reserved_machines;
     IntervalSet machines_that_can_be_used_by_the_priority_job;
-    compute_priority_job_and_related_stuff(schedule_copy, queue, priority_job,
+    compute_priority_job_and_related_stuff(schedule, queue, priority_job,
                                            priority_job_selector,
                                            priority_job_needs_awakenings,
                                            priority_job_alloc,
                                            priority_job_reserved_machines,
                                            machines_that_can_be_used_by_the_priority_job);
+    schedule.rollback();
 
     if (policy == AWAKEN_FOR_ALL_JOBS_RESPECTING_PRIORITY_JOB && take_priority_job_into_account)
     {
@@ -46,7 +46,8 @@ public:
     /**
      * @brief Selects which machines should be awakened to compute some jobs
      * @param[in] queue The queue which contains jobs (or not)
-     * @param[in] schedule The current schedule. It should not be modified by this function.
+     * @param[in,out] schedule The current schedule. The priority job is inserted into it in a transaction
+     *                which is rolled back, so it is left unchanged by this function.
      * @param[in,out] priority_job_selector The ResourceSelector to insert the priority_job into the schedule
      * @param[in] idle_machines The machines currently idle
      * @param[in] policy The AwakeningPolicy to apply
@@ -54,7 +55,7 @@ public:
      * @param[out] machines_to_awaken The machines that can be awakened to execute jobs (output parameter)
      */
     static void select_idle_machines_to_awaken(const Queue *queue,
-                                               const Schedule &schedule,
+                                               Schedule &schedule,
                                                ResourceSelector * priority_job_selector,
                                                const IntervalSet &idle_machines,
                                                AwakeningPolicy policy,
@@ -203,7 +203,7 @@ void EnergyBackfillingMonitoringInertialShutdown::make_decisions(double date,
 
         if (new_job->nb_requested_resources > _nb_machines)
         {
-            _decision->add_reject_job(new_job_id, date);
+            _decision->add_reject_job(date, new_job_id, batsched_tools::REJECT_TYPES::NOT_ENOUGH_RESOURCES);
             ++_nb_jobs_completed;
         }
         else
@@ -1470,16 +1470,16 @@ void EnergyBackfillingMonitoringInertialShutdown::compute_priority_job_and_relat
     }
 }
 
-Rational EnergyBackfillingMonitoringInertialShutdown::compute_priority_job_starting_time_expectancy(const Schedule &schedule,
+Rational EnergyBackfillingMonitoringInertialShutdown::compute_priority_job_starting_time_expectancy(Schedule &schedule,
                                                                                                     const Job *priority_job)
 {
     if (priority_job == nullptr)
         return -1;
 
-    Schedule copy = schedule;
+    schedule.begin_transaction();
 
     // Let's remove the job from the schedule if it exists
-    copy.remove_job_if_exists(priority_job);
+    schedule.remove_job_if_exists(priority_job);
 
     // Let's remove every sleeping machine from it
     IntervalSet machines_asleep_soon = (_asleep_machines + _switching_off_machines - _switching_on_machines)
@@ -1488,10 +1488,11 @@ Rational EnergyBackfillingMonitoringInertialShutdown::compute_priority_job_start
     for (auto mit = machines_asleep_soon.elements_begin(); mit != machines_asleep_soon.elements_end(); ++mit)
     {
         int machine_id = *mit;
-        EnergyBackfilling::awaken_machine_as_soon_as_possible(copy, machine_id);
+        EnergyBackfilling::awaken_machine_as_soon_as_possible(schedule, machine_id);
     }
 
-    JobAlloc alloc = copy.add_job_first_fit(priority_job, _selector, true);
+    JobAlloc alloc = schedule.add_job_first_fit(priority_job, _selector, true);
+    schedule.rollback();
 
     PPK_ASSERT_ERROR(alloc.has_been_inserted);
     return alloc.begin;
@@ -77,7 +77,11 @@ public:
                                                        IntervalSet & priority_job_reserved_machines,
                                                        IntervalSet & machines_that_can_be_used_by_the_priority_job);
 
-    Rational compute_priority_job_starting_time_expectancy(const Schedule & schedule,
+    /**
+     * @brief Computes when the priority job would start if every machine was awakened as soon as possible
+     * @details The awakenings are done in a transaction on the given schedule, which is left unchanged
+     */
+    Rational compute_priority_job_starting_time_expectancy(Schedule & schedule,
                                                            const Job * priority_job);
 
 
@@ -47,7 +47,10 @@ void EnergyBackfillingMonitoringPeriod::on_job_release(double date, const std::v
         LOG_F(INFO, "EnergyBackfillingMonitoringPeriod: First monitoring nop is expected to be at date=%g",
                (double) _next_monitoring_period_expected_date);
 
-        _decision->add_call_me_later((double)(_next_monitoring_period_expected_date), date);
+        batsched_tools::CALL_ME_LATERS cml;
+        cml.forWhat = batsched_tools::call_me_later_types::MONITORING_STAGE;
+        cml.id = _decision->get_nb_call_me_laters();
+        _decision->add_call_me_later(date, (double)(_next_monitoring_period_expected_date), cml);
         _nb_call_me_later_running++;
         _monitoring_period_launched = true;
     }
@@ -55,12 +58,12 @@ void EnergyBackfillingMonitoringPeriod::on_job_release(double date, const std::v
     EnergyBackfilling::on_job_release(date, job_ids);
 }
 
-void EnergyBackfillingMonitoringPeriod::on_requested_call(double date)
+void EnergyBackfillingMonitoringPeriod::on_requested_call(double date, batsched_tools::CALL_ME_LATERS cml)
 {
-    EnergyBackfilling::on_requested_call(date);
+    EnergyBackfilling::on_requested_call(date, cml);
     LOG_F(INFO, "on_requested_call, date = %g", date);
 
-    if (!_simulation_finished)
+    if (cml.forWhat == batsched_tools::call_me_later_types::MONITORING_STAGE && !_simulation_finished)
     {
         // Let's execute on_monitoring_stage
         on_monitoring_stage(date);
@@ -69,7 +72,10 @@ void EnergyBackfillingMonitoringPeriod::on_requested_call(double date)
         {
             // Let's request a call for the next monitoring stage
             _next_monitoring_period_expected_date = date + _period_between_monitoring_stages;
-            _decision->add_call_me_later((double)(_next_monitoring_period_expected_date), date);
+            batsched_tools::CALL_ME_LATERS next_cml;
+            next_cml.forWhat = batsched_tools::call_me_later_types::MONITORING_STAGE;
+            next_cml.id = _decision->get_nb_call_me_laters();
+            _decision->add_call_me_later(date, (double)(_next_monitoring_period_expected_date), next_cml);
             _nb_call_me_later_running++;
 
             LOG_F(INFO, "EnergyBackfillingMonitoringPeriod: 'Chose to launch a call_me_later at %g",
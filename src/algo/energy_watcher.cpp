@@ -38,6 +38,13 @@ void EnergyWatcher::on_simulation_end(double date)
     (void) date;
 }
 
+void EnergyWatcher::on_start_from_checkpoint(double date, const rapidjson::Value & batsim_config)
+{
+    (void) date;
+    (void) batsim_config;
+    PPK_ASSERT_ERROR(false, "Starting from a checkpoint is not supported by the energy algorithms");
+}
+
 void EnergyWatcher::make_decisions(double date,
                             SortableJobOrder::UpdateInformation *update_info,
                             SortableJobOrder::CompareInformation *compare_info)
@@ -80,7 +87,7 @@ void EnergyWatcher::make_decisions(double date,
         if (new_job->nb_requested_resources > _nb_machines)
         {
             // The job is too big for the machine -> reject
-            _decision->add_reject_job(new_job_id, date);
+            _decision->add_reject_job(date, new_job_id, batsched_tools::REJECT_TYPES::NOT_ENOUGH_RESOURCES);
         }
         else
         {
@@ -14,6 +14,8 @@ public:
 
     virtual void on_simulation_end(double date);
 
+    virtual void on_start_from_checkpoint(double date, const rapidjson::Value & batsim_config);
+
     virtual void make_decisions(double date,
                                 SortableJobOrder::UpdateInformation * update_info,
                                 SortableJobOrder::CompareInformation * compare_info);
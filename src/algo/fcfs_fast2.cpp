@@ -115,20 +115,18 @@ void FCFSFast2::on_machine_down_for_repair(batsched_tools::KILL_TYPES killType,d
         
         //ok there are jobs to kill
         std::string killed_jobs;
-        for(auto key_value : _current_allocations)
+        for (const std::string & job_id : _decision->running_jobs().jobs_on(machine))
         {
-            if (!((key_value.second.machines & machine).is_empty())){
-                Job * job_ref = (*_workload)[key_value.first];
-                batsched_tools::Job_Message * msg = new batsched_tools::Job_Message;
-                msg->id = key_value.first;
-                msg->forWhat = killType;
-                _my_kill_jobs.insert(std::make_pair(job_ref,msg));
-                CLOG_F(CCU_DEBUG,"Killing Job: %s",job_ref->id.c_str());
-                if (killed_jobs.empty())
-                    killed_jobs = job_ref->id;
-                else
-                    killed_jobs=batsched_tools::string_format("%s %s",killed_jobs.c_str(),job_ref->id.c_str());
-            }
+            Job * job_ref = (*_workload)[job_id];
+            batsched_tools::Job_Message * msg = new batsched_tools::Job_Message;
+            msg->id = job_id;
+            msg->forWhat = killType;
+            _my_kill_jobs.insert(std::make_pair(job_ref,msg));
+            CLOG_F(CCU_DEBUG,"Killing Job: %s",job_ref->id.c_str());
+            if (killed_jobs.empty())
+                killed_jobs = job_ref->id;
+            else
+                killed_jobs=batsched_tools::string_format("%s %s",killed_jobs.c_str(),job_ref->id.c_str());
         }
         BLOG_F(blog_types::FAILURES,"%s,\"%s\"",blog_failure_event::KILLING_JOBS.c_str(),killed_jobs.c_str());
         
@@ -143,19 +141,17 @@ void FCFSFast2::on_machine_instant_down_up(batsched_tools::KILL_TYPES killType,d
     if (!_running_jobs.empty()){
         CLOG_F(CCU_DEBUG,"There are running jobs so there is potential for one to be killed");
         std::string killed_jobs;
-        for(auto key_value : _current_allocations)   
-	    {
-		    if (!((key_value.second.machines & machine).is_empty())){
-                Job * job_ref = (*_workload)[key_value.first];
-                batsched_tools::Job_Message* msg = new batsched_tools::Job_Message;
-                msg->id = key_value.first;
-                msg->forWhat = killType;
-                _my_kill_jobs.insert(std::make_pair(job_ref,msg));
-                if (killed_jobs.empty())
-                    killed_jobs = job_ref->id;
-                else
-                    killed_jobs=batsched_tools::string_format("%s %s",killed_jobs.c_str(),job_ref->id.c_str());
-            }
+        for (const std::string & job_id : _decision->running_jobs().jobs_on(machine))
+        {
+            Job * job_ref = (*_workload)[job_id];
+            batsched_tools::Job_Message* msg = new batsched_tools::Job_Message;
+            msg->id = job_id;
+            msg->forWhat = killType;
+            _my_kill_jobs.insert(std::make_pair(job_ref,msg));
+            if (killed_jobs.empty())
+                killed_jobs = job_ref->id;
+            else
+                killed_jobs=batsched_tools::string_format("%s %s",killed_jobs.c_str(),job_ref->id.c_str());
         }
         BLOG_F(blog_types::FAILURES,"%s,\"%s\"",blog_failure_event::KILLING_JOBS.c_str(), killed_jobs.c_str());
     }
@@ -191,6 +187,13 @@ void FCFSFast2::on_requested_call(double date,batsched_tools::CALL_ME_LATERS cml
             _need_to_checkpoint = true;
             break;
 
+        case batsched_tools::call_me_later_types::WAKE_UP:
+        case batsched_tools::call_me_later_types::MONITORING_STAGE:
+            //requested by the energy variants only
+            break;
+        case batsched_tools::call_me_later_types::DECISION_QUANTUM:
+            //handled by the drivers, see on_decision_quantum_call
+            break;
     }
 }
 void FCFSFast2::on_ingest_variables(const rapidjson::Document & doc,double date)
@@ -262,7 +265,6 @@ void FCFSFast2::make_decisions(double date,
     // Handle newly finished jobs
     //*****************************************************************
     bool job_ended = false;
-    std::string prefix = "a";
     for (const std::string & ended_job_id : _jobs_ended_recently)
     {
         job_ended = true;
@@ -273,7 +275,7 @@ void FCFSFast2::make_decisions(double date,
                 LOG_F(INFO,"ended job, _share_packing == True");
                 //first get the machine it was running on
                 int machine_number = (_current_allocations[ended_job_id].machines)[0];
-                Machine* current_machine = (*_machines)(prefix,machine_number);
+                Machine* current_machine = (*_machines)[machine_number];
 
                 //now increase cores_available on that machine
                 current_machine->cores_available += 1;
@@ -341,7 +343,7 @@ void FCFSFast2::make_decisions(double date,
                 for (auto it = _available_core_machines.elements_begin(); it != _available_core_machines.elements_end(); ++it)
                 {
                     //is this machine able to handle another job?
-                    Machine* current_machine = (*_machines)(prefix,*it);
+                    Machine* current_machine = (*_machines)[*it];
                     if (current_machine->cores_available >= 1)
                     {                                
                             //it is able to handle another job, execute a job on it and subtract from cores_available
@@ -372,7 +374,7 @@ void FCFSFast2::make_decisions(double date,
                     _decision->add_execute_job(pending_job_id,machines,date,mapping);
 
                     //update data structures
-                    Machine* current_machine = (*_machines)(prefix,machines[0]);
+                    Machine* current_machine = (*_machines)[machines[0]];
                     current_machine->cores_available -= 1;
                     _available_core_machines += machines;
                     _available_machines -= machines;
@@ -444,7 +446,7 @@ void FCFSFast2::make_decisions(double date,
                 for (auto it = _available_core_machines.elements_begin(); it != _available_core_machines.elements_end(); ++it)
                 {
                     //is this machine able to handle another job?
-                    Machine* current_machine = (*_machines)(prefix,*it);
+                    Machine* current_machine = (*_machines)[*it];
                     if (current_machine->cores_available >= 1)
                     {                                
                             //it is able to handle another job, execute a job on it and subtract from cores_available
@@ -476,7 +478,7 @@ void FCFSFast2::make_decisions(double date,
                     _decision->add_execute_job(pending_job_id,machines,date,mapping);
 
                     //update data structures
-                    Machine* current_machine = (*_machines)(prefix,machines[0]);
+                    Machine* current_machine = (*_machines)[machines[0]];
                     current_machine->cores_available -= 1;
                     _available_core_machines += machines;
                     _available_machines -= machines;
@@ -577,7 +579,7 @@ void FCFSFast2::make_decisions(double date,
                 for (auto it = _available_core_machines.elements_begin(); it != _available_core_machines.elements_end(); ++it)
                 {
                     //is this machine able to handle another job?
-                    Machine* current_machine = (*_machines)(prefix,*it);
+                    Machine* current_machine = (*_machines)[*it];
                     if (current_machine->cores_available >= 1)
                     {                                
                             //it is able to handle another job, execute a job on it and subtract from cores_available
@@ -605,7 +607,7 @@ void FCFSFast2::make_decisions(double date,
                     _decision->add_execute_job(new_job_id,machines,date,mapping);
 
                     //update data structures
-                    Machine* current_machine = (*_machines)(prefix,machines[0]);
+                    Machine* current_machine = (*_machines)[machines[0]];
                     current_machine->cores_available -= 1;
                     _available_core_machines += machines;
                     _available_machines -= machines;
@@ -1,6 +1,9 @@
+#include <algorithm>
 #include <cstdarg>
+#include <cstring>
 #include <string>
 #include "batsched_tools.hpp"
+#include "machine.hpp"
 #include <cstdio>
 #include <sys/types.h>
 #include <unistd.h>
@@ -22,7 +25,8 @@ b_log::b_log(){
 }
 b_log::~b_log(){
  for (auto key_value:_files)
-    fclose(key_value.second);
+    if (key_value.second != nullptr)
+        fclose(key_value.second);
 }
 void b_log::add_log_file(std::string file,std::string type, std::string open_method,bool csv,std::string separator){
     LOG_F(INFO,"here");
@@ -58,6 +62,22 @@ void b_log::add_header(std::string type,std::string header){
     fflush(file);
 
 }
+FILE * b_log::begin_row(std::string type,double date){
+    auto file_it = _files.find(type);
+    if (file_it == _files.end())
+        return nullptr;
+    FILE* file = file_it->second;
+    if(!_csv_status[type])
+        std::fprintf(file,"%-60f ||",date);
+    else
+        std::fprintf(file,"%f%s",date,_csv_sep[type].c_str());
+    return file;
+}
+void b_log::end_row(std::string type){
+    FILE* file = _files[type];
+    std::fputc('\n',file);
+    fflush(file);
+}
 void b_log::blog(std::string type, double date,std::string fmt, ...){
     
     
@@ -172,6 +192,85 @@ pid_t batsched_tools::get_batsched_pid()
     return getpid();
 }
 
+namespace
+{
+    bool is_digit(char c) { return c >= '0' && c <= '9'; }
+    bool is_letter(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+
+    //moves pos past the longest run of characters accepted by the predicate, returns the run's length
+    template<typename Predicate>
+    size_t skip(const std::string & line, size_t & pos, Predicate accepted)
+    {
+        size_t begin = pos;
+        while (pos < line.size() && accepted(line[pos]))
+            pos++;
+        return pos - begin;
+    }
+    bool skip_literal(const std::string & line, size_t & pos, const char * literal)
+    {
+        size_t length = strlen(literal);
+        if (line.compare(pos, length, literal) != 0)
+            return false;
+        pos += length;
+        return true;
+    }
+    //'[0-9]+[.][0-9]*[ ]+[|][|]' : the date of the line, the position after '||' is put in pos
+    bool parse_failure_date(const std::string & line, size_t & pos, std::string & date)
+    {
+        pos = 0;
+        if (skip(line, pos, is_digit) == 0 || !skip_literal(line, pos, "."))
+            return false;
+        skip(line, pos, is_digit);
+        date = line.substr(0, pos);
+        return skip(line, pos, [](char c) { return c == ' '; }) > 0 && skip_literal(line, pos, "||");
+    }
+}
+
+std::map<double,batsched_tools::failure_tuple> batsched_tools::parse_failure_file(const std::string & failure_file_path)
+{
+    std::map<double,batsched_tools::failure_tuple> myMap;
+    std::string line;
+    std::ifstream file(failure_file_path);
+    if (file.is_open()) {
+        batsched_tools::failure_tuple atuple;
+        std::string date;
+        size_t pos;
+        while (getline(file, line)) {
+            if (!parse_failure_date(line, pos, date))
+                continue;
+            size_t after_date = pos;
+            //'FAILURE ([A-Za-z]+)' up to the end of the line
+            if (skip_literal(line, pos, "FAILURE ") && skip(line, pos, is_letter) > 0 && pos == line.size())
+            {
+                std::string type = line.substr(after_date + strlen("FAILURE "));
+                if (type == "SMTBF")
+                    atuple.type = batsched_tools::call_me_later_types::SMTBF;
+                else if (type == "MTBF")
+                    atuple.type = batsched_tools::call_me_later_types::MTBF;
+                else if (type == "FIXED_FAILURE")
+                    atuple.type = batsched_tools::call_me_later_types::FIXED_FAILURE;
+                continue;
+            }
+            //'([A-Za-z_]+): ([0-9]+)' up to the end of the line
+            pos = after_date;
+            if (skip(line, pos, [](char c) { return is_letter(c) || c == '_'; }) == 0)
+                continue;
+            size_t method_end = pos;
+            if (!skip_literal(line, pos, ": "))
+                continue;
+            size_t machine_begin = pos;
+            if (skip(line, pos, is_digit) > 0 && pos == line.size())
+            {
+                atuple.method = line.substr(after_date, method_end - after_date);
+                atuple.machine_down = std::stoi(line.substr(machine_begin));
+                myMap[std::stod(date)]=atuple;
+            }
+        }
+    file.close();
+    }
+    return myMap;
+}
+
 
 
 
@@ -404,6 +503,194 @@ batsched_tools::pid_mem batsched_tools::get_pid_memory_usage(pid_t pid=0)
         ret += batsched_tools::pair_to_simple_json_string(std::pair<string,string>("machines",fhp.machines.to_string_hyphen())) + "}";
         return ret;
     }
+    std::string batsched_tools::to_json_string(const batsched_tools::FinishedHorizons & horizons)
+    {
+        std::string ret = "[";
+        for (auto it = horizons.begin(); it != horizons.end(); ++it)
+        {
+            if (it != horizons.begin())
+                ret += ",";
+            ret += batsched_tools::to_json_string(*it);
+        }
+        ret += "]";
+        return ret;
+    }
+
+    batsched_tools::FinishedHorizons::FinishedHorizons(const FinishedHorizons & other)
+    {
+        *this = other;
+    }
+    batsched_tools::FinishedHorizons & batsched_tools::FinishedHorizons::operator=(const FinishedHorizons & other)
+    {
+        //the cursor points into other's points, it is rebuilt by the next earliest_date()
+        _points = other._points;
+        _has_cursor = false;
+        _released_until_cursor = 0;
+        return *this;
+    }
+    batsched_tools::FinishedHorizons::iterator batsched_tools::FinishedHorizons::insert(const FinishedHorizonPoint & point)
+    {
+        //multiset inserts at the upper bound of the equal range: a point of the cursor's date goes after it
+        if (_has_cursor && point.date < _cursor->date)
+            _released_until_cursor += point.nb_released_machines;
+        return _points.insert(point);
+    }
+    void batsched_tools::FinishedHorizons::erase(iterator point_it)
+    {
+        if (_has_cursor)
+        {
+            if (point_it == _cursor)
+            {
+                //move the cursor onto the previous point, or before the first one
+                _released_until_cursor -= _cursor->nb_released_machines;
+                if (_cursor == _points.begin())
+                    _has_cursor = false;
+                else
+                    --_cursor;
+            }
+            else if (point_it->date < _cursor->date)
+                _released_until_cursor -= point_it->nb_released_machines;
+            else if (point_it->date == _cursor->date)
+            {
+                //same date: the point is before the cursor if it is found walking back from it
+                for (auto it = _points.lower_bound(*_cursor); it != _cursor; ++it)
+                    if (it == point_it)
+                    {
+                        _released_until_cursor -= point_it->nb_released_machines;
+                        break;
+                    }
+            }
+        }
+        _points.erase(point_it);
+    }
+    void batsched_tools::FinishedHorizons::clear()
+    {
+        _points.clear();
+        _has_cursor = false;
+        _released_until_cursor = 0;
+    }
+    double batsched_tools::FinishedHorizons::earliest_date(int nb_available, int required)
+    {
+        PPK_ASSERT_ERROR(!_points.empty(), "The job will never be executable.");
+        int needed = required - nb_available;
+        if (!_has_cursor)
+        {
+            _cursor = _points.begin();
+            _released_until_cursor = _cursor->nb_released_machines;
+            _has_cursor = true;
+        }
+        //the released machines only grow with the date: go forward while there are not enough of them...
+        while (_released_until_cursor < needed)
+        {
+            ++_cursor;
+            PPK_ASSERT_ERROR(_cursor != _points.end(), "The job will never be executable.");
+            _released_until_cursor += _cursor->nb_released_machines;
+        }
+        //...and backward while the previous point is already enough
+        while (_cursor != _points.begin() && _released_until_cursor - _cursor->nb_released_machines >= needed)
+        {
+            _released_until_cursor -= _cursor->nb_released_machines;
+            --_cursor;
+        }
+        return _cursor->date;
+    }
+
+    void batsched_tools::FreeCoreIndex::set_machines(Machines * machines, int nb_machines)
+    {
+        _machines.resize(nb_machines);
+        for (int i = 0; i < nb_machines; ++i)
+            _machines[i] = (*machines)[i];
+        clear();
+    }
+    void batsched_tools::FreeCoreIndex::add(int machine_number)
+    {
+        if (_machines[machine_number]->cores_available >= 1)
+            _free.insert(machine_number);
+        else
+            _full.insert(machine_number);
+    }
+    void batsched_tools::FreeCoreIndex::add(const IntervalSet & machines)
+    {
+        for (auto it = machines.elements_begin(); it != machines.elements_end(); ++it)
+            add(*it);
+    }
+    void batsched_tools::FreeCoreIndex::remove(int machine_number)
+    {
+        _free -= machine_number;
+        _full -= machine_number;
+    }
+    void batsched_tools::FreeCoreIndex::clear()
+    {
+        _free = IntervalSet::empty_interval_set();
+        _full = IntervalSet::empty_interval_set();
+    }
+    int batsched_tools::FreeCoreIndex::first_fit() const
+    {
+        return _free.is_empty() ? -1 : _free.first_element();
+    }
+    void batsched_tools::FreeCoreIndex::take_core(int machine_number)
+    {
+        Machine * machine = _machines[machine_number];
+        PPK_ASSERT_ERROR(machine->cores_available >= 1, "No free core left on machine %d", machine_number);
+        machine->cores_available -= 1;
+        if (machine->cores_available == 0)
+        {
+            _free -= machine_number;
+            _full.insert(machine_number);
+        }
+    }
+    bool batsched_tools::FreeCoreIndex::release_core(int machine_number, double core_percent)
+    {
+        Machine * machine = _machines[machine_number];
+        machine->cores_available += 1;
+        if (machine->cores_available == 1)
+        {
+            _full -= machine_number;
+            _free.insert(machine_number);
+        }
+        return machine->cores_available == int(machine->core_count * core_percent);
+    }
+
+    void batsched_tools::MachineJobIndex::add(const std::string & job_id, const IntervalSet & machines)
+    {
+        remove(job_id);
+        _machines_by_job[job_id] = machines;
+        for (auto it = machines.elements_begin(); it != machines.elements_end(); ++it)
+        {
+            if (*it >= (int)_jobs_by_machine.size())
+                _jobs_by_machine.resize(*it + 1);
+            _jobs_by_machine[*it].push_back(job_id);
+        }
+    }
+    void batsched_tools::MachineJobIndex::remove(const std::string & job_id)
+    {
+        auto job_it = _machines_by_job.find(job_id);
+        if (job_it == _machines_by_job.end())
+            return;
+        for (auto it = job_it->second.elements_begin(); it != job_it->second.elements_end(); ++it)
+        {
+            std::vector<std::string> & jobs = _jobs_by_machine[*it];
+            jobs.erase(std::find(jobs.begin(), jobs.end(), job_id));
+        }
+        _machines_by_job.erase(job_it);
+    }
+    void batsched_tools::MachineJobIndex::clear()
+    {
+        _jobs_by_machine.clear();
+        _machines_by_job.clear();
+    }
+    std::vector<std::string> batsched_tools::MachineJobIndex::jobs_on(const IntervalSet & machines) const
+    {
+        std::vector<std::string> jobs;
+        for (auto it = machines.elements_begin(); it != machines.elements_end(); ++it)
+        {
+            if (*it < (int)_jobs_by_machine.size())
+                jobs.insert(jobs.end(), _jobs_by_machine[*it].begin(), _jobs_by_machine[*it].end());
+        }
+        std::sort(jobs.begin(), jobs.end());
+        jobs.erase(std::unique(jobs.begin(), jobs.end()), jobs.end());
+        return jobs;
+    }
     
     std::string batsched_tools::to_json_string(const JobAlloc * alloc)
     {
@@ -426,6 +713,23 @@ batsched_tools::pid_mem batsched_tools::get_pid_memory_usage(pid_t pid=0)
         s+="}";
         return s;
     }
+    void batsched_tools::read_extra_data(batsched_tools::CALL_ME_LATERS & cml)
+    {
+        if (cml.forWhat != call_me_later_types::REPAIR_DONE && cml.forWhat != call_me_later_types::RESERVATION_START)
+            return;
+        rapidjson::Document doc;
+        doc.Parse(cml.extra_data.c_str());
+        if (cml.forWhat == call_me_later_types::REPAIR_DONE)
+        {
+            PPK_ASSERT_ERROR(!doc.HasParseError() && doc.HasMember("machine"),"Error, repair done but no 'machine' field in extra_data");
+            cml.machine = doc["machine"].GetInt();
+        }
+        else
+        {
+            PPK_ASSERT_ERROR(!doc.HasParseError() && doc.HasMember("job_id"),"Error, there is no job_id in RESERVATION_START call_me_later");
+            cml.job_id = doc["job_id"].GetString();
+        }
+    }
     std::string batsched_tools::to_json_string(const batsched_tools::CALL_ME_LATERS &cml)
     {
         std::string s;
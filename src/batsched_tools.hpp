@@ -15,6 +15,8 @@
 #include "loguru.hpp"
 struct JobAlloc;
 struct Job;
+struct Machine;
+class Machines;
 
 //ingestMacro
 #define ingestM(variable,outervariable,json) PPK_ASSERT_ERROR(json.HasMember(#variable),"ingesting '%s' failed, no '%s' in json",#outervariable,#variable); variable = ingest(variable,json[#variable])
@@ -41,6 +43,10 @@ b_log();
 void blog(std::string type,double date,std::string fmt,...);
 void add_log_file(std::string file, std::string type,std::string open_method,bool csv = false,std::string separator = ",");
 void add_header(std::string type,std::string header);
+//writes the date column of a row and returns the file, so a long row can be written piece by piece
+//instead of being formatted into a string first.  nullptr if there is no such log.  Finish the row with end_row()
+FILE * begin_row(std::string type,double date);
+void end_row(std::string type);
 void copy_file(std::string file, std::string type,std::string copy_location);
 
 std::unordered_map<std::string,FILE*> _files;
@@ -84,6 +90,9 @@ namespace batsched_tools{
         ,CHECKPOINT_BATSCHED
         ,RECOVER_FROM_CHECKPOINT
         ,METRICS
+        ,WAKE_UP //no event behind it, the scheduler only wants to run again
+        ,MONITORING_STAGE
+        ,DECISION_QUANTUM //end of a decision quantum, the submissions and completions deferred to it are decided
     };
     enum class KILL_TYPES 
     {
@@ -117,6 +126,12 @@ namespace batsched_tools{
         batsched_tools::call_me_later_types type;
         std::string method;
     };
+    /**
+     * @brief Reads a failures file into a map of failure date -> failure
+     * @details A line 'DATE ||FAILURE TYPE' sets the type of the failures that follow it, a line
+     * 'DATE ||METHOD: MACHINE' is a failure. Any other line is ignored.
+     */
+    std::map<double,failure_tuple> parse_failure_file(const std::string & failure_file_path);
     struct id_separation{
         std::string basename;
         std::string resubmit_string;
@@ -139,13 +154,125 @@ namespace batsched_tools{
         double date;
         int nb_released_machines;
         IntervalSet machines; //used if share-packing
-        int index = -1; //only set during a checkpoint, not any other use
+        mutable int index = -1; //only set during a checkpoint, not any other use
+    };
+    struct FinishedHorizonPointOrder
+    {
+        bool operator()(const FinishedHorizonPoint & a, const FinishedHorizonPoint & b) const
+        {
+            return a.date < b.date;
+        }
+    };
+
+    /**
+     * @brief The dates at which running jobs will release their machines, sorted by date
+     * @details Points of the same date are kept in insertion order.  On top of the points, a cursor on
+     *          the last answer of earliest_date() is kept with the number of machines released up to it, so
+     *          that inserting or erasing a point only updates that prefix sum and the next query only moves
+     *          the cursor by as many points as the shadow time actually moved.
+     */
+    class FinishedHorizons
+    {
+    public:
+        typedef std::multiset<FinishedHorizonPoint, FinishedHorizonPointOrder>::iterator iterator;
+
+        FinishedHorizons() = default;
+        FinishedHorizons(const FinishedHorizons & other);
+        FinishedHorizons & operator=(const FinishedHorizons & other);
+
+        iterator insert(const FinishedHorizonPoint & point);
+        void erase(iterator point_it);
+        void clear();
+
+        iterator begin() const { return _points.begin(); }
+        iterator end() const { return _points.end(); }
+        bool empty() const { return _points.empty(); }
+        int size() const { return (int)_points.size(); }
+
+        /**
+         * @brief Returns the first date at which nb_available + the machines released so far reach required
+         * @details Only additive releases are handled, share-packing single core releases need the per-machine walk.
+         *          Asserts if the machines are never reached.
+         */
+        double earliest_date(int nb_available, int required);
+
+    private:
+        std::multiset<FinishedHorizonPoint, FinishedHorizonPointOrder> _points;
+        iterator _cursor; //!< only meaningful if _has_cursor
+        bool _has_cursor = false;
+        int _released_until_cursor = 0; //!< machines released by the points from begin() to _cursor included
+    };
+
+    /**
+     * @brief The machines used for share-packing, bucketed on whether they still have a free core
+     * @details The Machine objects are cached in a vector indexed by machine number, whatever their prefix, so
+     *          taking or releasing a core never goes through Machines.  first_fit() is the lowest numbered machine of the
+     *          free bucket, i.e. the machine a walk over the share-packing machines in order would pick.
+     */
+    class FreeCoreIndex
+    {
+    public:
+        void set_machines(Machines * machines, int nb_machines);
+        Machine * machine(int machine_number) const { return _machines[machine_number]; }
+
+        void add(int machine_number);
+        void add(const IntervalSet & machines);
+        void remove(int machine_number);
+        void clear();
+
+        /**
+         * @brief Returns the lowest numbered machine having a free core, -1 if there is none
+         */
+        int first_fit() const;
+        void take_core(int machine_number);
+        /**
+         * @brief Gives a core back to the machine
+         * @return true if all the usable cores of the machine are free again
+         */
+        bool release_core(int machine_number, double core_percent);
+
+    private:
+        std::vector<Machine *> _machines;
+        IntervalSet _free; //!< machines with at least one free core
+        IntervalSet _full; //!< machines with no free core
+    };
+
+    /**
+     * @brief The jobs running on each machine, kept up to date as jobs start and end
+     * @details Finding the victims of a failure costs the number of jobs on the failed machines
+     *          instead of a pass over every running job.
+     */
+    class MachineJobIndex
+    {
+    public:
+        /**
+         * @brief Records the job as running on the machines, replacing any previous record of it
+         */
+        void add(const std::string & job_id, const IntervalSet & machines);
+        /**
+         * @brief Forgets the job, does nothing if it is not in the index
+         */
+        void remove(const std::string & job_id);
+        void clear();
+        bool empty() const { return _machines_by_job.empty(); }
+        /**
+         * @brief Returns the jobs running on at least one of the machines, sorted by id and without duplicates
+         */
+        std::vector<std::string> jobs_on(const IntervalSet & machines) const;
+        bool has_jobs_on(int machine) const
+        {
+            return machine < (int)_jobs_by_machine.size() && !_jobs_by_machine[machine].empty();
+        }
+
+    private:
+        std::vector<std::vector<std::string>> _jobs_by_machine; //!< indexed by machine number
+        std::unordered_map<std::string, IntervalSet> _machines_by_job;
     };
 
     struct Allocation
     {
         IntervalSet machines;
-        std::list<FinishedHorizonPoint>::iterator horizon_it;
+        FinishedHorizons::iterator horizon_it;
         bool has_horizon = true;
 
     };
@@ -207,11 +334,17 @@ namespace batsched_tools{
       double first_submitted_time=0;
     };
     struct CALL_ME_LATERS{
-        double time;  //time to call back
+        double time = -1;  //time to call back
         int id; //id of call me later.
         batsched_tools::call_me_later_types forWhat; //what is the callback for? So we know how to deal with it.
         std::string extra_data="{}"; //any extra json data?  repair done uses this for the machine number that is done.
+        int machine = -1; //REPAIR_DONE: the machine that is repaired, extra_data parsed once
+        std::string job_id; //RESERVATION_START: the reservation to start, extra_data parsed once
     };
+    /**
+     * @brief Fills the typed fields of the call me later (machine, job_id) from its extra_data
+     */
+    void read_extra_data(CALL_ME_LATERS & cml);
 
     
 
@@ -279,6 +412,7 @@ namespace batsched_tools{
     std::string to_json_string(const batsched_tools::Allocation & alloc);
     std::string to_json_string(const batsched_tools::FinishedHorizonPoint * fhp);
     std::string to_json_string(const batsched_tools::FinishedHorizonPoint & fhp);
+    std::string to_json_string(const batsched_tools::FinishedHorizons & horizons);
     std::string to_json_string(const batsched_tools::CALL_ME_LATERS &cml);
     std::string to_json_string(const std::chrono::_V2::system_clock::time_point &tp);
     std::string to_json_string(const batsched_tools::Scheduled_Job* sj);
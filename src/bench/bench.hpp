@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../json_workload.hpp"
+
+// Microbenchmarks of the scheduling core (batsched-bench).
+// Each benchmark builds its own input from the Parameters, times only the operation it is named after,
+// and returns how many operations it timed.  bench_main.cpp does the repetitions and the reporting.
+
+namespace bench
+{
+    struct Parameters
+    {
+        int queue_size; //!< number of jobs involved (queue length, jobs in the schedule...)
+        int platform_size; //!< number of machines
+        unsigned long seed; //!< every random input is drawn from this seed, so runs are comparable
+    };
+
+    struct Measure
+    {
+        long nb_operations = 0;
+        double seconds = 0;
+    };
+
+    struct Benchmark
+    {
+        std::string name;
+        std::function<Measure(const Parameters &)> function;
+    };
+
+    class Timer
+    {
+    public:
+        void start() { _start = std::chrono::steady_clock::now(); }
+        double stop() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count(); }
+    private:
+        std::chrono::steady_clock::time_point _start;
+    };
+
+    /**
+     * @brief Builds nb_jobs jobs with random sizes in [1,platform_size] and walltimes in [60,86400]
+     * @details The jobs are owned by the caller, free them with delete_jobs()
+     */
+    std::vector<Job *> make_jobs(int nb_jobs, int platform_size, std::mt19937 & generator);
+    void delete_jobs(std::vector<Job *> & jobs);
+
+    /**
+     * @brief Builds an IntervalSet of about half of [0,platform_size-1], made of many small random intervals
+     */
+    IntervalSet make_fragmented_set(int platform_size, std::mt19937 & generator);
+
+    //a keep-alive sink, so the compiler cannot drop the timed calls
+    extern volatile long sink;
+
+    void add_schedule_benchmarks(std::vector<Benchmark> & benchmarks);
+    void add_queue_benchmarks(std::vector<Benchmark> & benchmarks);
+    void add_locality_benchmarks(std::vector<Benchmark> & benchmarks);
+    void add_machines_benchmarks(std::vector<Benchmark> & benchmarks);
+    void add_startup_benchmarks(std::vector<Benchmark> & benchmarks);
+    void add_waiting_time_benchmarks(std::vector<Benchmark> & benchmarks);
+    void add_easy_bf3_benchmarks(std::vector<Benchmark> & benchmarks);
+}
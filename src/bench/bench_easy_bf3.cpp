@@ -0,0 +1,293 @@
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+
+#include <rapidjson/document.h>
+
+#include "../job_lists.hpp"
+#include "../scheduler.hpp"
+#include "../synthetic_simulator.hpp"
+#include "bench.hpp"
+#if __has_include(<filesystem>)
+#include <filesystem>
+namespace fs = std::filesystem;
+#elif __has_include(<experimental/filesystem>)
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+
+using namespace std;
+namespace r = rapidjson;
+
+namespace
+{
+    const int nb_decisions = 64;
+    const int arrivals_per_decision = 2;
+
+    //the waiting and running jobs as easy_bf3 kept them before WaitingJobs and ScheduledJobs: vectors heap sorted
+    //on every decision and insertion, ids parsed on every comparison, and linear searches to remove a job
+    class SortedVectors
+    {
+    public:
+        ~SortedVectors()
+        {
+            for (batsched_tools::Scheduled_Job * job : _scheduled)
+                delete job;
+        }
+
+        void queue(Job * job) { _waiting.push_back(job); }
+
+        void sort()
+        {
+            auto number = [](const string & id)
+            {
+                size_t begin = id.find('!') + 1;
+                size_t end = id.find_first_not_of("0123456789", begin);
+                return std::stoi(id.substr(begin, end - begin));
+            };
+            auto compare = [&number](const Job * a, const Job * b)
+            {
+                if (a->original_submit == b->original_submit)
+                    return number(a->id) < number(b->id);
+                return a->original_submit < b->original_submit;
+            };
+            make_heap(_waiting.begin(), _waiting.end(), compare);
+            sort_heap(_waiting.begin(), _waiting.end(), compare);
+        }
+
+        Job * first() { return _waiting.empty() ? nullptr : _waiting.front(); }
+
+        void remove_waiting(const string & job_id)
+        {
+            _waiting.erase(find_if(_waiting.begin(), _waiting.end(), [&job_id](Job * job) { return job->id == job_id; }));
+        }
+
+        void start(batsched_tools::Scheduled_Job * job)
+        {
+            _scheduled.push_back(job);
+            auto compare = [](const batsched_tools::Scheduled_Job * a, const batsched_tools::Scheduled_Job * b)
+            {
+                return a->est_finish_time < b->est_finish_time;
+            };
+            make_heap(_scheduled.begin(), _scheduled.end(), compare);
+            sort_heap(_scheduled.begin(), _scheduled.end(), compare);
+        }
+
+        void finish(const string & job_id)
+        {
+            auto it = find_if(_scheduled.begin(), _scheduled.end(),
+                              [&job_id](batsched_tools::Scheduled_Job * job) { return job->id == job_id; });
+            delete *it;
+            _scheduled.erase(it);
+        }
+
+        size_t size() const { return _waiting.size(); }
+
+    private:
+        vector<Job *> _waiting;
+        vector<batsched_tools::Scheduled_Job *> _scheduled;
+    };
+
+    //the same operations on the persistent lists easy_bf3 uses now
+    class IndexedLists
+    {
+    public:
+        void queue(Job * job) { _waiting.insert(job); }
+        void sort() {}
+        Job * first() { return _waiting.empty() ? nullptr : _waiting.begin()->job; }
+        void remove_waiting(const string & job_id) { _waiting.erase(job_id); }
+        void start(batsched_tools::Scheduled_Job * job) { _scheduled.insert(job); }
+        void finish(const string & job_id) { _scheduled.erase(_scheduled.find(job_id)); }
+        size_t size() const { return _waiting.size(); }
+
+    private:
+        WaitingJobs _waiting;
+        ScheduledJobs _scheduled;
+    };
+
+    batsched_tools::Scheduled_Job * make_scheduled_job(const Job * job, double date)
+    {
+        batsched_tools::Scheduled_Job * scheduled = new batsched_tools::Scheduled_Job();
+        scheduled->id = job->id;
+        scheduled->requested_resources = job->nb_requested_resources;
+        scheduled->wall_time = job->walltime.convert_to<double>();
+        scheduled->start_time = date;
+        scheduled->est_finish_time = date + scheduled->wall_time;
+        return scheduled;
+    }
+
+    //the queue work of one easy_bf3 decision with queue_size waiting jobs and platform_size / 4 running ones:
+    //new jobs are queued, the queue is sorted, the priority job and a backfilled job start, and as many
+    //running jobs finish.  One decision is one operation
+    template <typename Lists>
+    bench::Measure decision(const bench::Parameters & parameters)
+    {
+        const int nb_running = max(1, parameters.platform_size / 4);
+        const int nb_jobs = parameters.queue_size + nb_running + nb_decisions * arrivals_per_decision;
+        mt19937 generator(parameters.seed);
+        vector<Job *> jobs = bench::make_jobs(nb_jobs, parameters.platform_size, generator);
+        bench::Measure measure;
+        {
+            Lists lists;
+            //the bookkeeping of the benchmark, to pick the backfilled and finished jobs in O(1)
+            vector<Job *> waiting;
+            unordered_map<const Job *, size_t> position;
+            auto add_waiting = [&](Job * job)
+            {
+                position[job] = waiting.size();
+                waiting.push_back(job);
+            };
+            auto remove_waiting = [&](Job * job)
+            {
+                size_t index = position[job];
+                waiting[index] = waiting.back();
+                position[waiting[index]] = index;
+                waiting.pop_back();
+                position.erase(job);
+            };
+            deque<string> running;
+            int next_job = 0;
+            for (; next_job < nb_running; ++next_job)
+            {
+                lists.start(make_scheduled_job(jobs[next_job], 0));
+                running.push_back(jobs[next_job]->id);
+            }
+            for (; next_job < nb_running + parameters.queue_size; ++next_job)
+            {
+                lists.queue(jobs[next_job]);
+                add_waiting(jobs[next_job]);
+            }
+            lists.sort();
+            vector<size_t> backfilled;
+            for (int i = 0; i < nb_decisions; ++i)
+                backfilled.push_back(generator());
+
+            bench::Timer timer;
+            timer.start();
+            for (int i = 0; i < nb_decisions; ++i)
+            {
+                double date = i + 1;
+                for (int arrival = 0; arrival < arrivals_per_decision; ++arrival, ++next_job)
+                {
+                    lists.queue(jobs[next_job]);
+                    add_waiting(jobs[next_job]);
+                }
+                lists.sort();
+
+                Job * priority = lists.first();
+                Job * backfill = waiting[backfilled[i] % waiting.size()];
+                if (backfill == priority)
+                    backfill = nullptr;
+                for (Job * job : {priority, backfill})
+                {
+                    if (job == nullptr)
+                        continue;
+                    lists.remove_waiting(job->id);
+                    lists.start(make_scheduled_job(job, date));
+                    remove_waiting(job);
+                    running.push_back(job->id);
+                }
+
+                //as many jobs finish as started, so the numbers of waiting and running jobs stay the same
+                while ((int)running.size() > nb_running)
+                {
+                    lists.finish(running.front());
+                    running.pop_front();
+                }
+            }
+            measure.seconds = timer.stop();
+            measure.nb_operations = nb_decisions;
+            bench::sink += lists.size();
+        }
+        bench::delete_jobs(jobs);
+        return measure;
+    }
+
+    void add_event(r::Document & events, double date, const string & type, const string & data)
+    {
+        r::Document::AllocatorType & alloc = events.GetAllocator();
+        r::Document data_doc;
+        data_doc.Parse(data.c_str());
+        r::Value event(r::kObjectType);
+        event.AddMember("timestamp", r::Value().SetDouble(date), alloc);
+        event.AddMember("type", r::Value(type.c_str(), alloc), alloc);
+        r::Value event_data;
+        event_data.CopyFrom(data_doc, alloc);
+        event.AddMember("data", event_data, alloc);
+        events.PushBack(event, alloc);
+    }
+
+    //the decisions of the easy_bf3 variant itself, driven through a Scheduler with about queue_size waiting jobs:
+    //on top of its job lists, they parse the events, fit the jobs on the machines and write the decisions.
+    //Each decision brings new jobs and as many completions of the jobs that started first.  One decision is one operation
+    bench::Measure scheduler_decision(const bench::Parameters & parameters)
+    {
+        mt19937 generator(parameters.seed);
+        uniform_int_distribution<int> size(1, max(1, parameters.platform_size / 4));
+        uniform_int_distribution<int> walltime(60, 86400);
+        int next_job = 0;
+        auto make_job = [&](double date)
+        {
+            double job_walltime = walltime(generator);
+            return SyntheticJob{"w0!" + std::to_string(next_job++), size(generator), date, job_walltime, job_walltime}.to_json_string();
+        };
+        //the variant writes its logs there
+        const string folder = "/tmp/batsched-bench-easy_bf3-" + std::to_string(batsched_tools::get_batsched_pid());
+        fs::create_directories(folder + "/out");
+        fs::create_directories(folder + "/log");
+        SyntheticOptions options;
+        options.nb_machines = parameters.platform_size;
+        SchedulerOptions scheduler_options;
+        scheduler_options.variant = "easy_bf3";
+
+        bench::Measure measure;
+        {
+            Scheduler scheduler(scheduler_options);
+            deque<string> running;
+            auto record_starts = [&running](const r::Value & decisions)
+            {
+                for (const r::Value & event : decisions.GetArray())
+                    if (string(event["type"].GetString()) == "EXECUTE_JOB")
+                        running.push_back(event["data"]["job_id"].GetString());
+            };
+
+            //the machines are filled first, the jobs left wait
+            r::Document events(r::kArrayType);
+            add_event(events, 0, "SIMULATION_BEGINS", SyntheticSimulator::simulation_begins_data(options, folder));
+            for (int i = 0; i < parameters.queue_size + parameters.platform_size; ++i)
+                add_event(events, 0, "JOB_SUBMITTED", make_job(0));
+            record_starts(scheduler.decide(0, events));
+
+            bench::Timer timer;
+            for (int i = 0; i < nb_decisions; ++i)
+            {
+                double date = i + 1;
+                r::Document message(r::kArrayType);
+                for (int arrival = 0; arrival < arrivals_per_decision; ++arrival)
+                {
+                    add_event(message, date, "JOB_SUBMITTED", make_job(date));
+                    if (running.empty())
+                        continue;
+                    add_event(message, date, "JOB_COMPLETED",
+                              "{\"job_id\":\"" + running.front() + "\",\"job_state\":\"COMPLETED_SUCCESSFULLY\"}");
+                    running.pop_front();
+                }
+                timer.start();
+                const r::Value & decisions = scheduler.decide(date, message);
+                measure.seconds += timer.stop();
+                record_starts(decisions);
+            }
+            measure.nb_operations = nb_decisions;
+            bench::sink += running.size();
+        }
+        fs::remove_all(folder);
+        return measure;
+    }
+}
+
+void bench::add_easy_bf3_benchmarks(vector<Benchmark> & benchmarks)
+{
+    benchmarks.push_back({"easy_bf3/decision_sorted_vectors", decision<SortedVectors>});
+    benchmarks.push_back({"easy_bf3/decision_indexed_lists", decision<IndexedLists>});
+    benchmarks.push_back({"easy_bf3/decision_scheduler", scheduler_decision});
+}
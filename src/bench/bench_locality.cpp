@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <string>
+
+#include <rapidjson/document.h>
+
+#include "../locality.hpp"
+#include "bench.hpp"
+
+using namespace std;
+
+namespace
+{
+    //one fit per job of the queue against the same fragmented set of available machines.
+    //sizes go up to the number of available machines, so the contiguous selector also pays for the misses
+    bench::Measure fit(const bench::Parameters & parameters, ResourceSelector * selector)
+    {
+        mt19937 generator(parameters.seed);
+        IntervalSet available = bench::make_fragmented_set(parameters.platform_size, generator);
+        vector<Job *> jobs = bench::make_jobs(parameters.queue_size, std::max(1, (int)available.size()), generator);
+
+        long nb_fits = 0;
+        bench::Timer timer;
+        timer.start();
+        for (const Job * job : jobs)
+        {
+            IntervalSet allocated;
+            if (selector->fit(job, available, allocated))
+                ++nb_fits;
+        }
+        bench::Measure measure;
+        measure.seconds = timer.stop();
+        measure.nb_operations = jobs.size();
+        bench::sink += nb_fits;
+
+        bench::delete_jobs(jobs);
+        return measure;
+    }
+
+    //switches of 16 machines, racks of 8 switches
+    rapidjson::Document make_topology(int platform_size)
+    {
+        rapidjson::Document doc;
+        doc.SetObject();
+        auto & allocator = doc.GetAllocator();
+        rapidjson::Value levels(rapidjson::kArrayType);
+        for (int group_size : {16, 128})
+        {
+            rapidjson::Value groups(rapidjson::kArrayType);
+            for (int lower = 0; lower < platform_size; lower += group_size)
+            {
+                string group = std::to_string(lower) + "-" + std::to_string(std::min(lower + group_size, platform_size) - 1);
+                groups.PushBack(rapidjson::Value(group.c_str(), allocator), allocator);
+            }
+            rapidjson::Value level(rapidjson::kObjectType);
+            level.AddMember("groups", groups, allocator);
+            levels.PushBack(level, allocator);
+        }
+        doc.AddMember("levels", levels, allocator);
+        return doc;
+    }
+}
+
+void bench::add_locality_benchmarks(vector<Benchmark> & benchmarks)
+{
+    benchmarks.push_back({"locality/basic_fit", [](const Parameters & p)
+                          {
+                              BasicResourceSelector selector;
+                              return fit(p, &selector);
+                          }});
+    benchmarks.push_back({"locality/contiguous_fit", [](const Parameters & p)
+                          {
+                              ContiguousResourceSelector selector;
+                              return fit(p, &selector);
+                          }});
+    benchmarks.push_back({"locality/best_fit_fit", [](const Parameters & p)
+                          {
+                              BestFitResourceSelector selector;
+                              return fit(p, &selector);
+                          }});
+    benchmarks.push_back({"locality/topology_fit", [](const Parameters & p)
+                          {
+                              TopologyResourceSelector selector(make_topology(p.platform_size));
+                              return fit(p, &selector);
+                          }});
+}
@@ -0,0 +1,95 @@
+#include <rapidjson/document.h>
+
+#include "../machine.hpp"
+#include "bench.hpp"
+
+using namespace std;
+
+namespace
+{
+    //the machine objects as Batsim sends them on SIMULATION_BEGINS (compute_resources)
+    rapidjson::Document make_machines_json(int platform_size)
+    {
+        rapidjson::Document doc;
+        doc.SetArray();
+        auto & allocator = doc.GetAllocator();
+        for (int i = 0; i < platform_size; ++i)
+        {
+            rapidjson::Value machine(rapidjson::kObjectType);
+            string name = "node" + std::to_string(i);
+            machine.AddMember("name", rapidjson::Value(name.c_str(), allocator), allocator);
+            machine.AddMember("id", rapidjson::Value(i), allocator);
+            machine.AddMember("core_count", rapidjson::Value(1), allocator);
+            machine.AddMember("speed", rapidjson::Value(1.0), allocator);
+            machine.AddMember("repair_time", rapidjson::Value(0.0), allocator);
+            doc.PushBack(machine, allocator);
+        }
+        return doc;
+    }
+
+    void add_machines(Machines & machines, const rapidjson::Document & doc)
+    {
+        for (rapidjson::SizeType i = 0; i < doc.Size(); ++i)
+            machines.add_machine_from_json_object(doc[i]);
+    }
+
+    bench::Measure add_machine(const bench::Parameters & parameters)
+    {
+        rapidjson::Document doc = make_machines_json(parameters.platform_size);
+        Machines machines;
+        bench::Timer timer;
+        timer.start();
+        add_machines(machines, doc);
+        bench::Measure measure;
+        measure.seconds = timer.stop();
+        measure.nb_operations = parameters.platform_size;
+        return measure;
+    }
+
+    //queue_size random lookups, with the kind of key the algorithms have at hand
+    template <typename Lookup>
+    bench::Measure lookup(const bench::Parameters & parameters, Lookup lookup_function)
+    {
+        rapidjson::Document doc = make_machines_json(parameters.platform_size);
+        Machines machines;
+        add_machines(machines, doc);
+        mt19937 generator(parameters.seed);
+        uniform_int_distribution<int> machine(0, parameters.platform_size - 1);
+        vector<int> ids;
+        for (int i = 0; i < parameters.queue_size; ++i)
+            ids.push_back(machine(generator));
+        vector<string> names;
+        for (int id : ids)
+            names.push_back("node" + std::to_string(id));
+
+        bench::Timer timer;
+        timer.start();
+        for (int i = 0; i < parameters.queue_size; ++i)
+            bench::sink += lookup_function(machines, ids[i], names[i])->id;
+        bench::Measure measure;
+        measure.seconds = timer.stop();
+        measure.nb_operations = parameters.queue_size;
+        return measure;
+    }
+}
+
+void bench::add_machines_benchmarks(vector<Benchmark> & benchmarks)
+{
+    benchmarks.push_back({"machines/add_machine_from_json_object", add_machine});
+    benchmarks.push_back({"machines/lookup_by_id", [](const Parameters & p)
+                          {
+                              return lookup(p, [](Machines & m, int id, const string &) { return m[id]; });
+                          }});
+    benchmarks.push_back({"machines/lookup_by_name", [](const Parameters & p)
+                          {
+                              return lookup(p, [](Machines & m, int, const string & name) { return m[name]; });
+                          }});
+    benchmarks.push_back({"machines/lookup_by_prefix", [](const Parameters & p)
+                          {
+                              return lookup(p, [](Machines & m, int id, const string &) { return m("node", id); });
+                          }});
+    benchmarks.push_back({"machines/lookup_by_prefix_id", [](const Parameters & p)
+                          {
+                              return lookup(p, [](Machines & m, int id, const string &) { return m(0, id); });
+                          }});
+}
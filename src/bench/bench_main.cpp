@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+
+#include <loguru.hpp>
+
+#include "../external/taywee_args.hpp"
+#include "../pempek_assert.hpp"
+#include "../batsched_tools.hpp"
+#include "bench.hpp"
+
+using namespace std;
+
+volatile long bench::sink = 0;
+
+vector<Job *> bench::make_jobs(int nb_jobs, int platform_size, mt19937 & generator)
+{
+    uniform_int_distribution<int> size(1, platform_size);
+    uniform_int_distribution<int> walltime(60, 86400);
+    vector<Job *> jobs;
+    jobs.reserve(nb_jobs);
+    for (int i = 0; i < nb_jobs; ++i)
+    {
+        Job * job = new Job;
+        job->id = "w0!" + std::to_string(i);
+        job->unique_number = i;
+        job->nb_requested_resources = size(generator);
+        job->walltime = walltime(generator);
+        job->has_walltime = true;
+        job->submission_time = i;
+        job->original_submit = i;
+        job->submission_times.push_back(i);
+        job->checkpoint_job_data = nullptr;
+        jobs.push_back(job);
+    }
+    return jobs;
+}
+
+void bench::delete_jobs(vector<Job *> & jobs)
+{
+    for (Job * job : jobs)
+    {
+        for (auto & alloc : job->allocations)
+            delete alloc.second;
+        delete job;
+    }
+    jobs.clear();
+}
+
+IntervalSet bench::make_fragmented_set(int platform_size, mt19937 & generator)
+{
+    uniform_int_distribution<int> run(1, 8);
+    IntervalSet set;
+    int machine = 0;
+    bool available = true;
+    while (machine < platform_size)
+    {
+        int length = std::min(run(generator), platform_size - machine);
+        if (available)
+            set.insert(IntervalSet::ClosedInterval(machine, machine + length - 1));
+        machine += length;
+        available = !available;
+    }
+    return set;
+}
+
+static vector<int> parse_sizes(const string & sizes)
+{
+    vector<string> parts;
+    boost::split(parts, sizes, boost::is_any_of(","));
+    vector<int> result;
+    for (const string & part : parts)
+    {
+        int value = std::stoi(part);
+        PPK_ASSERT_ERROR(value > 0, "Invalid size '%s': must be strictly positive", part.c_str());
+        result.push_back(value);
+    }
+    return result;
+}
+
+int main(int argc, char ** argv)
+{
+    args::ArgumentParser parser("Microbenchmarks of the batsched scheduling core.");
+    args::HelpFlag flag_help(parser, "help", "Display this help menu", {'h', "help"});
+    args::ValueFlag<string> flag_queue_sizes(parser, "sizes", "Comma-separated queue sizes (number of jobs) to run each benchmark with", {'q', "queue_sizes"}, "100,1000");
+    args::ValueFlag<string> flag_platform_sizes(parser, "sizes", "Comma-separated platform sizes (number of machines) to run each benchmark with", {'m', "platform_sizes"}, "128,4096");
+    args::ValueFlag<int> flag_repetitions(parser, "repetitions", "Number of times each benchmark is repeated", {'r', "repetitions"}, 5);
+    args::ValueFlag<unsigned long> flag_seed(parser, "seed", "Seed of the random inputs", {"seed"}, 42);
+    args::ValueFlag<string> flag_filter(parser, "filter", "Only runs the benchmarks whose name contains this string", {'f', "filter"}, "");
+    args::ValueFlag<string> flag_format(parser, "format", "Output format, csv or json", {"format"}, "csv");
+    args::ValueFlag<string> flag_output(parser, "output", "File where the results are written. stdout if empty.", {'o', "output"}, "");
+    args::Flag flag_list(parser, "list", "Lists the benchmarks and exits", {"list"});
+
+    try
+    {
+        parser.ParseCLI(argc, argv);
+        if (flag_format.Get() != "csv" && flag_format.Get() != "json")
+            throw args::ValidationError("Invalid 'format' value (" + flag_format.Get() + "): Not in {csv, json}");
+        if (flag_repetitions.Get() <= 0)
+            throw args::ValidationError("Invalid 'repetitions' value: Must be strictly positive.");
+    }
+    catch(args::Help&)
+    {
+        parser.helpParams.addDefault = true;
+        printf("%s", parser.Help().c_str());
+        return 0;
+    }
+    catch(args::ParseError & e)
+    {
+        printf("%s\n", e.what());
+        return 1;
+    }
+    catch(args::ValidationError & e)
+    {
+        printf("%s\n", e.what());
+        return 1;
+    }
+    // The scheduling core logs a lot at INFO level, which would be measured too
+    loguru::g_stderr_verbosity = loguru::Verbosity_OFF;
+
+    vector<bench::Benchmark> benchmarks;
+    bench::add_schedule_benchmarks(benchmarks);
+    bench::add_queue_benchmarks(benchmarks);
+    bench::add_locality_benchmarks(benchmarks);
+    bench::add_machines_benchmarks(benchmarks);
+    bench::add_startup_benchmarks(benchmarks);
+    bench::add_waiting_time_benchmarks(benchmarks);
+    bench::add_easy_bf3_benchmarks(benchmarks);
+
+    if (flag_list)
+    {
+        for (const bench::Benchmark & benchmark : benchmarks)
+            printf("%s\n", benchmark.name.c_str());
+        return 0;
+    }
+
+    const vector<int> queue_sizes = parse_sizes(flag_queue_sizes.Get());
+    const vector<int> platform_sizes = parse_sizes(flag_platform_sizes.Get());
+    const bool csv = flag_format.Get() == "csv";
+    const int repetitions = flag_repetitions.Get();
+
+    string results = csv ? "benchmark,queue_size,platform_size,repetitions,operations,ns_per_op_min,ns_per_op_median,ns_per_op_mean\n"
+                         : "[";
+    bool first = true;
+    for (const bench::Benchmark & benchmark : benchmarks)
+    {
+        if (benchmark.name.find(flag_filter.Get()) == string::npos)
+            continue;
+        for (int platform_size : platform_sizes)
+        {
+            for (int queue_size : queue_sizes)
+            {
+                bench::Parameters parameters{queue_size, platform_size, flag_seed.Get()};
+                vector<double> ns_per_op;
+                long operations = 0;
+                for (int repetition = 0; repetition < repetitions; ++repetition)
+                {
+                    bench::Measure measure = benchmark.function(parameters);
+                    operations = measure.nb_operations;
+                    ns_per_op.push_back(measure.nb_operations > 0 ? measure.seconds * 1e9 / measure.nb_operations : 0);
+                }
+                std::sort(ns_per_op.begin(), ns_per_op.end());
+                double mean = 0;
+                for (double value : ns_per_op)
+                    mean += value;
+                mean /= ns_per_op.size();
+                double median = ns_per_op[ns_per_op.size() / 2];
+
+                if (csv)
+                    results += batsched_tools::string_format("%s,%d,%d,%d,%ld,%.3f,%.3f,%.3f\n",
+                        benchmark.name.c_str(), queue_size, platform_size, repetitions, operations,
+                        ns_per_op.front(), median, mean);
+                else
+                    results += batsched_tools::string_format("%s\n{\"benchmark\":\"%s\",\"queue_size\":%d,\"platform_size\":%d,"
+                        "\"repetitions\":%d,\"operations\":%ld,\"ns_per_op_min\":%.3f,\"ns_per_op_median\":%.3f,\"ns_per_op_mean\":%.3f}",
+                        first ? "" : ",", benchmark.name.c_str(), queue_size, platform_size, repetitions, operations,
+                        ns_per_op.front(), median, mean);
+                first = false;
+                fprintf(stderr, "%s queue_size=%d platform_size=%d: %.3f ns/op\n",
+                        benchmark.name.c_str(), queue_size, platform_size, median);
+            }
+        }
+    }
+    if (!csv)
+        results += "\n]\n";
+
+    if (flag_output.Get().empty())
+        printf("%s", results.c_str());
+    else
+    {
+        ofstream f(flag_output.Get());
+        PPK_ASSERT_ERROR(f.is_open(), "Couldn't open output file '%s'", flag_output.Get().c_str());
+        f << results;
+    }
+    return 0;
+}
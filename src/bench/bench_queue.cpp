@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <memory>
+
+#include "../queue.hpp"
+#include "bench.hpp"
+
+using namespace std;
+
+namespace
+{
+    typedef std::function<SortableJobOrder*()> OrderFactory;
+
+    //how every SortableJobOrder is named in the benchmark names, and how to build it
+    const vector<pair<string, OrderFactory>> & orders()
+    {
+        static const vector<pair<string, OrderFactory>> orders = {
+            {"fcfs", []() { return new FCFSOrder; }},
+            {"original_fcfs", []() { return new OriginalFCFSOrder; }},
+            {"lcfs", []() { return new LCFSOrder; }},
+            {"desc_bounded_slowdown", []() { return new DescendingBoundedSlowdownOrder(1); }},
+            {"desc_slowdown", []() { return new DescendingSlowdownOrder; }},
+            {"asc_size", []() { return new AscendingSizeOrder; }},
+            {"desc_size", []() { return new DescendingSizeOrder; }},
+            {"asc_walltime", []() { return new AscendingWalltimeOrder; }},
+            {"desc_walltime", []() { return new DescendingWalltimeOrder; }},
+        };
+        return orders;
+    }
+
+    bench::Measure append_job(const bench::Parameters & parameters, const OrderFactory & make_order)
+    {
+        mt19937 generator(parameters.seed);
+        vector<Job *> jobs = bench::make_jobs(parameters.queue_size, parameters.platform_size, generator);
+        unique_ptr<SortableJobOrder> order(make_order());
+        bench::Measure measure;
+        {
+            Queue queue(order.get());
+            SortableJobOrder::UpdateInformation update_info(0);
+            bench::Timer timer;
+            timer.start();
+            for (const Job * job : jobs)
+                queue.append_job(job, &update_info);
+            measure.seconds = timer.stop();
+            measure.nb_operations = jobs.size();
+            bench::sink += queue.nb_jobs();
+        }
+        bench::delete_jobs(jobs);
+        return measure;
+    }
+
+    bench::Measure sort_queue(const bench::Parameters & parameters, const OrderFactory & make_order)
+    {
+        mt19937 generator(parameters.seed);
+        vector<Job *> jobs = bench::make_jobs(parameters.queue_size, parameters.platform_size, generator);
+        //the jobs are generated in submission order, shuffle them so FCFS-like orders have something to sort
+        shuffle(jobs.begin(), jobs.end(), generator);
+        unique_ptr<SortableJobOrder> order(make_order());
+        bench::Measure measure;
+        {
+            Queue queue(order.get());
+            SortableJobOrder::UpdateInformation update_info(0);
+            for (const Job * job : jobs)
+                queue.append_job(job, &update_info);
+
+            //one sort of the whole queue is one operation, as done once per make_decisions
+            SortableJobOrder::UpdateInformation sort_info(parameters.queue_size);
+            bench::Timer timer;
+            timer.start();
+            queue.sort_queue(&sort_info);
+            measure.seconds = timer.stop();
+            measure.nb_operations = 1;
+            bench::sink += queue.nb_jobs();
+        }
+        bench::delete_jobs(jobs);
+        return measure;
+    }
+
+    bench::Measure remove_job(const bench::Parameters & parameters, const OrderFactory & make_order)
+    {
+        mt19937 generator(parameters.seed);
+        vector<Job *> jobs = bench::make_jobs(parameters.queue_size, parameters.platform_size, generator);
+        unique_ptr<SortableJobOrder> order(make_order());
+        bench::Measure measure;
+        {
+            Queue queue(order.get());
+            SortableJobOrder::UpdateInformation update_info(0);
+            for (const Job * job : jobs)
+                queue.append_job(job, &update_info);
+            queue.sort_queue(&update_info);
+            vector<Job *> removal_order = jobs;
+            shuffle(removal_order.begin(), removal_order.end(), generator);
+
+            bench::Timer timer;
+            timer.start();
+            for (const Job * job : removal_order)
+                queue.remove_job(job);
+            measure.seconds = timer.stop();
+            measure.nb_operations = removal_order.size();
+            bench::sink += queue.nb_jobs();
+        }
+        bench::delete_jobs(jobs);
+        return measure;
+    }
+}
+
+void bench::add_queue_benchmarks(vector<Benchmark> & benchmarks)
+{
+    for (const auto & order : orders())
+    {
+        const OrderFactory & make_order = order.second;
+        benchmarks.push_back({"queue/append_job/" + order.first,
+                              [make_order](const Parameters & p) { return append_job(p, make_order); }});
+        benchmarks.push_back({"queue/sort_queue/" + order.first,
+                              [make_order](const Parameters & p) { return sort_queue(p, make_order); }});
+        benchmarks.push_back({"queue/remove_job/" + order.first,
+                              [make_order](const Parameters & p) { return remove_job(p, make_order); }});
+    }
+}
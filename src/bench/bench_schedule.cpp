@@ -0,0 +1,280 @@
+#include <algorithm>
+
+#include "../schedule.hpp"
+#include "../locality.hpp"
+#include "bench.hpp"
+
+using namespace std;
+
+namespace
+{
+    //a schedule with every job of the parameters inserted first fit, starting at date 0
+    void fill_schedule(Schedule & schedule, const vector<Job *> & jobs, ResourceSelector * selector)
+    {
+        for (const Job * job : jobs)
+            schedule.add_job_first_fit(job, selector);
+    }
+
+    bench::Measure add_job_first_fit(const bench::Parameters & parameters)
+    {
+        mt19937 generator(parameters.seed);
+        vector<Job *> jobs = bench::make_jobs(parameters.queue_size, parameters.platform_size, generator);
+        BasicResourceSelector selector;
+        bench::Measure measure;
+        {
+            Schedule schedule(parameters.platform_size, 0);
+            bench::Timer timer;
+            timer.start();
+            fill_schedule(schedule, jobs, &selector);
+            measure.seconds = timer.stop();
+            measure.nb_operations = jobs.size();
+            bench::sink += schedule.nb_slices();
+        }
+        bench::delete_jobs(jobs);
+        return measure;
+    }
+
+    bench::Measure remove_job(const bench::Parameters & parameters)
+    {
+        mt19937 generator(parameters.seed);
+        vector<Job *> jobs = bench::make_jobs(parameters.queue_size, parameters.platform_size, generator);
+        BasicResourceSelector selector;
+        bench::Measure measure;
+        {
+            Schedule schedule(parameters.platform_size, 0);
+            fill_schedule(schedule, jobs, &selector);
+            vector<Job *> removal_order = jobs;
+            shuffle(removal_order.begin(), removal_order.end(), generator);
+
+            bench::Timer timer;
+            timer.start();
+            for (const Job * job : removal_order)
+                schedule.remove_job(job);
+            measure.seconds = timer.stop();
+            measure.nb_operations = removal_order.size();
+            bench::sink += schedule.nb_slices();
+        }
+        bench::delete_jobs(jobs);
+        return measure;
+    }
+
+    bench::Measure split_slice(const bench::Parameters & parameters)
+    {
+        mt19937 generator(parameters.seed);
+        vector<Job *> jobs = bench::make_jobs(parameters.queue_size, parameters.platform_size, generator);
+        BasicResourceSelector selector;
+        bench::Measure measure;
+        {
+            Schedule schedule(parameters.platform_size, 0);
+            fill_schedule(schedule, jobs, &selector);
+            uniform_real_distribution<double> date(0, (double)schedule.finite_horizon());
+            vector<Rational> dates;
+            for (int i = 0; i < parameters.queue_size; ++i)
+                dates.push_back(Rational(date(generator)));
+
+            //the slice lookup is timed too: that is how the algorithms reach split_slice
+            bench::Timer timer;
+            timer.start();
+            for (const Rational & split_date : dates)
+            {
+                Schedule::TimeSliceIterator first, second;
+                auto slice = schedule.find_last_time_slice_before_date(split_date);
+                schedule.split_slice(slice, split_date, first, second);
+            }
+            measure.seconds = timer.stop();
+            measure.nb_operations = dates.size();
+            bench::sink += schedule.nb_slices();
+        }
+        bench::delete_jobs(jobs);
+        return measure;
+    }
+
+    bench::Measure update_first_slice(const bench::Parameters & parameters)
+    {
+        mt19937 generator(parameters.seed);
+        vector<Job *> jobs = bench::make_jobs(parameters.queue_size, parameters.platform_size, generator);
+        BasicResourceSelector selector;
+        bench::Measure measure;
+        {
+            Schedule schedule(parameters.platform_size, 0);
+            fill_schedule(schedule, jobs, &selector);
+            //moves the beginning of the first slice forward in small steps, without ever leaving it
+            Rational begin = schedule.begin()->begin;
+            Rational step = (schedule.begin()->end - begin) / (parameters.queue_size + 1);
+
+            bench::Timer timer;
+            timer.start();
+            for (int i = 1; i <= parameters.queue_size; ++i)
+                schedule.update_first_slice(begin + step * i);
+            measure.seconds = timer.stop();
+            measure.nb_operations = parameters.queue_size;
+            bench::sink += schedule.nb_slices();
+        }
+        bench::delete_jobs(jobs);
+        return measure;
+    }
+
+    //the start of every job of a filled schedule, as the metrics variants need them on each metrics row.
+    //one lookup of all the jobs is one operation
+    bench::Measure predicted_starts(const bench::Parameters & parameters, bool single_pass)
+    {
+        mt19937 generator(parameters.seed);
+        vector<Job *> jobs = bench::make_jobs(parameters.queue_size, parameters.platform_size, generator);
+        BasicResourceSelector selector;
+        bench::Measure measure;
+        {
+            Schedule schedule(parameters.platform_size, 0);
+            fill_schedule(schedule, jobs, &selector);
+            std::unordered_map<const Job *, Schedule::PredictedRun> runs;
+
+            bench::Timer timer;
+            timer.start();
+            if (single_pass)
+            {
+                schedule.compute_predicted_runs(runs);
+                for (const Job * job : jobs)
+                    bench::sink += (long)runs.at(job).start;
+            }
+            else
+            {
+                for (const Job * job : jobs)
+                    bench::sink += (long)schedule.find_first_occurence_of_job(job, schedule.begin())->begin;
+            }
+            measure.seconds = timer.stop();
+            measure.nb_operations = 1;
+        }
+        bench::delete_jobs(jobs);
+        return measure;
+    }
+
+    //a what-if placement as the energy variants do them: insert a job into the full schedule, look at it, undo it.
+    //one probe is one operation, undone either by working on a copy or by rolling back a transaction
+    bench::Measure what_if(const bench::Parameters & parameters, bool use_transaction)
+    {
+        const int nb_probes = 16;
+        mt19937 generator(parameters.seed);
+        //the probes are drawn with the jobs so that their ids differ
+        vector<Job *> jobs = bench::make_jobs(parameters.queue_size + nb_probes, parameters.platform_size, generator);
+        vector<Job *> probes(jobs.end() - nb_probes, jobs.end());
+        jobs.resize(parameters.queue_size);
+        BasicResourceSelector selector;
+        bench::Measure measure;
+        {
+            Schedule schedule(parameters.platform_size, 0);
+            fill_schedule(schedule, jobs, &selector);
+
+            bench::Timer timer;
+            timer.start();
+            for (const Job * probe : probes)
+            {
+                if (use_transaction)
+                {
+                    schedule.begin_transaction();
+                    bench::sink += (long)schedule.add_job_first_fit(probe, &selector).begin;
+                    schedule.rollback();
+                }
+                else
+                {
+                    Schedule copy = schedule;
+                    bench::sink += (long)copy.add_job_first_fit(probe, &selector).begin;
+                    //the copy shares the job, its allocation must not outlive the copy
+                    for (auto & alloc : probe->allocations)
+                        delete alloc.second;
+                    probe->allocations.clear();
+                }
+            }
+            measure.seconds = timer.stop();
+            measure.nb_operations = nb_probes;
+            bench::sink += schedule.nb_slices();
+        }
+        bench::delete_jobs(probes);
+        bench::delete_jobs(jobs);
+        return measure;
+    }
+
+    //the probe of a reservation as the reservation variants do it, before add_reservation: the slices are split at
+    //its start and end and the jobs in its way are collected.  Either on its own, the split slices staying as a
+    //placed reservation leaves them, or in a transaction rolled back afterwards as a what-if would
+    bench::Measure reserve_time_slice(const bench::Parameters & parameters, bool in_transaction)
+    {
+        const int nb_probes = 16;
+        mt19937 generator(parameters.seed);
+        vector<Job *> jobs = bench::make_jobs(parameters.queue_size + nb_probes, parameters.platform_size, generator);
+        vector<Job *> probes(jobs.end() - nb_probes, jobs.end());
+        jobs.resize(parameters.queue_size);
+        BasicResourceSelector selector;
+        bench::Measure measure;
+        {
+            Schedule schedule(parameters.platform_size, 0);
+            fill_schedule(schedule, jobs, &selector);
+            uniform_real_distribution<double> date(1, (double)schedule.finite_horizon());
+            for (Job * probe : probes)
+            {
+                probe->purpose = "reservation";
+                probe->start = date(generator);
+            }
+
+            bench::Timer timer;
+            timer.start();
+            for (const Job * probe : probes)
+            {
+                if (in_transaction)
+                    schedule.begin_transaction();
+                Schedule::ReservedTimeSlice reservation = schedule.reserve_time_slice(probe);
+                bench::sink += reservation.success;
+                if (in_transaction)
+                    schedule.rollback();
+                //the allocation is only referenced by the reservation until add_reservation
+                if (reservation.success)
+                    delete reservation.alloc;
+            }
+            measure.seconds = timer.stop();
+            measure.nb_operations = nb_probes;
+            bench::sink += schedule.nb_slices();
+        }
+        bench::delete_jobs(probes);
+        bench::delete_jobs(jobs);
+        return measure;
+    }
+
+    //the liquid load horizon as easy_bf_plot_liquid_load_horizon computes it on every decision: the queue load
+    //fluidified into the free area of the schedule.  The first query builds the free area prefix
+    bench::Measure liquid_load_date(const bench::Parameters & parameters)
+    {
+        mt19937 generator(parameters.seed);
+        vector<Job *> jobs = bench::make_jobs(parameters.queue_size, parameters.platform_size, generator);
+        BasicResourceSelector selector;
+        bench::Measure measure;
+        {
+            Schedule schedule(parameters.platform_size, 0);
+            fill_schedule(schedule, jobs, &selector);
+            double horizon = (double)schedule.finite_horizon();
+            uniform_real_distribution<double> date(0, horizon);
+            uniform_real_distribution<double> area(0, horizon * parameters.platform_size);
+
+            bench::Timer timer;
+            timer.start();
+            for (int i = 0; i < parameters.queue_size; ++i)
+                bench::sink += (long)schedule.liquid_load_date(area(generator), date(generator));
+            measure.seconds = timer.stop();
+            measure.nb_operations = parameters.queue_size;
+        }
+        bench::delete_jobs(jobs);
+        return measure;
+    }
+}
+
+void bench::add_schedule_benchmarks(vector<Benchmark> & benchmarks)
+{
+    benchmarks.push_back({"schedule/add_job_first_fit", add_job_first_fit});
+    benchmarks.push_back({"schedule/remove_job", remove_job});
+    benchmarks.push_back({"schedule/split_slice", split_slice});
+    benchmarks.push_back({"schedule/update_first_slice", update_first_slice});
+    benchmarks.push_back({"schedule/predicted_starts_per_job", [](const Parameters & p) { return predicted_starts(p, false); }});
+    benchmarks.push_back({"schedule/predicted_starts_single_pass", [](const Parameters & p) { return predicted_starts(p, true); }});
+    benchmarks.push_back({"schedule/what_if_copy", [](const Parameters & p) { return what_if(p, false); }});
+    benchmarks.push_back({"schedule/transaction_rollback", [](const Parameters & p) { return what_if(p, true); }});
+    benchmarks.push_back({"schedule/reserve_time_slice", [](const Parameters & p) { return reserve_time_slice(p, false); }});
+    benchmarks.push_back({"schedule/reserve_time_slice_in_transaction", [](const Parameters & p) { return reserve_time_slice(p, true); }});
+    benchmarks.push_back({"schedule/liquid_load_date", liquid_load_date});
+}
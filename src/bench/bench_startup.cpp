@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <fstream>
+
+#include <rapidjson/document.h>
+
+#include "../machine.hpp"
+#include "../batsched_tools.hpp"
+#include "bench.hpp"
+
+using namespace std;
+
+namespace
+{
+    //a failures file as Batsim writes it: a type line, then one line per failure
+    string write_failure_file(int nb_failures, int platform_size, mt19937 & generator)
+    {
+        string path = "/tmp/batsched-bench-failures-" + std::to_string(batsched_tools::get_batsched_pid()) + ".txt";
+        ofstream f(path);
+        PPK_ASSERT_ERROR(f.is_open(), "Couldn't open temporary failures file '%s'", path.c_str());
+        uniform_int_distribution<int> machine(0, platform_size - 1);
+        f << "0.0 ||FAILURE SMTBF\n";
+        for (int i = 0; i < nb_failures; ++i)
+            f << batsched_tools::string_format("%d.%06d ||MACHINE_INSTANT_DOWN_UP: %d\n", i, i % 1000000, machine(generator));
+        return path;
+    }
+
+    bench::Measure parse_failure_file(const bench::Parameters & parameters)
+    {
+        mt19937 generator(parameters.seed);
+        string path = write_failure_file(parameters.queue_size, parameters.platform_size, generator);
+        bench::Timer timer;
+        timer.start();
+        auto failures = batsched_tools::parse_failure_file(path);
+        bench::Measure measure;
+        measure.seconds = timer.stop();
+        measure.nb_operations = parameters.queue_size + 1;
+        bench::sink += failures.size();
+        remove(path.c_str());
+        return measure;
+    }
+
+    //the compute_resources of SIMULATION_BEGINS, with names made of several letter and number groups
+    bench::Measure load_platform(const bench::Parameters & parameters)
+    {
+        rapidjson::Document doc;
+        doc.SetArray();
+        auto & allocator = doc.GetAllocator();
+        for (int i = 0; i < parameters.platform_size; ++i)
+        {
+            rapidjson::Value machine(rapidjson::kObjectType);
+            string name = batsched_tools::string_format("cluster2_rack%d_node%05d", i / 64, i);
+            machine.AddMember("name", rapidjson::Value(name.c_str(), allocator), allocator);
+            machine.AddMember("id", rapidjson::Value(i), allocator);
+            machine.AddMember("core_count", rapidjson::Value(1), allocator);
+            machine.AddMember("speed", rapidjson::Value(1.0), allocator);
+            machine.AddMember("repair_time", rapidjson::Value(0.0), allocator);
+            doc.PushBack(machine, allocator);
+        }
+        Machines machines;
+        bench::Timer timer;
+        timer.start();
+        for (rapidjson::SizeType i = 0; i < doc.Size(); ++i)
+            machines.add_machine_from_json_object(doc[i]);
+        bench::Measure measure;
+        measure.seconds = timer.stop();
+        measure.nb_operations = parameters.platform_size;
+        bench::sink += machines[parameters.platform_size - 1]->int_name;
+        return measure;
+    }
+}
+
+void bench::add_startup_benchmarks(vector<Benchmark> & benchmarks)
+{
+    benchmarks.push_back({"startup/parse_failure_file", parse_failure_file});
+    benchmarks.push_back({"startup/load_platform", load_platform});
+}
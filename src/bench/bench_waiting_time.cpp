@@ -0,0 +1,41 @@
+#include "../queueing_theory_waiting_time_estimator.hpp"
+#include "bench.hpp"
+
+using namespace std;
+
+namespace
+{
+    //one submission, one completion, one slide of the window and both estimates per job, as a variant does
+    //on each decision.  The window holds a quarter of the jobs
+    bench::Measure sliding_window(const bench::Parameters & parameters)
+    {
+        mt19937 generator(parameters.seed);
+        vector<Job *> jobs = bench::make_jobs(parameters.queue_size, parameters.platform_size, generator);
+        for (Job * job : jobs)
+            job->completion_time = job->submission_time;
+        Rational window = std::max(1, parameters.queue_size / 4);
+
+        QueueingTheoryWaitingTimeEstimator estimator;
+        bench::Timer timer;
+        timer.start();
+        for (const Job * job : jobs)
+        {
+            estimator.add_submitted_job(job);
+            estimator.add_completed_job(job);
+            estimator.remove_old(Rational(job->submission_time) - window);
+            bench::sink += (long)estimator.estimate_waiting_time(window);
+            bench::sink += (long)estimator.estimate_waiting_time_by_area(window, parameters.platform_size);
+        }
+        bench::Measure measure;
+        measure.seconds = timer.stop();
+        measure.nb_operations = jobs.size();
+
+        bench::delete_jobs(jobs);
+        return measure;
+    }
+}
+
+void bench::add_waiting_time_benchmarks(vector<Benchmark> & benchmarks)
+{
+    benchmarks.push_back({"waiting_time/sliding_window", sliding_window});
+}
@@ -6,6 +6,7 @@
 #include "data_storage.hpp"
 #include "batsched_tools.hpp"
 #include "json_workload.hpp"
+#include "metrics.hpp"
 #include <rapidjson/document.h>
 #include <rapidjson/writer.h>
 #include <rapidjson/pointer.h>
@@ -28,14 +29,34 @@ SchedulingDecision::~SchedulingDecision()
 
 void SchedulingDecision::add_execute_job(const std::string & job_id, const IntervalSet &machine_ids, double date, vector<int> executor_to_allocated_resource_mapping)
 {
+    _running_jobs.add(job_id, machine_ids);
+    if (_metrics != nullptr)
+        _metrics->on_job_started(job_id, date);
     if (executor_to_allocated_resource_mapping.size() == 0)
         _proto_writer->append_execute_job(job_id, machine_ids, date);
     else
         _proto_writer->append_execute_job(job_id, machine_ids, date, executor_to_allocated_resource_mapping);
 }
 
+const batsched_tools::MachineJobIndex & SchedulingDecision::running_jobs() const
+{
+    return _running_jobs;
+}
+
+void SchedulingDecision::remove_running_job(const std::string & job_id)
+{
+    _running_jobs.remove(job_id);
+}
+
+void SchedulingDecision::set_metrics_observer(MetricsObserver * metrics)
+{
+    _metrics = metrics;
+}
+
 void SchedulingDecision::add_reject_job(double date,const std::string & job_id, batsched_tools::REJECT_TYPES forWhat)
 {
+    if (_metrics != nullptr)
+        _metrics->on_job_rejected(job_id, date);
     _proto_writer->append_reject_job(date,job_id,forWhat);
 }
 
@@ -563,8 +584,16 @@ void SchedulingDecision::add_call_me_later(double date,double future_date, batsc
     if (_blocked_cmls.find(cml.forWhat) != _blocked_cmls.end())
         return;
     cml.time = future_date;
-    _proto_writer->append_call_me_later(date,future_date,cml);
     CLOG_F(CCU_DEBUG,"adding call me later, type: %d  id: %d",int( cml.forWhat),cml.id);
+    //if a call me later was already requested for that date and did not fire yet, Batsim's call back will stand for this one too
+    auto group = _call_me_later_groups.find(future_date);
+    if (group != _call_me_later_groups.end())
+        group->second.push_back(cml.id);
+    else
+    {
+        _proto_writer->append_call_me_later(date,future_date,cml);
+        _call_me_later_groups[future_date] = {cml.id};
+    }
     _call_me_laters[cml.id]=cml;
     _nb_call_me_laters++;
 }
@@ -577,16 +606,41 @@ double SchedulingDecision::remove_call_me_later(batsched_tools::CALL_ME_LATERS c
     {
         if (call_me_later.forWhat == batsched_tools::call_me_later_types::RESERVATION_START)
         {
-            rapidjson::Document doc;
-            doc.Parse(call_me_later.extra_data.c_str());
-            PPK_ASSERT(doc.HasMember("job_id"),"Error, there is no job_id in RESERVATION_START call_me_later");
-            ((*w0)[doc["job_id"].GetString()])->walltime -=( date - call_me_later.time);
+            if (call_me_later.job_id.empty())
+                batsched_tools::read_extra_data(call_me_later);
+            ((*w0)[call_me_later.job_id])->walltime -=( date - call_me_later.time);
         }
         return date - call_me_later.time;
     }
     else
         return 0;
 }
+std::vector<batsched_tools::CALL_ME_LATERS> SchedulingDecision::fired_call_me_laters(const batsched_tools::CALL_ME_LATERS & cml_in)
+{
+    std::vector<batsched_tools::CALL_ME_LATERS> fired;
+    auto cml_it = _call_me_laters.find(cml_in.id);
+    if (cml_it == _call_me_laters.end())
+    {
+        //not one of ours (restored without being dispatched), all we have is what Batsim sent back
+        fired.push_back(cml_in);
+        batsched_tools::read_extra_data(fired.back());
+        return fired;
+    }
+    auto group = _call_me_later_groups.find(cml_it->second.time);
+    if (group == _call_me_later_groups.end() || group->second.front() != cml_in.id)
+    {
+        fired.push_back(cml_it->second);
+        return fired;
+    }
+    for (int id : group->second)
+    {
+        auto it = _call_me_laters.find(id);
+        if (it != _call_me_laters.end())
+            fired.push_back(it->second);
+    }
+    _call_me_later_groups.erase(group);
+    return fired;
+}
 std::map<int,batsched_tools::CALL_ME_LATERS> SchedulingDecision::get_call_me_laters()
 {
     return _call_me_laters;
@@ -654,6 +708,11 @@ double SchedulingDecision::last_date() const
     return _proto_writer->last_date();
 }
 
+const rapidjson::Value & SchedulingDecision::events() const
+{
+    return _proto_writer->current_events();
+}
+
 void SchedulingDecision::set_redis(bool enabled, RedisStorage *redis)
 {
     _redis_enabled = enabled;
@@ -10,6 +10,7 @@
 
 class AbstractProtocolWriter;
 class RedisStorage;
+class MetricsObserver;
 
 class SchedulingDecision
 {
@@ -23,6 +24,15 @@ public:
     void push_back_job_still_needed_to_be_killed(batsched_tools::Job_Message * jm);
     void add_reject_job(double date, const std::string &job_id, batsched_tools::REJECT_TYPES forWhat );
     void add_kill_job(const std::vector<batsched_tools::Job_Message *> & job_msgs, double date);
+    /**
+     * @brief The jobs executed through add_execute_job that were not removed yet, by machine
+     */
+    const batsched_tools::MachineJobIndex & running_jobs() const;
+    void remove_running_job(const std::string & job_id);
+    /**
+     * @brief The observer told about the jobs executed and rejected, nullptr for none
+     */
+    void set_metrics_observer(MetricsObserver * metrics);
 
     /**
      * @brief add_submit_jobs
@@ -62,6 +72,13 @@ public:
                                           double estimated_waiting_time,
                                           double date);
     double remove_call_me_later(batsched_tools::CALL_ME_LATERS cml_in, double date,Workload * w0);
+    /**
+     * @brief Returns the call me laters a REQUESTED_CALL stands for
+     * @details Call me laters due at the same date share one CALL_ME_LATER: the one Batsim calls back for
+     *          is returned with all the others of its date, by increasing id.  The returned call me laters
+     *          are the stored ones, with their typed fields set.
+     */
+    std::vector<batsched_tools::CALL_ME_LATERS> fired_call_me_laters(const batsched_tools::CALL_ME_LATERS & cml_in);
     std::map<int,batsched_tools::CALL_ME_LATERS> get_call_me_laters();
     int get_nb_call_me_laters();
     void set_call_me_laters(std::map<int,batsched_tools::CALL_ME_LATERS> & cml,double date,bool dispatch=false);
@@ -69,12 +86,18 @@ public:
     void clear_blocked_call_me_laters();
     void add_blocked_call_me_later(batsched_tools::call_me_later_types type);
     void remove_blocked_call_me_later(batsched_tools::call_me_later_types type);
+    bool is_call_me_later_blocked(batsched_tools::call_me_later_types type) const
+    {
+        return _blocked_cmls.find(type) != _blocked_cmls.end();
+    }
             
 
     void clear();
 
     std::string content(double date);
     double last_date() const;
+    /** @brief The events decided since the last clear, as the "events" array of the answer.  Consumed by content */
+    const rapidjson::Value & events() const;
     void set_nb_call_me_laters(int nb);
     void set_redis(bool enabled, RedisStorage * redis);
     std::string to_json_desc(rapidjson::Document * doc);
@@ -96,7 +119,10 @@ private:
     RedisStorage * _redis = nullptr;
     int _nb_call_me_laters=0;
     std::map<int,batsched_tools::CALL_ME_LATERS> _call_me_laters;
+    std::map<double,std::vector<int>> _call_me_later_groups; //date -> ids of the call me laters due then, only the first was sent
     std::set<batsched_tools::call_me_later_types> _blocked_cmls;
     std::vector<batsched_tools::Job_Message *> _jobs_still_needed_to_be_killed;
+    batsched_tools::MachineJobIndex _running_jobs;
+    MetricsObserver * _metrics = nullptr;
     
 };
@@ -1,7 +1,9 @@
 #include "isalgorithm.hpp"
 #include <algorithm>
+#include <limits>
 #include "pempek_assert.hpp"
 #include "batsched_tools.hpp"
+#include "locality.hpp"
 #include <chrono>
 #include <ctime>
 #include <loguru.hpp>
@@ -45,6 +47,8 @@ void ISchedulingAlgorithm::normal_start(double date, const rapidjson::Value & ba
     _myBLOG->add_log_file(_output_folder+"/log/Soft_Errors.log",blog_types::SOFT_ERRORS,blog_open_method::OVERWRITE);
     _myBLOG->add_log_file(_output_folder+"/failures.csv",blog_types::FAILURES,blog_open_method::OVERWRITE,true);
     _myBLOG->add_header(blog_types::FAILURES,"simulated_time,event,data");
+    if (_metrics != nullptr)
+        _metrics->open(_myBLOG,_output_folder,false);
     (void) batsim_config;
 }
 void ISchedulingAlgorithm::schedule_start(double date, const rapidjson::Value & batsim_event)
@@ -117,6 +121,8 @@ void ISchedulingAlgorithm::on_start_from_checkpoint_normal(double date, const ra
     LOG_F(INFO,"here");
     _myBLOG->add_log_file(_output_folder+"/failures.csv",blog_types::FAILURES,blog_open_method::APPEND,true);
     LOG_F(INFO,"here");
+    if (_metrics != nullptr)
+        _metrics->open(_myBLOG,_output_folder,true);
     _recover_from_checkpoint = true;
 }
 void ISchedulingAlgorithm::on_start_from_checkpoint_schedule(double date, const rapidjson::Value & batsim_event)
@@ -174,21 +180,37 @@ void ISchedulingAlgorithm::requested_failure_call(double date, batsched_tools::C
     switch(cml_in.forWhat){
     
         case batsched_tools::call_me_later_types::SMTBF:
-            CLOG_F(CCU_DEBUG,"DEBUG");
-            //Log the failure
-            BLOG_F(blog_types::FAILURES,"%s,%s",blog_failure_event::FAILURE.c_str(),"SMTBF");
-            CLOG_F(CCU_DEBUG,"DEBUG");
-            CLOG_F(CCU_DEBUG,"SMTBF Failure");
-            CLOG_F(CCU_DEBUG,"DEBUG");
-            killType=batsched_tools::KILL_TYPES::SMTBF;
-            CLOG_F(CCU_DEBUG,"DEBUG");
-        break;
         case batsched_tools::call_me_later_types::MTBF:
-        LOG_F(INFO,"DEBUG");
-            BLOG_F(blog_types::FAILURES, "%s,%s",blog_failure_event::FAILURE.c_str(),"MTBF");
-            CLOG_F(CCU_DEBUG,"MTBF Failure");
-            killType=batsched_tools::KILL_TYPES::MTBF;
-        break;
+        {
+            //the wakeup stands for every failure of the timeline that is due, not only its own
+            double due_date = std::max(date,cml_in.time);
+            _failure_wakeups.erase(_failure_wakeups.begin(),_failure_wakeups.upper_bound(due_date));
+            killType = (cml_in.forWhat == batsched_tools::call_me_later_types::SMTBF) ?
+                            batsched_tools::KILL_TYPES::SMTBF : batsched_tools::KILL_TYPES::MTBF;
+            std::string failure_type = (killType == batsched_tools::KILL_TYPES::SMTBF) ? "SMTBF" : "MTBF";
+            size_t nb_due = 0;
+            while (nb_due < _failure_timeline_dates.size() && _failure_timeline_dates[nb_due] <= due_date)
+            {
+                int machine = _failure_timeline_machines[nb_due];
+                if (failure_affects_schedule(machine))
+                {
+                    BLOG_F(blog_types::FAILURES,"%s,%s",blog_failure_event::FAILURE.c_str(),failure_type.c_str());
+                    CLOG_F(CCU_DEBUG,"%s Failure",failure_type.c_str());
+                    if (_workload->_repair_time == -1.0  && _workload->_MTTR == -1.0)
+                        _on_machine_instant_down_ups.push_back(killType);
+                    else
+                        _on_machine_down_for_repairs.push_back(killType);
+                    _failing_machines.push_back(machine);
+                }
+                else
+                    skip_failure(_failure_timeline_dates[nb_due],machine);
+                nb_due++;
+            }
+            _failure_timeline_dates.erase(_failure_timeline_dates.begin(),_failure_timeline_dates.begin()+nb_due);
+            _failure_timeline_machines.erase(_failure_timeline_machines.begin(),_failure_timeline_machines.begin()+nb_due);
+            //the next failure is requested by schedule_next_failure, once the decisions are made
+            return;
+        }
         case batsched_tools::call_me_later_types::FIXED_FAILURE:
         LOG_F(INFO,"DEBUG");
             BLOG_F(blog_types::FAILURES,"%s,%s",blog_failure_event::FAILURE.c_str(),"FIXED_FAILURE");
@@ -197,12 +219,8 @@ void ISchedulingAlgorithm::requested_failure_call(double date, batsched_tools::C
         break;
         case batsched_tools::call_me_later_types::REPAIR_DONE:
         {
-            rapidjson::Document doc;
-            LOG_F(INFO,"DEBUG");
-            doc.Parse(cml_in.extra_data.c_str());
-            LOG_F(INFO,"DEBUG");
-            PPK_ASSERT(doc.HasMember("machine"),"Error, repair done but no 'machine' field in extra_data");
-            int machine_number = doc["machine"].GetInt();
+            int machine_number = cml_in.machine;
+            PPK_ASSERT(machine_number != -1,"Error, repair done but no machine in call me later %d",cml_in.id);
             BLOG_F(blog_types::FAILURES,"%s,%d",blog_failure_event::REPAIR_DONE.c_str() ,machine_number);
             CLOG_F(CCU_DEBUG,"Repair Done On Machine: %d",machine_number);
             //a repair is done, all that needs to happen is add the machines to available
@@ -231,6 +249,11 @@ void ISchedulingAlgorithm::requested_failure_call(double date, batsched_tools::C
             return;
         }
         break;
+        case batsched_tools::call_me_later_types::WAKE_UP:
+        case batsched_tools::call_me_later_types::MONITORING_STAGE:
+        case batsched_tools::call_me_later_types::DECISION_QUANTUM:
+            //not a failure
+            return;
     }
     LOG_F(INFO,"DEBUG");
 
@@ -243,16 +266,91 @@ void ISchedulingAlgorithm::requested_failure_call(double date, batsched_tools::C
         {
             _on_machine_down_for_repairs.push_back(killType);
         }
-   
-    CLOG_F(CCU_DEBUG,"DEBUG");
+    //only fixed failures get here, their machine is drawn when they are handled
+    _failing_machines.push_back(-1);
     batsched_tools::CALL_ME_LATERS cml;
     cml.forWhat = cml_in.forWhat;
     cml.id = _decision->get_nb_call_me_laters();
-    CLOG_F(CCU_DEBUG,"DEBUG");
-    double number = failure_exponential_distribution->operator()(generator_failure);
-    _decision->add_call_me_later(date,number+date,cml);
-    CLOG_F(CCU_DEBUG,"DEBUG");
-    
+    _decision->add_call_me_later(date,date+_workload->_fixed_failures,cml);
+}
+
+void ISchedulingAlgorithm::schedule_next_failure(double date)
+{
+    if (failure_exponential_distribution == nullptr)
+        return;
+    batsched_tools::call_me_later_types forWhat = (_workload->_SMTBF != -1.0) ?
+                    batsched_tools::call_me_later_types::SMTBF : batsched_tools::call_me_later_types::MTBF;
+    if (_decision->is_call_me_later_blocked(forWhat))
+        return;
+    _failure_wakeups.erase(_failure_wakeups.begin(),_failure_wakeups.lower_bound(date));
+    //nothing left to fail: the timeline stops like the call me later chain used to
+    if (_no_more_static_job_to_submit_received && _decision->running_jobs().empty())
+        return;
+    //failures passed without a wakeup hit machines without jobs: the machines came back up with nothing to kill
+    size_t nb_passed = 0;
+    while (nb_passed < _failure_timeline_dates.size() && _failure_timeline_dates[nb_passed] < date)
+    {
+        skip_failure(_failure_timeline_dates[nb_passed],_failure_timeline_machines[nb_passed]);
+        nb_passed++;
+    }
+    _failure_timeline_dates.erase(_failure_timeline_dates.begin(),_failure_timeline_dates.begin()+nb_passed);
+    _failure_timeline_machines.erase(_failure_timeline_machines.begin(),_failure_timeline_machines.begin()+nb_passed);
+    if (_workload->_repair_time == -1.0 && _workload->_MTTR == -1.0 && _decision->running_jobs().empty())
+        return;
+
+    //walk at most a window of failures, the last one of the window is a wakeup to walk further
+    for (int i = 0; i < _failure_timeline_window; i++)
+    {
+        if (i == (int)_failure_timeline_dates.size())
+            draw_failure();
+        if (i == _failure_timeline_window - 1 || failure_affects_schedule(_failure_timeline_machines[i]))
+        {
+            double failure_date = _failure_timeline_dates[i];
+            //an earlier wakeup is pending, the timeline is walked again from there
+            if (!_failure_wakeups.empty() && *_failure_wakeups.begin() <= failure_date)
+                return;
+            batsched_tools::CALL_ME_LATERS cml;
+            cml.forWhat = forWhat;
+            cml.id = _decision->get_nb_call_me_laters();
+            _decision->add_call_me_later(date,failure_date,cml);
+            _failure_wakeups.insert(failure_date);
+            return;
+        }
+    }
+}
+void ISchedulingAlgorithm::draw_failure()
+{
+    //same draws, in the same order, as when each failure drew the next one: the machine generator is
+    //only drawn by the timeline (and by fixed failures), the failure generator only here
+    _failure_timeline_end += failure_exponential_distribution->operator()(generator_failure);
+    _failure_timeline_dates.push_back(_failure_timeline_end);
+    _failure_timeline_machines.push_back(machine_unif_distribution->operator()(generator_machine));
+}
+bool ISchedulingAlgorithm::failure_affects_schedule(int machine)
+{
+    //a machine going down for repair always changes what is available
+    if (_workload->_repair_time != -1.0 || _workload->_MTTR != -1.0)
+        return true;
+    return _decision->running_jobs().has_jobs_on(machine);
+}
+void ISchedulingAlgorithm::skip_failure(double failure_date,int machine)
+{
+    //logged at the date of the failure, as if it was delivered
+    double date = failure_date;
+    BLOG_F(blog_types::FAILURES,"%s,%s",blog_failure_event::FAILURE.c_str(),(_workload->_SMTBF != -1.0) ? "SMTBF" : "MTBF");
+    BLOG_F(blog_types::FAILURES,"%s,%d",blog_failure_event::MACHINE_INSTANT_DOWN_UP.c_str(),machine);
+}
+int ISchedulingAlgorithm::next_failing_machine()
+{
+    int number = -1;
+    if (!_failing_machines.empty())
+    {
+        number = _failing_machines.front();
+        _failing_machines.erase(_failing_machines.begin());
+    }
+    if (number == -1)
+        number = machine_unif_distribution->operator()(generator_machine);
+    return number;
 }
 
 void ISchedulingAlgorithm::handle_failures(double date){
@@ -276,20 +374,11 @@ void ISchedulingAlgorithm::handle_failures(double date){
 IntervalSet ISchedulingAlgorithm::normal_repair(double date)
 {
     //notes on multiple clusters/partitions
-    /*
-        this function will need to accept a prefix string to know which cluster/partition to roll the dice on
-        we will need multiple machine_unif_distributions and multiple generator_machines
-        we will need multiple failure_exp_distributions and failure generators
-        we will need to update a prefix->repair_machines and not the ISchedulingAlgorithm::_repair_machines
-        as well as the prefix->machineIdsAvailable / prefix->machineIdsUnavailable 
-    */
-     //get a random number of a machine to kill
-     //this will need to be more complex if we aim to have multiple partitions of clusters ...ie multiple Prefixes
-    
-    std::string prefix = "a";
-    int number = machine_unif_distribution->operator()(generator_machine);
+    //the machine is drawn among the machines of every partition (prefix), the machine knows its partition
+    int number = next_failing_machine();
+    Machine * failing_machine = (*_machines)[number];
     //make it an intervalset so we can find the intersection of it with current allocations
-    int id = (*_machines)(prefix,number)->id;
+    int id = failing_machine->id;
     IntervalSet machine = id;
     BLOG_F(blog_types::FAILURES,"%s,%d",blog_failure_event::MACHINE_REPAIR.c_str(),id);
     
@@ -297,10 +386,9 @@ IntervalSet ISchedulingAlgorithm::normal_repair(double date)
     
     if ((machine & _repair_machines).is_empty())  
     {
-        double repair_time = _workload->_repair_time;
-        //if we were doing multiple clusters/partitions
-        //double repair_time = (*_machines)[number]->repair_time;
-       
+        //partitions can have their own repair time in the platform, otherwise it is the workload's
+        double repair_time = (failing_machine->repair_time > 0) ? failing_machine->repair_time : _workload->_repair_time;
+
         if (_workload->_MTTR != -1.0)
             repair_time = repair_time_exponential_distribution->operator()(generator_repair_time);
         //first check if we are using the schedule 
@@ -331,6 +419,7 @@ IntervalSet ISchedulingAlgorithm::normal_repair(double date)
         cml.forWhat = batsched_tools::call_me_later_types::REPAIR_DONE;
         cml.id = _decision->get_nb_call_me_laters();
         cml.extra_data = extra_data;
+        cml.machine = number;
         _decision->add_call_me_later(date,date+repair_time,cml);
         return machine;
     }
@@ -445,7 +534,7 @@ void ISchedulingAlgorithm::schedule_repair(IntervalSet machine,batsched_tools::K
 IntervalSet ISchedulingAlgorithm::normal_downUp(double date)
 {
     //get a random number of a machine to kill
-    int number = machine_unif_distribution->operator()(generator_machine);
+    int number = next_failing_machine();
     //make it an intervalset so we can find the intersection of it with current allocations
     IntervalSet machine = number;
     BLOG_F(blog_types::FAILURES,"%s,%d",blog_failure_event::MACHINE_INSTANT_DOWN_UP.c_str(), number);
@@ -468,7 +557,11 @@ bool ISchedulingAlgorithm::schedule_kill_jobs(IntervalSet machine,batsched_tools
 {
     //there are possibly some running jobs to kill
     std::vector<std::string> jobs_to_kill;
-    _schedule.get_jobs_running_on_machines(machine,jobs_to_kill);
+    for (const std::string & job_id : _decision->running_jobs().jobs_on(machine))
+    {
+        if ((*_workload)[job_id]->purpose != "reservation")
+            jobs_to_kill.push_back(job_id);
+    }
 
     std::string jobs_to_kill_str = "";
     if (loguru::g_stderr_verbosity == CCU_DEBUG)
@@ -500,12 +593,81 @@ bool ISchedulingAlgorithm::schedule_kill_jobs(IntervalSet machine,batsched_tools
 
         _decision->add_kill_job(msgs,date);
         for (auto job_id:jobs_to_kill)
+        {
             _schedule.remove_job_if_exists((*_workload)[job_id]);
+            _decision->remove_running_job(job_id);
+        }
         BLOG_F(blog_types::FAILURES,"%s,\"%s\"",blog_failure_event::KILLING_JOBS.c_str(),killed_jobs.c_str());
     return true; //we have jobs to kill
     }
     return false; //we don't have jobs to kill
 }
+bool ISchedulingAlgorithm::schedule_notifications_due(double date) const
+{
+    if (_schedule_notifications.empty())
+        return false;
+    return _last_schedule_notifications_date < 0 || date >= _last_schedule_notifications_date + _schedule_notifications_period;
+}
+void ISchedulingAlgorithm::send_schedule_notifications(double date)
+{
+    if (!schedule_notifications_due(date))
+        return;
+    _last_schedule_notifications_date = date;
+
+    //every statistic is a counter of the queue or of the schedule's first slice, none of them walks the schedule
+    if (_schedule_notifications.count("queue_size"))
+        _decision->add_generic_notification("queue_size",std::to_string(_queue->nb_jobs()),date);
+    if (_schedule_notifications.count("schedule_size"))
+        _decision->add_generic_notification("schedule_size",std::to_string(_schedule.size()),date);
+    if (_schedule_notifications.count("number_running_jobs"))
+        _decision->add_generic_notification("number_running_jobs",std::to_string(_schedule.get_number_of_running_jobs()),date);
+    if (_schedule_notifications.count("utilization"))
+        _decision->add_generic_notification("utilization",std::to_string(_schedule.get_utilization()),date);
+    if (_schedule_notifications.count("utilization_no_resv"))
+        _decision->add_generic_notification("utilization_no_resv",std::to_string(_schedule.get_utilization_no_resv()),date);
+    if (_schedule_notifications.count("fragmentation"))
+        _decision->add_generic_notification("fragmentation",
+                std::to_string(FreeBlockIndex::fragmentation(_schedule.begin()->available_machines)),date);
+}
+void ISchedulingAlgorithm::write_metrics(double date)
+{
+    if (_metrics == nullptr)
+        return;
+    //the jobs seen while recovering from a checkpoint were already written by the previous run
+    if (_recover_from_checkpoint)
+    {
+        _metrics->discard();
+        return;
+    }
+    _metrics->flush(date);
+    double next_sample = _metrics->next_sample_date();
+    //like the failures, the wakeups stop once there is nothing left to sample, or the simulation would never end
+    bool work_left = _metrics->nb_jobs_in_queue() > 0 || _metrics->nb_running_jobs() > 0 ||
+                     !_no_more_static_job_to_submit_received;
+    if (work_left && next_sample > date && next_sample != _metrics_wakeup)
+    {
+        batsched_tools::CALL_ME_LATERS cml;
+        cml.forWhat = batsched_tools::call_me_later_types::METRICS;
+        cml.id = _decision->get_nb_call_me_laters();
+        _decision->add_call_me_later(date,next_sample,cml);
+        _metrics_wakeup = next_sample;
+    }
+}
+void ISchedulingAlgorithm::on_metrics_call(double date, batsched_tools::CALL_ME_LATERS cml)
+{
+    _decision->remove_call_me_later(cml,date,_workload);
+    _nopped_recently = true;
+}
+void ISchedulingAlgorithm::add_metrics_format(MetricsFormat * format)
+{
+    if (_metrics == nullptr)
+    {
+        _metrics = new MetricsObserver(_workload,_queue,&_schedule);
+        _metrics->set_period(_metrics_period);
+        _decision->set_metrics_observer(_metrics);
+    }
+    _metrics->add_format(format);
+}
 void ISchedulingAlgorithm::set_failure_map(std::map<double,batsched_tools::failure_tuple> failure_map)
 {
  _file_failures = failure_map;
@@ -522,6 +684,8 @@ void ISchedulingAlgorithm::set_nb_machines(int nb_machines)
     CLOG_F(CCU_DEBUG_FIN,"_nb_machines: %d",_nb_machines);
     PPK_ASSERT_ERROR(_nb_machines == -1);
     _nb_machines = nb_machines;
+    if (_metrics != nullptr)
+        _metrics->set_nb_machines(nb_machines);
 }
 
 void ISchedulingAlgorithm::set_redis(RedisStorage *redis)
@@ -547,7 +711,97 @@ void ISchedulingAlgorithm::clear_recent_data_structures()
     _nopped_recently = false;
     _consumed_joules_updated_recently = false;
     _consumed_joules = -1;
+    _decision_triggers = TRIGGER_NONE;
+    }
+}
+
+void ISchedulingAlgorithm::add_decision_trigger(unsigned triggers)
+{
+    _decision_triggers |= triggers;
+}
+
+bool ISchedulingAlgorithm::needs_decisions(double date)
+{
+    (void) date;
+    return true;
+}
+
+bool ISchedulingAlgorithm::decisions_triggered() const
+{
+    return _decision_triggers != TRIGGER_NONE || checkpoint_under_way();
+}
+
+bool ISchedulingAlgorithm::checkpoint_under_way() const
+{
+    //the checkpoint steps (and the restart from one) are taken in make_decisions on every message
+    return _batsim_checkpoint_interval_type != "False" || _checkpoint_sync != 0 || _need_to_send_checkpoint ||
+           _need_to_checkpoint || _exit_make_decisions || _start_from_checkpoint.started_from_checkpoint;
+}
+
+bool ISchedulingAlgorithm::should_make_decisions(double date)
+{
+    if (_skip_decisions && !needs_decisions(date))
+        return false;
+    bool batchable = _decision_quantum > 0 && _decision_triggers == TRIGGER_QUEUE && !checkpoint_under_way();
+    double forced_date = batchable ? next_forced_decision_date(date) : date;
+    if (!batchable || date >= _next_decision_date || date >= forced_date)
+    {
+        if (_oldest_deferred_event >= 0)
+        {
+            if (_metrics != nullptr)
+                _metrics->on_deferred_decisions_made(date - _oldest_deferred_event);
+            _oldest_deferred_event = -1;
+        }
+        if (_decision_quantum > 0)
+            _next_decision_date = date + _decision_quantum;
+        return true;
     }
+
+    //the submissions and completions wait for the end of the quantum
+    if (_oldest_deferred_event < 0)
+        _oldest_deferred_event = date;
+    _nb_deferred_decisions++;
+    if (_metrics != nullptr)
+        _metrics->on_decisions_deferred();
+    //the wakeup comes earlier when the algorithm cannot wait for the end of the quantum
+    double wakeup = std::min(_next_decision_date, forced_date);
+    if (_decision_quantum_wakeup < 0 || wakeup < _decision_quantum_wakeup)
+    {
+        batsched_tools::CALL_ME_LATERS cml;
+        cml.forWhat = batsched_tools::call_me_later_types::DECISION_QUANTUM;
+        cml.id = _decision->get_nb_call_me_laters();
+        _decision->add_call_me_later(date,wakeup,cml);
+        _decision_quantum_wakeup = wakeup;
+    }
+    return false;
+}
+
+double ISchedulingAlgorithm::next_forced_decision_date(double date)
+{
+    (void) date;
+    return std::numeric_limits<double>::infinity();
+}
+
+void ISchedulingAlgorithm::speculate(double date)
+{
+    (void) date;
+}
+
+void ISchedulingAlgorithm::end_speculation(double date, const vector<string> & completed_jobs)
+{
+    (void) date;
+    (void) completed_jobs;
+}
+
+void ISchedulingAlgorithm::on_decision_quantum_call(double date, batsched_tools::CALL_ME_LATERS cml)
+{
+    _decision->remove_call_me_later(cml,date,_workload);
+    //an earlier wakeup may have replaced this one
+    if (date >= _decision_quantum_wakeup)
+        _decision_quantum_wakeup = -1;
+    //the deferred events may have been decided with an event that could not wait
+    if (_oldest_deferred_event >= 0)
+        add_decision_trigger(TRIGGER_CALL);
 }
 
 ISchedulingAlgorithm::ISchedulingAlgorithm(Workload *workload,
@@ -559,17 +813,101 @@ ISchedulingAlgorithm::ISchedulingAlgorithm(Workload *workload,
     _workload(workload), _decision(decision), _queue(queue), _selector(selector),
     _rjms_delay(rjms_delay), _variant_options(variant_options)
 {
-
+    if (variant_options != nullptr && variant_options->HasMember("schedule_notifications"))
+    {
+        const rapidjson::Value & notifications = (*variant_options)["schedule_notifications"];
+        PPK_ASSERT_ERROR(notifications.IsArray(),
+                "Invalid options: 'schedule_notifications' should be an array of strings");
+        std::set<std::string> known = _schedule_notifications;
+        known.insert("fragmentation");
+        _schedule_notifications.clear();
+        for (const auto & notification : notifications.GetArray())
+        {
+            PPK_ASSERT_ERROR(notification.IsString() && known.count(notification.GetString()) == 1,
+                    "Invalid options: 'schedule_notifications' elements should be in {queue_size, schedule_size, "
+                    "number_running_jobs, utilization, utilization_no_resv, fragmentation}");
+            _schedule_notifications.insert(notification.GetString());
+        }
+    }
+    if (variant_options != nullptr && variant_options->HasMember("schedule_notifications_period"))
+    {
+        PPK_ASSERT_ERROR((*variant_options)["schedule_notifications_period"].IsNumber() &&
+                         (*variant_options)["schedule_notifications_period"].GetDouble() >= 0,
+                "Invalid options: 'schedule_notifications_period' should be a non-negative number of seconds");
+        _schedule_notifications_period = (*variant_options)["schedule_notifications_period"].GetDouble();
+    }
+    if (variant_options != nullptr && variant_options->HasMember("failure_timeline_window"))
+    {
+        PPK_ASSERT_ERROR((*variant_options)["failure_timeline_window"].IsInt() &&
+                         (*variant_options)["failure_timeline_window"].GetInt() > 0,
+                "Invalid options: 'failure_timeline_window' should be a strictly positive integer");
+        _failure_timeline_window = (*variant_options)["failure_timeline_window"].GetInt();
+    }
+    if (variant_options != nullptr && variant_options->HasMember("metrics"))
+    {
+        const rapidjson::Value & formats = (*variant_options)["metrics"];
+        PPK_ASSERT_ERROR(formats.IsArray(),
+                "Invalid options: 'metrics' should be an array of strings");
+        for (const auto & name : formats.GetArray())
+        {
+            MetricsFormat * format = name.IsString() ? MetricsFormat::make(name.GetString()) : nullptr;
+            PPK_ASSERT_ERROR(format != nullptr,
+                    "Invalid options: 'metrics' elements should be in {events, state, counters}");
+            add_metrics_format(format);
+        }
+    }
+    if (variant_options != nullptr && variant_options->HasMember("metrics_period"))
+    {
+        PPK_ASSERT_ERROR((*variant_options)["metrics_period"].IsNumber() &&
+                         (*variant_options)["metrics_period"].GetDouble() > 0,
+                "Invalid options: 'metrics_period' should be a strictly positive number of seconds");
+        _metrics_period = (*variant_options)["metrics_period"].GetDouble();
+        if (_metrics != nullptr)
+            _metrics->set_period(_metrics_period);
+    }
+    if (variant_options != nullptr && variant_options->HasMember("skip_decisions"))
+    {
+        PPK_ASSERT_ERROR((*variant_options)["skip_decisions"].IsBool(),
+                "Invalid options: 'skip_decisions' should be a boolean");
+        _skip_decisions = (*variant_options)["skip_decisions"].GetBool();
+    }
+    if (variant_options != nullptr && variant_options->HasMember("decision_quantum"))
+    {
+        PPK_ASSERT_ERROR((*variant_options)["decision_quantum"].IsNumber() &&
+                         (*variant_options)["decision_quantum"].GetDouble() >= 0,
+                "Invalid options: 'decision_quantum' should be a non-negative number of seconds");
+        _decision_quantum = (*variant_options)["decision_quantum"].GetDouble();
+    }
+    if (variant_options != nullptr && variant_options->HasMember("speculation"))
+    {
+        PPK_ASSERT_ERROR((*variant_options)["speculation"].IsBool(),
+                "Invalid options: 'speculation' should be a boolean");
+        if ((*variant_options)["speculation"].GetBool())
+            _speculative_worker = new SpeculativeWorker();
+    }
 }
 
 ISchedulingAlgorithm::~ISchedulingAlgorithm()
 {
-
+    //the variants finish their speculation in their own destructor, the worker is idle here
+    delete _speculative_worker;
+    _speculative_worker = nullptr;
+    if (_metrics != nullptr)
+    {
+        _decision->set_metrics_observer(nullptr);
+        delete _metrics;
+        _metrics = nullptr;
+    }
+    //closes the log files, which a scheduler serving one simulation after the other would otherwise leak
+    delete _myBLOG;
+    _myBLOG = nullptr;
 }
 
 void ISchedulingAlgorithm::on_job_release(double date, const vector<string> &job_ids)
 {
-    (void) date;
+    if (_metrics != nullptr)
+        for (const string & job_id : job_ids)
+            _metrics->on_job_submitted(job_id,date);
     _jobs_released_recently.insert(_jobs_released_recently.end(),
                                    job_ids.begin(),
                                    job_ids.end());
@@ -577,7 +915,12 @@ void ISchedulingAlgorithm::on_job_release(double date, const vector<string> &job
 
 void ISchedulingAlgorithm::on_job_end(double date, const vector<string> &job_ids)
 {
-    (void) date;
+    for (const string & job_id : job_ids)
+    {
+        _decision->remove_running_job(job_id);
+        if (_metrics != nullptr)
+            _metrics->on_job_ended(job_id,date);
+    }
     _jobs_ended_recently.insert(_jobs_ended_recently.end(),
                                 job_ids.begin(),
                                 job_ids.end());
@@ -587,7 +930,12 @@ void ISchedulingAlgorithm::on_job_end(double date, const vector<string> &job_ids
 
 void ISchedulingAlgorithm::on_job_killed(double date, const std::unordered_map<std::string,batsched_tools::Job_Message *> &job_msgs)
 {
-    (void) date;
+    for (const auto & job_msg : job_msgs)
+    {
+        _decision->remove_running_job(job_msg.first);
+        if (_metrics != nullptr)
+            _metrics->on_job_killed(job_msg.first,date);
+    }
     _jobs_killed_recently.insert(job_msgs.begin(),
                                  job_msgs.end());
 }
@@ -797,26 +1145,19 @@ void ISchedulingAlgorithm::set_generators(double date){
                 machine_unif_distribution = new std::uniform_int_distribution<int>(0,_nb_machines-1);
             std::exponential_distribution<double>::param_type new_lambda(1.0/_workload->_SMTBF);
             failure_exponential_distribution->param(new_lambda);
-            double number;         
-            number = failure_exponential_distribution->operator()(generator_failure);
-        
-            batsched_tools::CALL_ME_LATERS cml;
-            cml.forWhat = batsched_tools::call_me_later_types::SMTBF;
-            cml.id = _decision->get_nb_call_me_laters();
-            _decision->add_call_me_later(date,number+date,cml);
+            //the first failure is requested by schedule_next_failure
+            _failure_timeline_end = date;
+            draw_failure();
         }
         else if (_workload->_MTBF!=-1.0)
         {
             failure_exponential_distribution = new std::exponential_distribution<double>(1.0/_workload->_MTBF);
+            if (machine_unif_distribution == nullptr)
+                machine_unif_distribution = new std::uniform_int_distribution<int>(0,_nb_machines-1);
             std::exponential_distribution<double>::param_type new_lambda(1.0/_workload->_MTBF);
             failure_exponential_distribution->param(new_lambda);
-            double number;         
-            number = failure_exponential_distribution->operator()(generator_failure);
-            
-            batsched_tools::CALL_ME_LATERS cml;
-            cml.forWhat = batsched_tools::call_me_later_types::MTBF;
-            cml.id = _decision->get_nb_call_me_laters();
-            _decision->add_call_me_later(date,number+date,cml);
+            _failure_timeline_end = date;
+            draw_failure();
         }
     }
     std::ofstream f;
@@ -948,17 +1289,7 @@ void ISchedulingAlgorithm::execute_jobs_in_running_state(double date)
                     CLOG_F(CCU_DEBUG,"job is being removed from _queue: %s",pair.second->id.c_str());
                     _queue->remove_job(pair.second);
                 }
-                if ((!_waiting_jobs.empty()))
-                {
-                    auto result = std::find(_waiting_jobs.begin(),_waiting_jobs.end(),pair.second);
-                    if (result != _waiting_jobs.end())
-                    {
-                        CLOG_F(CCU_DEBUG,"job is being removed from _waiting_jobs: %s",pair.second->id.c_str());
-                        _waiting_jobs.erase(result);
-
-                    }
-                }
-                else if ((!_pending_jobs.empty()))
+                if ((!_pending_jobs.empty()))
                 {
                     auto result = std::find(_pending_jobs.begin(),_pending_jobs.end(),pair.second);
                     if (result != _pending_jobs.end())
@@ -1127,12 +1458,31 @@ LOG_F(INFO,"here");
     //ingestVDM(failure);
     ingestM(_on_machine_instant_down_ups,failure,failure);
     ingestM(_on_machine_down_for_repairs,failure,failure);
+    //checkpoints taken before the failure timeline drew the next failure when one fired
+    if (failure.HasMember("_failure_timeline_dates"))
+    {
+        ingestM(_failing_machines,failure,failure);
+        ingestM(_failure_timeline_dates,failure,failure);
+        ingestM(_failure_timeline_machines,failure,failure);
+        ingestTTM(_failure_timeline_end,failure,failure,Double);
+    }
+    else
+    {
+        _failure_timeline_dates.clear();
+        _failure_timeline_machines.clear();
+        _failure_timeline_end = date;
+    }
     ingestTTM(_available_machines,failure,failure,String);
     ingestTTM(_unavailable_machines,failure,failure,String);
     ingestTTM(_nb_available_machines,failure,failure,Int);
     ingestTTM(_repair_machines,failure,failure,String);
     ingestTTM(_repairs_done,failure,failure,Int);
     ingestCMLS(failure["_call_me_laters"],date);
+    _failure_wakeups.clear();
+    for (const auto & kv_pair : _decision->get_call_me_laters())
+        if (kv_pair.second.forWhat == batsched_tools::call_me_later_types::SMTBF ||
+            kv_pair.second.forWhat == batsched_tools::call_me_later_types::MTBF)
+            _failure_wakeups.insert(kv_pair.second.time);
     ingestM(_my_kill_jobs,failure,failure);
 LOG_F(INFO,"here");
     //ingest schedule_variables
@@ -1376,6 +1726,10 @@ void ISchedulingAlgorithm::on_checkpoint_batsched(double date){
         <<"\t\t\"_call_me_laters\":"                              << batsched_tools::map_to_json_string(_decision->get_call_me_laters())  <<","<<std::endl
         <<"\t\t\"_on_machine_instant_down_ups\":"                 << batsched_tools::vector_to_json_string(&_on_machine_instant_down_ups) <<","<<std::endl
         <<"\t\t\"_on_machine_down_for_repairs\":"                 << batsched_tools::vector_to_json_string(&_on_machine_down_for_repairs) <<","<<std::endl
+        <<"\t\t\"_failing_machines\":"                            << batsched_tools::vector_to_json_string(&_failing_machines)            <<","<<std::endl
+        <<"\t\t\"_failure_timeline_dates\":"                      << batsched_tools::vector_to_json_string(&_failure_timeline_dates)      <<","<<std::endl
+        <<"\t\t\"_failure_timeline_machines\":"                   << batsched_tools::vector_to_json_string(&_failure_timeline_machines)   <<","<<std::endl
+        <<"\t\t\"_failure_timeline_end\":"                        << batsched_tools::to_json_string(_failure_timeline_end)                <<","<<std::endl
         //TODO _file_failures
         <<"\t\t\"_available_machines\":"                          << batsched_tools::to_json_string(_available_machines)                  <<","<<std::endl
         <<"\t\t\"_unavailable_machines\":"                        << batsched_tools::to_json_string(_unavailable_machines)                <<","<<std::endl
@@ -1468,7 +1822,7 @@ void ISchedulingAlgorithm::on_checkpoint_batsched(double date){
         if (_horizon_algorithm)
         {
             f<<std::fixed<<std::setprecision(15)<<std::boolalpha
-            <<"\t\t\"_horizons\":"             << (_horizons.empty()? "\"\"" : batsched_tools::list_to_json_string(_horizons,false))              <<","<<std::endl;
+            <<"\t\t\"_horizons\":"             << (_horizons.empty()? "\"\"" : batsched_tools::to_json_string(_horizons))              <<","<<std::endl;
         }
         f<<std::fixed<<std::setprecision(15)<<std::boolalpha
         <<"\t\t\"_current_allocations\":"                              << batsched_tools::unordered_map_to_json_string(_current_allocations) <<","<<std::endl;
@@ -1747,6 +2101,19 @@ void ISchedulingAlgorithm::on_query_estimate_waiting_time(double date, const str
         }
         return theVector;
     }
+    std::vector<int> ISchedulingAlgorithm::ingest([[maybe_unused]] std::vector<int> &aVector, const rapidjson::Value &json)
+    {
+        const rapidjson::Value & array = json.GetArray();
+        std::vector<int> theVector;
+        if (!array.Empty())
+        {
+            for(rapidjson::SizeType i = 0;i<array.Size();i++)
+            {
+                theVector.push_back(array[i].GetInt());
+            }
+        }
+        return theVector;
+    }
     void ISchedulingAlgorithm::ingestCMLS(const rapidjson::Value &json,double date)
     {
         const rapidjson::Value & array = json.GetArray();
@@ -1760,6 +2127,7 @@ void ISchedulingAlgorithm::on_query_estimate_waiting_time(double date, const str
                 cml.forWhat = static_cast<batsched_tools::call_me_later_types>(array[i]["value"]["forWhat"].GetInt());
                 cml.extra_data = array[i]["value"]["extra_data"].GetString();
                 cml.id = array[i]["value"]["id"].GetInt();
+                batsched_tools::read_extra_data(cml);
                 aMap[cml.id]=cml;
             }
         }
@@ -1877,10 +2245,11 @@ void ISchedulingAlgorithm::on_query_estimate_waiting_time(double date, const str
         }
         return uset;
     }
-    std::list<batsched_tools::FinishedHorizonPoint> ISchedulingAlgorithm::ingest(std::list<batsched_tools::FinishedHorizonPoint> &aList,const rapidjson::Value &json)
+    //the horizons argument only selects the overload, the ingested horizons are returned
+    batsched_tools::FinishedHorizons ISchedulingAlgorithm::ingest([[maybe_unused]] batsched_tools::FinishedHorizons &horizons,const rapidjson::Value &json)
     {
         const rapidjson::Value & array = json.GetArray();
-        std::list<batsched_tools::FinishedHorizonPoint> theList;
+        batsched_tools::FinishedHorizons theList;
         if (!array.Empty())
         {
             for (rapidjson::SizeType i = 0;i<array.Size();i++)
@@ -1889,7 +2258,7 @@ void ISchedulingAlgorithm::on_query_estimate_waiting_time(double date, const str
                 fhp.date = array[i]["date"].GetDouble();
                 fhp.nb_released_machines = array[i]["nb_released_machines"].GetInt();
                 fhp.machines = IntervalSet::from_string_hyphen(array[i]["machines"].GetString());
-                theList.push_back(fhp);
+                theList.insert(fhp);
             }
         }
         return theList;
@@ -1909,7 +2278,7 @@ void ISchedulingAlgorithm::on_query_estimate_waiting_time(double date, const str
                 int horizon_index = array[i]["value"]["horizon_it"].GetInt();
                 if (horizon_index != -1)
                 {
-                    std::list<batsched_tools::FinishedHorizonPoint>::iterator it = _horizons.begin();
+                    batsched_tools::FinishedHorizons::iterator it = _horizons.begin();
                     if (horizon_index != 0)
                         std::advance(it,horizon_index);
                     value.horizon_it = it;
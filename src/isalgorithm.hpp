@@ -9,6 +9,8 @@
 //#include "external/batsched_workload.hpp"
 #include "batsched_tools.hpp"
 #include "machine.hpp"
+#include "metrics.hpp"
+#include "speculation.hpp"
 #include <random>
 
 /**
@@ -136,6 +138,81 @@ public:
                                 SortableJobOrder::UpdateInformation * update_info,
                                 SortableJobOrder::CompareInformation * compare_info) = 0;
 
+    /**
+     * @brief What the events received since the last make_decisions can have changed, as flags
+     */
+    enum DecisionTrigger : unsigned
+    {
+        TRIGGER_NONE = 0,
+        TRIGGER_QUEUE = 1 << 0,    //!< jobs were submitted, completed, killed or faulted
+        TRIGGER_MACHINES = 1 << 1, //!< machines changed state or availability
+        TRIGGER_CALL = 1 << 2,     //!< a call me later of the algorithm fired (METRICS ones excepted)
+        TRIGGER_OTHER = 1 << 3     //!< any other event that can change a decision
+    };
+
+    /**
+     * @brief Records what an event can have changed.  Called by the drivers as they dispatch the events
+     * @details The triggers are reset by clear_recent_data_structures
+     */
+    void add_decision_trigger(unsigned triggers);
+
+    /**
+     * @brief Whether make_decisions has anything to do for the events received since its last call
+     * @details The drivers skip make_decisions and answer right away when it returns false, unless the
+     *          'skip_decisions' variant option is false.  Always true by default: variants whose decisions only
+     *          change on events override it, see decisions_triggered()
+     * @param[in] date The current date
+     */
+    virtual bool needs_decisions(double date);
+
+    /**
+     * @brief Whether an event that can change a decision was received since the last make_decisions, or a
+     *        checkpoint is under way (its steps are taken in make_decisions, whatever the events)
+     */
+    bool decisions_triggered() const;
+    /** @brief Whether a checkpoint (or the restart from one) needs make_decisions on every message */
+    bool checkpoint_under_way() const;
+
+    /**
+     * @brief Whether the drivers have to call make_decisions for the message at date
+     * @details needs_decisions(), batched with the 'decision_quantum' variant option: a message that only brings
+     *          submissions and completions is decided at most once per quantum.  Its events are kept for the next
+     *          decision, at the latest on the DECISION_QUANTUM call me later that ends the quantum.  Any other
+     *          event is decided right away, with the deferred ones
+     */
+    bool should_make_decisions(double date);
+    /**
+     * @brief The date from which make_decisions cannot wait for the end of a quantum any more
+     * @details should_make_decisions() decides right away from this date, and wakes up at the latest at this date
+     *          when it defers.  None (infinity) by default
+     * @param[in] date The current date
+     */
+    virtual double next_forced_decision_date(double date);
+    /**
+     * @brief Handles a DECISION_QUANTUM call me later: the deferred events are decided
+     */
+    void on_decision_quantum_call(double date, batsched_tools::CALL_ME_LATERS cml);
+    /** @brief The number of messages whose decisions were deferred to the end of a quantum */
+    long nb_deferred_decisions() const { return _nb_deferred_decisions; }
+
+    /**
+     * @brief Called by the drivers once a message is answered, before they wait for the next one
+     * @details With the 'speculation' variant option, a variant can start precomputing the decisions of the event it
+     *          expects next on the speculative worker.  Does nothing by default
+     */
+    virtual void speculate(double date);
+    /**
+     * @brief Called by the drivers when the next message arrives, before any of its events is dispatched
+     * @details The speculation started by speculate() is finished, and its result kept only if the message is the
+     *          expected one.  Does nothing by default
+     * @param[in] date The date of the message
+     * @param[in] completed_jobs The jobs the message completes when it brings no other event, empty otherwise
+     */
+    virtual void end_speculation(double date, const std::vector<std::string> & completed_jobs);
+    /** @brief The number of speculations started, and how many of them were used */
+    long nb_speculations() const { return _nb_speculations; }
+    long nb_speculation_hits() const { return _nb_speculation_hits; }
+
     /**
      * @brief Allows to set the total number of machines in the platform
      * @details This function is called just before on_simulation_start
@@ -180,11 +257,39 @@ public:
     void schedule_start(double date,const rapidjson::Value & batsim_event);
     void requested_failure_call(double date,batsched_tools::CALL_ME_LATERS cml_in);
     void handle_failures(double date);
+    /**
+     * @brief Requests the wakeup of the next MTBF/SMTBF failure of the timeline that can affect the schedule
+     * @details Must be called once the decisions of a message are made.  With instant down/ups, failures hitting
+     * a machine without running jobs are consumed without any wakeup.
+     */
+    void schedule_next_failure(double date);
     IntervalSet normal_repair(double date);
     IntervalSet normal_downUp(double date);
+    void draw_failure();
+    bool failure_affects_schedule(int machine);
+    void skip_failure(double failure_date,int machine);
+    int next_failing_machine();
     void schedule_repair(IntervalSet machine,batsched_tools::KILL_TYPES forWhat,double date);
     void schedule_downUp(IntervalSet machine,batsched_tools::KILL_TYPES forWhat,double date);
     bool schedule_kill_jobs(IntervalSet machine,batsched_tools::KILL_TYPES forWhat, double date);
+    /**
+     * @brief Sends the queue and schedule statistics as generic notifications
+     * @details Only the statistics listed in the 'schedule_notifications' variant option are sent, and at most
+     *          once every 'schedule_notifications_period' seconds of simulated time
+     */
+    void send_schedule_notifications(double date);
+    /** @brief Whether send_schedule_notifications would send anything at date */
+    bool schedule_notifications_due(double date) const;
+    /**
+     * @brief Writes the metrics of the events since the last call, and the periodic metrics when they are due
+     * @details Must be called once the decisions of a message are made.  Requests the METRICS call me later of
+     *          the next sampling date of the periodic formats
+     */
+    void write_metrics(double date);
+    /**
+     * @brief Handles a METRICS call me later: the wakeup only has to reach write_metrics
+     */
+    void on_metrics_call(double date, batsched_tools::CALL_ME_LATERS cml);
     void set_index_of_horizons();
     void execute_jobs_in_running_state(double date);
     bool get_clear_recent_data_structures();
@@ -207,6 +312,7 @@ public:
     std::vector<std::string> ingest(std::vector<std::string> &aVector,const rapidjson::Value &json);
     std::unordered_map<std::string, batsched_tools::Job_Message *> ingest(std::unordered_map<std::string, batsched_tools::Job_Message *> &aUMap, const rapidjson::Value &json);
     std::vector<double> ingest(std::vector<double> &aVector, const rapidjson::Value &json);
+    std::vector<int> ingest(std::vector<int> &aVector, const rapidjson::Value &json);
     void ingestCMLS(const rapidjson::Value &json,double date);
     std::vector<batsched_tools::KILL_TYPES> ingest(std::vector<batsched_tools::KILL_TYPES> &aVector, const rapidjson::Value &json);
     std::map<Job *,batsched_tools::Job_Message *> ingest(std::map<Job *,batsched_tools::Job_Message *> &aMap, const rapidjson::Value &json);
@@ -216,7 +322,7 @@ public:
     std::list<Job *> ingest(std::list<Job *> &aList,const rapidjson::Value &json);
     std::unordered_set<std::string> ingest(std::unordered_set<std::string> &aUSet, const rapidjson::Value &json);
     std::unordered_map<std::string,batsched_tools::Allocation> ingest(std::unordered_map<std::string,batsched_tools::Allocation> &aUMap, const rapidjson::Value &json);
-    std::list<batsched_tools::FinishedHorizonPoint> ingest(std::list<batsched_tools::FinishedHorizonPoint> &aList, const rapidjson::Value &json);
+    batsched_tools::FinishedHorizons ingest(batsched_tools::FinishedHorizons &horizons, const rapidjson::Value &json);
 
 
     //easy_bf3
@@ -238,6 +344,13 @@ public:
     
     
 
+protected:
+    /**
+     * @brief Attaches a metrics format to the metrics observer, creating the observer on first use
+     * @details Must be called from the constructor, the files of the formats are opened on simulation start
+     */
+    void add_metrics_format(MetricsFormat * format);
+
 protected:
     //X = not checkpointed
     //C = checkpointed
@@ -247,7 +360,6 @@ protected:
     Machines * _machines=nullptr; //C
     Queue * _queue = nullptr; //C
     Workload * _workload; //X
-    std::vector<Job *> _waiting_jobs;
     SchedulingDecision * _decision; //X
     std::string _queue_policy; //X
     ResourceSelector * _selector; //X
@@ -255,7 +367,7 @@ protected:
     rapidjson::Document * _variant_options; //X
     int _nb_machines = -1; //X
     RedisStorage * _redis = nullptr; //X
-    b_log *_myBLOG; //X
+    b_log *_myBLOG = nullptr; //X
     std::string _output_folder; //X
     bool _exit_make_decisions = false; //X
     std::chrono::_V2::system_clock::time_point _start_real_time; //X
@@ -290,6 +402,12 @@ protected:
     
     std::vector<batsched_tools::KILL_TYPES> _on_machine_instant_down_ups; //C
     std::vector<batsched_tools::KILL_TYPES> _on_machine_down_for_repairs; //C
+    std::vector<int> _failing_machines; //C  machine of each failure above, -1 if it is drawn when handled
+    std::vector<double> _failure_timeline_dates; //C  MTBF/SMTBF failures drawn ahead of time, in draw order
+    std::vector<int> _failure_timeline_machines; //C  machine drawn for each of them
+    double _failure_timeline_end = 0; //C  date of the last failure drawn
+    std::set<double> _failure_wakeups; //X rebuilt from the call me laters
+    int _failure_timeline_window = 64; //X
     std::map<double,batsched_tools::failure_tuple> _file_failures; //X TODO
     IntervalSet _available_machines; //C
     IntervalSet _unavailable_machines; //C
@@ -351,6 +469,13 @@ protected:
     std::vector<Schedule::ReservedTimeSlice> _saved_reservations; //C
     std::vector<std::string> _saved_recently_queued_jobs; //C
     std::vector<std::string> _saved_recently_ended_jobs; //C
+    std::set<std::string> _schedule_notifications = {"queue_size","schedule_size","number_running_jobs",
+                                                     "utilization","utilization_no_resv"}; //X
+    double _schedule_notifications_period = 0; //X
+    double _last_schedule_notifications_date = -1; //X
+    MetricsObserver * _metrics = nullptr; //X counters are rebuilt from the events that follow a checkpoint
+    double _metrics_period = 3600; //X
+    double _metrics_wakeup = -1; //X date of the pending METRICS call me later
     //**************************************************
 
     //Real Checkpoint Variables
@@ -366,6 +491,16 @@ protected:
     bool _block_checkpoint = false; //X
     double _start_from_checkpoint_time=0; //X
     bool _clear_recent_data_structures=true; //X
+    unsigned _decision_triggers = TRIGGER_OTHER; //X the first make_decisions is never skipped
+    bool _skip_decisions = true; //X false when make_decisions is called on every message, needs_decisions() or not
+    double _decision_quantum = 0; //X 0 when submissions and completions are decided as they come
+    double _next_decision_date = -1; //X the end of the current quantum
+    double _oldest_deferred_event = -1; //X date of the first message deferred to the end of the quantum, -1 if none
+    double _decision_quantum_wakeup = -1; //X date of the pending DECISION_QUANTUM call me later
+    long _nb_deferred_decisions = 0; //X
+    SpeculativeWorker * _speculative_worker = nullptr; //X nullptr unless the 'speculation' variant option is set
+    long _nb_speculations = 0; //X
+    long _nb_speculation_hits = 0; //X
     bool _clear_jobs_recently_released=true; //X
     int _checkpoint_sync = 0; //X
     bool _debug_real_checkpoint = false; //X
@@ -381,12 +516,13 @@ protected:
     std::list<Job *> _pending_jobs; //C
     std::list<Job *> _pending_jobs_heldback; //C
     std::unordered_set<std::string> _running_jobs; //C
-    std::list<batsched_tools::FinishedHorizonPoint> _horizons; //C
+    batsched_tools::FinishedHorizons _horizons; //C
     std::unordered_map<std::string, batsched_tools::Allocation> _current_allocations; //C
     int _share_packing_holdback = 0; //X
     int _p_counter = 0; //pending jobs erased counter  //X
     int _e_counter = 0; //execute job counter  //X
     IntervalSet _heldback_machines; //C
+    batsched_tools::FreeCoreIndex _free_cores; //rebuilt from _available_core_machines, not checkpointed
     //*************************************************
 
   
@@ -0,0 +1,132 @@
+#include "job_lists.hpp"
+
+#include "pempek_assert.hpp"
+
+using namespace std;
+
+namespace
+{
+    //the numeric part of a job id: what follows the '!' of the workload, or the beginning of the id
+    int job_number(const string & job_id)
+    {
+        size_t begin = job_id.find('!') + 1;
+        size_t end = job_id.find_first_not_of("0123456789", begin);
+        return std::stoi(job_id.substr(begin, end - begin));
+    }
+}
+
+bool WaitingJobs::Compare::operator()(const Entry & a, const Entry & b) const
+{
+    if (a.submission != b.submission)
+        return a.submission < b.submission;
+    if (a.number != b.number)
+        return a.number < b.number;
+    return a.sequence < b.sequence;
+}
+
+void WaitingJobs::set_original_order(bool original_order)
+{
+    PPK_ASSERT_ERROR(_jobs.empty() || original_order == _original_order,
+                     "The order of the waiting jobs cannot change while jobs are waiting");
+    _original_order = original_order;
+}
+
+WaitingJobs::iterator WaitingJobs::insert(Job * job)
+{
+    auto indexed = _index.find(job->id);
+    if (indexed != _index.end())
+        return indexed->second;
+
+    Entry entry;
+    entry.submission = _original_order ? job->submission_times[0] : job->original_submit;
+    entry.number = job_number(job->id);
+    entry.sequence = _next_sequence++;
+    entry.job = job;
+    iterator it = _jobs.insert(entry).first;
+    _index.emplace(job->id, it);
+    return it;
+}
+
+WaitingJobs::iterator WaitingJobs::find(const string & job_id)
+{
+    auto indexed = _index.find(job_id);
+    return indexed == _index.end() ? _jobs.end() : indexed->second;
+}
+
+bool WaitingJobs::contains(const string & job_id) const
+{
+    return _index.count(job_id) > 0;
+}
+
+WaitingJobs::iterator WaitingJobs::erase(iterator it)
+{
+    _index.erase(it->job->id);
+    return _jobs.erase(it);
+}
+
+bool WaitingJobs::erase(const string & job_id)
+{
+    auto indexed = _index.find(job_id);
+    if (indexed == _index.end())
+        return false;
+    _jobs.erase(indexed->second);
+    _index.erase(indexed);
+    return true;
+}
+
+void WaitingJobs::clear()
+{
+    _jobs.clear();
+    _index.clear();
+}
+
+vector<Job *> WaitingJobs::to_vector() const
+{
+    vector<Job *> jobs;
+    jobs.reserve(_jobs.size());
+    for (const Entry & entry : _jobs)
+        jobs.push_back(entry.job);
+    return jobs;
+}
+
+ScheduledJobs::~ScheduledJobs()
+{
+    clear();
+}
+
+ScheduledJobs::iterator ScheduledJobs::insert(batsched_tools::Scheduled_Job * job)
+{
+    PPK_ASSERT_ERROR(_index.count(job->id) == 0, "Job '%s' is already scheduled", job->id.c_str());
+    //a multiset inserts after the jobs with the same key
+    iterator it = _jobs.insert(job);
+    _index.emplace(job->id, it);
+    return it;
+}
+
+ScheduledJobs::iterator ScheduledJobs::find(const string & job_id)
+{
+    auto indexed = _index.find(job_id);
+    return indexed == _index.end() ? _jobs.end() : indexed->second;
+}
+
+ScheduledJobs::iterator ScheduledJobs::erase(iterator it)
+{
+    batsched_tools::Scheduled_Job * job = *it;
+    _index.erase(job->id);
+    it = _jobs.erase(it);
+    delete job;
+    return it;
+}
+
+void ScheduledJobs::clear()
+{
+    for (batsched_tools::Scheduled_Job * job : _jobs)
+        delete job;
+    _jobs.clear();
+    _index.clear();
+}
+
+vector<batsched_tools::Scheduled_Job *> ScheduledJobs::to_vector() const
+{
+    return vector<batsched_tools::Scheduled_Job *>(_jobs.begin(), _jobs.end());
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "json_workload.hpp"
+#include "batsched_tools.hpp"
+
+/**
+ * @brief Waiting jobs kept in FCFS order between decisions: by submission date, then by job number
+ * @details The sort keys are computed once, when a job is queued, and every job has a handle in an index by id,
+ *          so queueing, finding and removing a job are O(log n) and the list never needs to be sorted again.
+ *          Iterating goes through the jobs in order.
+ */
+class WaitingJobs
+{
+public:
+    struct Entry
+    {
+        double submission; //!< original_submit, or submission_times[0] with the ORIGINAL-FCFS order
+        int number; //!< the numeric part of the job id
+        unsigned long sequence; //!< queueing order, so that jobs with the same keys keep a stable order
+        Job * job;
+    };
+
+    struct Compare
+    {
+        bool operator()(const Entry & a, const Entry & b) const;
+    };
+
+    typedef std::set<Entry, Compare>::iterator iterator;
+
+    /**
+     * @brief Whether jobs are ordered by their first submission date (ORIGINAL-FCFS) or by original_submit (FCFS)
+     * @details Can only change while the list is empty, as the keys of the queued jobs are not recomputed
+     */
+    void set_original_order(bool original_order);
+
+    /** @brief Queues job.  A job whose id is already queued is not queued twice */
+    iterator insert(Job * job);
+    /** @brief The queued job called job_id, end() if there is none */
+    iterator find(const std::string & job_id);
+    bool contains(const std::string & job_id) const;
+    /** @brief Removes a queued job, returns the job after it */
+    iterator erase(iterator it);
+    /** @brief Removes job_id if it is queued, returns whether it was */
+    bool erase(const std::string & job_id);
+    void clear();
+
+    iterator begin() { return _jobs.begin(); }
+    iterator end() { return _jobs.end(); }
+    bool empty() const { return _jobs.empty(); }
+    size_t size() const { return _jobs.size(); }
+    /** @brief The queued jobs in order, for checkpoints and logs */
+    std::vector<Job *> to_vector() const;
+
+private:
+    std::set<Entry, Compare> _jobs;
+    std::unordered_map<std::string, iterator> _index;
+    bool _original_order = false;
+    unsigned long _next_sequence = 0;
+};
+
+/**
+ * @brief Running jobs kept in order of estimated finish time, with a handle in an index by id
+ * @details Inserting and removing a job is O(log n).  Jobs with the same estimated finish time stay in the order
+ *          they were inserted.  The list owns its jobs.
+ */
+class ScheduledJobs
+{
+public:
+    struct Compare
+    {
+        bool operator()(const batsched_tools::Scheduled_Job * a, const batsched_tools::Scheduled_Job * b) const
+        {
+            return a->est_finish_time < b->est_finish_time;
+        }
+    };
+
+    typedef std::multiset<batsched_tools::Scheduled_Job *, Compare>::iterator iterator;
+
+    ~ScheduledJobs();
+
+    /** @brief Takes ownership of job */
+    iterator insert(batsched_tools::Scheduled_Job * job);
+    /** @brief The scheduled job called job_id, end() if there is none */
+    iterator find(const std::string & job_id);
+    /** @brief Removes and deletes a scheduled job, returns the job after it */
+    iterator erase(iterator it);
+    void clear();
+
+    iterator begin() { return _jobs.begin(); }
+    iterator end() { return _jobs.end(); }
+    bool empty() const { return _jobs.empty(); }
+    size_t size() const { return _jobs.size(); }
+    /** @brief The scheduled jobs in order, for checkpoints */
+    std::vector<batsched_tools::Scheduled_Job *> to_vector() const;
+
+private:
+    std::multiset<batsched_tools::Scheduled_Job *, Compare> _jobs;
+    std::unordered_map<std::string, iterator> _index;
+};
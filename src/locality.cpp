@@ -1,11 +1,130 @@
 #include "locality.hpp"
 
+#include <algorithm>
+#include <climits>
+#include <fstream>
+#include <iterator>
+
 #include "schedule.hpp"
 
 #include "json_workload.hpp"
 #include "pempek_assert.hpp"
 
 
+void FreeBlockIndex::assign(const IntervalSet &available)
+{
+    _blocks.clear();
+    _by_size.clear();
+    _nb_free = 0;
+    for (auto it = available.intervals_begin(); it != available.intervals_end(); ++it)
+        add_block(it->lower(), it->upper());
+}
+
+bool FreeBlockIndex::best_fit(int nb_resources, IntervalSet &allocated)
+{
+    auto it = _by_size.lower_bound(std::make_pair(nb_resources, INT_MIN));
+    if (nb_resources <= 0 || it == _by_size.end())
+        return false;
+
+    int lower = it->second;
+    allocated = IntervalSet::ClosedInterval(lower, lower + nb_resources - 1);
+    remove(allocated);
+    return true;
+}
+
+void FreeBlockIndex::remove(const IntervalSet &machines)
+{
+    for (auto it = machines.intervals_begin(); it != machines.intervals_end(); ++it)
+    {
+        int lower = it->lower();
+        int upper = it->upper();
+
+        // The first block that may overlap [lower, upper] is the last one starting at or before lower
+        auto block = _blocks.upper_bound(lower);
+        if (block != _blocks.begin())
+            --block;
+
+        while (block != _blocks.end() && block->first <= upper)
+        {
+            int block_lower = block->first;
+            int block_upper = block->second;
+            auto next = std::next(block);
+            if (block_upper >= lower)
+            {
+                remove_block(block);
+                if (block_lower < lower)
+                    add_block(block_lower, lower - 1);
+                if (block_upper > upper)
+                    add_block(upper + 1, block_upper);
+            }
+            block = next;
+        }
+    }
+}
+
+void FreeBlockIndex::insert(const IntervalSet &machines)
+{
+    for (auto it = machines.intervals_begin(); it != machines.intervals_end(); ++it)
+    {
+        int lower = it->lower();
+        int upper = it->upper();
+
+        auto next = _blocks.lower_bound(lower);
+        PPK_ASSERT_ERROR(next == _blocks.end() || next->first > upper,
+                         "Machines [%d,%d] are already in the free block index", lower, upper);
+        if (next != _blocks.end() && next->first == upper + 1)
+        {
+            upper = next->second;
+            remove_block(next);
+        }
+
+        auto previous = _blocks.lower_bound(lower);
+        if (previous != _blocks.begin())
+        {
+            --previous;
+            PPK_ASSERT_ERROR(previous->second < lower,
+                             "Machines [%d,%d] are already in the free block index", lower, upper);
+            if (previous->second == lower - 1)
+            {
+                lower = previous->first;
+                remove_block(previous);
+            }
+        }
+
+        add_block(lower, upper);
+    }
+}
+
+double FreeBlockIndex::fragmentation() const
+{
+    if (_nb_free == 0)
+        return 0;
+    return 1.0 - (double)largest_block() / _nb_free;
+}
+
+double FreeBlockIndex::fragmentation(const IntervalSet &available)
+{
+    if (available.is_empty())
+        return 0;
+    auto biggest = available.biggest_interval();
+    return 1.0 - (double)(biggest->upper() - biggest->lower() + 1) / available.size();
+}
+
+void FreeBlockIndex::add_block(int lower, int upper)
+{
+    _blocks[lower] = upper;
+    _by_size.insert(std::make_pair(upper - lower + 1, lower));
+    _nb_free += upper - lower + 1;
+}
+
+void FreeBlockIndex::remove_block(std::map<int,int>::iterator block)
+{
+    int size = block->second - block->first + 1;
+    _by_size.erase(std::make_pair(size, block->first));
+    _nb_free -= size;
+    _blocks.erase(block);
+}
+
 ResourceSelector::ResourceSelector()
 {
 
@@ -339,3 +458,295 @@ void LimitedRangeResourceSelector::select_resources_to_awaken_to_make_job_fit(co
 
     PPK_ASSERT_ERROR(false, "The LimitedRangeResourceSelector is not meant to be used to select resources to awaken to make a job fit");
 }
+
+BestFitResourceSelector::BestFitResourceSelector()
+{
+
+}
+
+BestFitResourceSelector::~BestFitResourceSelector()
+{
+
+}
+
+bool BestFitResourceSelector::fit(const Job *job, const IntervalSet &available, IntervalSet &allocated)
+{
+    if (!_index_valid)
+    {
+        _index.assign(available);
+        _index_valid = true;
+    }
+    else if (available != _indexed)
+    {
+        _index.remove(_indexed - available);
+        _index.insert(available - _indexed);
+    }
+    _indexed = available;
+
+    if (!_index.best_fit(job->nb_requested_resources, allocated))
+        return false;
+
+    PPK_ASSERT_ERROR(allocated.size() == (unsigned int)job->nb_requested_resources);
+    _indexed -= allocated;
+    return true;
+}
+
+TopologyResourceSelector::TopologyResourceSelector(const rapidjson::Value &topology)
+{
+    load(topology);
+}
+
+TopologyResourceSelector::TopologyResourceSelector(const std::string &topology_filepath)
+{
+    std::ifstream file(topology_filepath);
+    PPK_ASSERT_ERROR(file.is_open(), "Couldn't open topology file '%s'", topology_filepath.c_str());
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    rapidjson::Document doc;
+    doc.Parse(content.c_str());
+    PPK_ASSERT_ERROR(!doc.HasParseError(), "Invalid topology file '%s': not a JSON document", topology_filepath.c_str());
+    load(doc);
+}
+
+TopologyResourceSelector::~TopologyResourceSelector()
+{
+
+}
+
+void TopologyResourceSelector::load(const rapidjson::Value &topology)
+{
+    PPK_ASSERT_ERROR(topology.IsObject() && topology.HasMember("levels") && topology["levels"].IsArray()
+                     && topology["levels"].Size() > 0,
+                     "Invalid topology: should be an object with a non-empty 'levels' array");
+    const rapidjson::Value & levels = topology["levels"];
+
+    std::vector<std::string> level_names;
+    int max_machine = -1;
+    for (rapidjson::SizeType level = 0; level < levels.Size(); ++level)
+    {
+        PPK_ASSERT_ERROR(levels[level].IsObject() && levels[level].HasMember("groups") && levels[level]["groups"].IsArray(),
+                         "Invalid topology: level %d should be an object with a 'groups' array", (int)level);
+        level_names.push_back(levels[level].HasMember("name") && levels[level]["name"].IsString() ?
+                              levels[level]["name"].GetString() : std::to_string(level));
+
+        IntervalSet level_machines;
+        for (const auto & group_machines : levels[level]["groups"].GetArray())
+        {
+            PPK_ASSERT_ERROR(group_machines.IsString(), "Invalid topology: the groups of level '%s' should be strings like \"0-15\"",
+                             level_names.back().c_str());
+            Group group;
+            group.machines = IntervalSet::from_string_hyphen(group_machines.GetString());
+            group.level = level;
+            PPK_ASSERT_ERROR(!group.machines.is_empty(), "Invalid topology: empty group in level '%s'", level_names.back().c_str());
+            PPK_ASSERT_ERROR((level_machines & group.machines).is_empty(),
+                             "Invalid topology: group %s of level '%s' overlaps another group of the level",
+                             group.machines.to_string_hyphen().c_str(), level_names.back().c_str());
+            level_machines += group.machines;
+            for (auto it = group.machines.intervals_begin(); it != group.machines.intervals_end(); ++it)
+                max_machine = std::max(max_machine, it->upper());
+            _groups.push_back(group);
+        }
+    }
+    _free_groups.resize(levels.Size());
+
+    // Every group finds its parent from the group of the next level that holds its first machine
+    std::vector<int> owner(max_machine + 1, -1);
+    std::vector<int> previous_owner;
+    for (int level = 0; level < (int)levels.Size(); ++level)
+    {
+        previous_owner = owner;
+        std::fill(owner.begin(), owner.end(), -1);
+        for (int group = 0; group < (int)_groups.size(); ++group)
+        {
+            if (_groups[group].level != level)
+                continue;
+            const IntervalSet & machines = _groups[group].machines;
+            for (auto it = machines.intervals_begin(); it != machines.intervals_end(); ++it)
+                for (int machine = it->lower(); machine <= it->upper(); ++machine)
+                    owner[machine] = group;
+        }
+
+        if (level == 0)
+        {
+            _lowest_group = owner;
+            continue;
+        }
+        for (int child = 0; child < (int)_groups.size(); ++child)
+        {
+            if (_groups[child].level != level - 1)
+                continue;
+            int parent = owner[_groups[child].machines.first_element()];
+            if (parent == -1)
+                continue;
+            PPK_ASSERT_ERROR(_groups[child].machines.is_subset_of(_groups[parent].machines),
+                             "Invalid topology: group %s of level '%s' is not inside a single group of level '%s'",
+                             _groups[child].machines.to_string_hyphen().c_str(), level_names[level - 1].c_str(),
+                             level_names[level].c_str());
+            _groups[child].parent = parent;
+            _groups[parent].children.push_back(child);
+        }
+        for (int group = 0; group < (int)_groups.size(); ++group)
+        {
+            if (_groups[group].level != level)
+                continue;
+            unsigned int nb_children_machines = 0;
+            for (int child : _groups[group].children)
+                nb_children_machines += _groups[child].machines.size();
+            PPK_ASSERT_ERROR(nb_children_machines == _groups[group].machines.size(),
+                             "Invalid topology: group %s of level '%s' is not a union of groups of level '%s'",
+                             _groups[group].machines.to_string_hyphen().c_str(), level_names[level].c_str(),
+                             level_names[level - 1].c_str());
+        }
+    }
+
+    for (int group = 0; group < (int)_groups.size(); ++group)
+    {
+        if (_groups[group].parent == -1)
+            _roots.push_back(group);
+        if (_groups[group].level == 0)
+            _grouped_machines += _groups[group].machines;
+        _free_groups[_groups[group].level].insert(std::make_pair(0, group));
+    }
+    _pending.assign(_groups.size(), 0);
+}
+
+bool TopologyResourceSelector::fit(const Job *job, const IntervalSet &available, IntervalSet &allocated)
+{
+    int nb_resources = job->nb_requested_resources;
+    if (nb_resources > (int) available.size())
+        return false;
+    sync(available);
+
+    allocated.clear();
+    bool placed = false;
+    for (auto & free_groups : _free_groups)
+    {
+        auto best = free_groups.lower_bound(std::make_pair(nb_resources, INT_MIN));
+        if (best != free_groups.end())
+        {
+            take(best->second, nb_resources, allocated);
+            placed = true;
+            break;
+        }
+    }
+    if (!placed)
+    {
+        // The job is larger than any group: fill the topmost groups, then the machines that are in no group
+        int nb_grouped_free = 0;
+        for (int root : _roots)
+            nb_grouped_free += _groups[root].nb_free;
+        int nb_from_groups = std::min(nb_resources, nb_grouped_free);
+        take(_roots, nb_from_groups, allocated);
+        if (nb_from_groups < nb_resources)
+            allocated += (_indexed - _grouped_machines).left(nb_resources - nb_from_groups);
+    }
+    PPK_ASSERT_ERROR(allocated.size() == (unsigned int)nb_resources);
+
+    update_free(allocated, -1);
+    _indexed -= allocated;
+    return true;
+}
+
+int TopologyResourceSelector::nb_groups_spanned(const IntervalSet &machines, int level) const
+{
+    std::set<int> groups;
+    for (auto it = machines.intervals_begin(); it != machines.intervals_end(); ++it)
+    {
+        for (int machine = it->lower(); machine <= it->upper() && machine < (int)_lowest_group.size(); ++machine)
+        {
+            int group = _lowest_group[machine];
+            while (group != -1 && _groups[group].level < level)
+                group = _groups[group].parent;
+            if (group != -1 && _groups[group].level == level)
+                groups.insert(group);
+        }
+    }
+    return (int)groups.size();
+}
+
+void TopologyResourceSelector::sync(const IntervalSet &available)
+{
+    if (!_index_valid)
+    {
+        update_free(available, 1);
+        _index_valid = true;
+    }
+    else if (available != _indexed)
+    {
+        update_free(_indexed - available, -1);
+        update_free(available - _indexed, 1);
+    }
+    _indexed = available;
+}
+
+void TopologyResourceSelector::update_free(const IntervalSet &machines, int delta)
+{
+    // The deltas are summed by lowest group first, so every group is updated once per call
+    std::vector<int> touched;
+    for (auto it = machines.intervals_begin(); it != machines.intervals_end(); ++it)
+    {
+        for (int machine = it->lower(); machine <= it->upper() && machine < (int)_lowest_group.size(); ++machine)
+        {
+            int group = _lowest_group[machine];
+            if (group == -1)
+                continue;
+            if (_pending[group] == 0)
+                touched.push_back(group);
+            _pending[group] += delta;
+        }
+    }
+
+    for (int lowest : touched)
+    {
+        int group_delta = _pending[lowest];
+        _pending[lowest] = 0;
+        for (int group = lowest; group != -1; group = _groups[group].parent)
+            set_free(group, _groups[group].nb_free + group_delta);
+    }
+}
+
+void TopologyResourceSelector::set_free(int group, int nb_free)
+{
+    auto & free_groups = _free_groups[_groups[group].level];
+    free_groups.erase(std::make_pair(_groups[group].nb_free, group));
+    _groups[group].nb_free = nb_free;
+    free_groups.insert(std::make_pair(nb_free, group));
+}
+
+void TopologyResourceSelector::take(const std::vector<int> &groups, int nb_resources, IntervalSet &allocated) const
+{
+    std::vector<int> by_free;
+    for (int group : groups)
+        if (_groups[group].nb_free > 0)
+            by_free.push_back(group);
+    std::sort(by_free.begin(), by_free.end(), [this](int a, int b)
+    {
+        return _groups[a].nb_free > _groups[b].nb_free || (_groups[a].nb_free == _groups[b].nb_free && a < b);
+    });
+
+    int remaining = nb_resources;
+    for (auto it = by_free.begin(); remaining > 0 && it != by_free.end(); ++it)
+    {
+        // The smallest of the remaining groups that can hold what is left ends the allocation
+        auto fits_end = std::partition_point(it, by_free.end(), [this, remaining](int group)
+        {
+            return _groups[group].nb_free >= remaining;
+        });
+        if (fits_end != it)
+        {
+            take(*std::prev(fits_end), remaining, allocated);
+            return;
+        }
+        take(*it, _groups[*it].nb_free, allocated);
+        remaining -= _groups[*it].nb_free;
+    }
+    PPK_ASSERT_ERROR(remaining <= 0, "Not enough free machines in the topology groups");
+}
+
+void TopologyResourceSelector::take(int group, int nb_resources, IntervalSet &allocated) const
+{
+    if (_groups[group].children.empty())
+        allocated += (_indexed & _groups[group].machines).left(nb_resources);
+    else
+        take(_groups[group].children, nb_resources, allocated);
+}
@@ -1,8 +1,55 @@
 #pragma once
 
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
 #include <intervalset.hpp>
+#include <rapidjson/document.h>
 struct Job;
 
+/**
+ * @brief The free contiguous blocks of a set of machines, indexed by size
+ * @details Blocks are kept both by lower bound (to split and coalesce them) and by (size, lower bound),
+ *          so that the smallest block that can hold a request is found in O(log(nb_blocks)).
+ */
+class FreeBlockIndex
+{
+public:
+    /** @brief Replaces the index content with the intervals of available */
+    void assign(const IntervalSet & available);
+    /**
+     * @brief Takes nb_resources machines from the smallest block that can hold them, lowest block first on ties
+     * @return false (and leaves the index untouched) if no block is large enough
+     */
+    bool best_fit(int nb_resources, IntervalSet & allocated);
+    /** @brief Removes machines from the index, splitting the blocks they belong to */
+    void remove(const IntervalSet & machines);
+    /** @brief Adds free machines to the index, coalescing them with their neighbouring blocks */
+    void insert(const IntervalSet & machines);
+
+    int nb_free() const { return _nb_free; }
+    int nb_blocks() const { return (int)_blocks.size(); }
+    int largest_block() const { return _by_size.empty() ? 0 : _by_size.rbegin()->first; }
+    /**
+     * @brief 1 - largest_block / nb_free: 0 when every free machine is in a single block (or none is free),
+     *        close to 1 when the free machines are scattered in small blocks
+     */
+    double fragmentation() const;
+    /** @brief The fragmentation of a set of machines, without building an index */
+    static double fragmentation(const IntervalSet & available);
+
+private:
+    void add_block(int lower, int upper);
+    void remove_block(std::map<int,int>::iterator block);
+
+private:
+    std::map<int,int> _blocks; //!< lower bound -> upper bound of every free block
+    std::set<std::pair<int,int>> _by_size; //!< (size, lower bound) of every free block
+    int _nb_free = 0;
+};
+
 class ResourceSelector
 {
 public:
@@ -58,3 +105,95 @@ public:
 public:
     IntervalSet _limited_range;
 };
+
+/**
+ * @brief Contiguous allocation in the smallest free block that can hold the job (best fit)
+ * @details The free blocks of the last available set fit() was called with are kept in a FreeBlockIndex.
+ *          An allocation is applied to the index, so the usual next call (with available minus the allocated
+ *          machines) finds it up to date. Any other available set, such as the next time slice of the schedule,
+ *          is brought in by removing and inserting the machines that differ from the indexed set: the blocks
+ *          elsewhere are kept, and the cost is that of two IntervalSet differences plus the blocks touched.
+ */
+class BestFitResourceSelector : public ContiguousResourceSelector
+{
+public:
+    BestFitResourceSelector();
+    ~BestFitResourceSelector();
+
+    bool fit(const Job * job, const IntervalSet & available, IntervalSet & allocated);
+
+    /** @brief The fragmentation of the available set of the last fit() */
+    double fragmentation() const { return _index.fragmentation(); }
+
+private:
+    FreeBlockIndex _index;
+    IntervalSet _indexed; //!< the available set _index currently describes
+    bool _index_valid = false;
+};
+
+/**
+ * @brief Allocations that span as few topology groups (switches, racks...) as possible
+ * @details The group hierarchy is given as levels, from the smallest groups to the largest:
+ *          @code{.json}
+ *          {"levels": [{"name": "switch", "groups": ["0-15", "16-31", "32-47", "48-63"]},
+ *                      {"name": "rack",   "groups": ["0-31", "32-63"]}]}
+ *          @endcode
+ *          Groups of a level are disjoint, and every group is the union of the groups of the previous level it
+ *          contains. Machines that are in no group are only used when the job does not fit in the groups.
+ *
+ *          A job goes in the group of the lowest level that can hold it, the one with the fewest free machines
+ *          that is large enough, found in O(log(nb_groups)) from the free counts of every group. Inside a group,
+ *          its subgroups are filled from the largest to the smallest, the last one being the smallest that fits.
+ *          The free counts describe the last available set fit() was called with. They are updated with the
+ *          machines that differ from it and with each allocation, never recomputed from scratch.
+ */
+class TopologyResourceSelector : public BasicResourceSelector
+{
+public:
+    TopologyResourceSelector(const rapidjson::Value & topology);
+    /** @brief Reads the topology from a JSON file */
+    TopologyResourceSelector(const std::string & topology_filepath);
+    ~TopologyResourceSelector();
+
+    bool fit(const Job * job, const IntervalSet & available, IntervalSet & allocated);
+
+    int nb_levels() const { return (int)_free_groups.size(); }
+    /** @brief The number of groups of the level that machines belong to */
+    int nb_groups_spanned(const IntervalSet & machines, int level) const;
+
+private:
+    struct Group
+    {
+        IntervalSet machines;
+        int level;
+        int parent = -1;
+        std::vector<int> children;
+        int nb_free = 0;
+    };
+
+    void load(const rapidjson::Value & topology);
+    /**
+     * @brief Brings the free counts from _indexed to available
+     * @details Costs the two IntervalSet differences between the sets, plus a visit of each machine that differs
+     *          and one O(log(nb_groups)) update per level for each lowest group they belong to.  The first call
+     *          counts every available machine.  Consecutive time slices usually differ by a few jobs, an allocation
+     *          by nothing.
+     */
+    void sync(const IntervalSet & available);
+    /** @brief Adds delta to the free count of the lowest group of every machine, then of their ancestors */
+    void update_free(const IntervalSet & machines, int delta);
+    void set_free(int group, int nb_free);
+    /** @brief Takes nb_resources free machines from the groups, filling the largest ones first */
+    void take(const std::vector<int> & groups, int nb_resources, IntervalSet & allocated) const;
+    void take(int group, int nb_resources, IntervalSet & allocated) const;
+
+private:
+    std::vector<Group> _groups;
+    std::vector<std::set<std::pair<int,int>>> _free_groups; //!< (nb_free, group) of every group, by level
+    std::vector<int> _roots; //!< the groups without parent
+    std::vector<int> _lowest_group; //!< machine id -> smallest group that contains it, -1 if none
+    IntervalSet _grouped_machines;
+    std::vector<int> _pending; //!< free count deltas of the groups during update_free
+    IntervalSet _indexed; //!< the available set the free counts describe
+    bool _index_valid = false;
+};
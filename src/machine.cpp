@@ -1,10 +1,16 @@
+#include <algorithm>
 #include "machine.hpp"
 #include "pempek_assert.hpp"
 #include <loguru.hpp>
-#include <regex>
 #include <string>
 #include "batsched_tools.hpp"
 
+namespace
+{
+    bool is_digit(char c) { return c >= '0' && c <= '9'; }
+    bool is_letter(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+}
+
 std::string Machine::to_json_string()
 {
     using namespace std;
@@ -34,7 +40,7 @@ void Machines::ingest(const rapidjson::Value &json)
   //first find the machine
   PPK_ASSERT_ERROR(json.HasMember("id"), "ingesting machines failed, no 'id' in json");
   int id = json["id"].GetInt();
-  Machine * machine = this->_machinesById[id];
+  Machine * machine = (*this)[id];
   //now we have the machine, time to update the things that change or could potentially change in the future
   //first check we have the right information
   PPK_ASSERT_ERROR(json.HasMember("speed"),"ingesting machines failed, no 'speed' in json");
@@ -50,23 +56,44 @@ void Machines::ingest(const rapidjson::Value &json)
   machine->cores_available = json["cores_available"].GetInt();
   //that should be it
 }
+Machines::Machines(const Machines & other) :
+    _nb_machines(other._nb_machines),
+    _prefixes(other._prefixes),
+    _prefix_ids(other._prefix_ids),
+    _core_percent(other._core_percent)
+{
+    _machines.resize(other._machines.size(), nullptr);
+    for (size_t id = 0; id < other._machines.size(); ++id)
+    {
+        if (other._machines[id] == nullptr)
+            continue;
+        _machines[id] = new Machine(*other._machines[id]);
+        _machinesM[_machines[id]->name] = _machines[id];
+    }
+    //the prefixes still point to the machines of other
+    for (Prefix & prefix : _prefixes)
+        for (Machine *& machine : prefix.machinesInPrefix)
+            machine = _machines[machine->id];
+}
 Machines::~Machines(){
-
+    for (Machine * machine : _machines)
+        delete machine;
 }
-Machine * Machines::operator[](std::string machine_name){
-    PPK_ASSERT_ERROR(_machinesM.count(machine_name) == 1, "Machine '%s' does not exist", machine_name.c_str());
-    return _machinesM.at(machine_name);
+Machine * Machines::operator[](const std::string & machine_name){
+    auto it = _machinesM.find(machine_name);
+    PPK_ASSERT_ERROR(it != _machinesM.end(), "Machine '%s' does not exist", machine_name.c_str());
+    return it->second;
 }
-Machine * Machines::operator[](int machine_number){
-    PPK_ASSERT_ERROR(_machinesById.count(machine_number) == 1,"Machine with id '%d' does not exist",machine_number);
-    return _machinesById[machine_number];
+Machine * Machines::operator()(const std::string & prefix_name, int machine_number)
+{
+    int id = prefix_id(prefix_name);
+    PPK_ASSERT_ERROR(id != -1,"Machine with prefix '%s' does not exist",prefix_name.c_str());
+    return (*this)(id,machine_number);
 }
-Machine * Machines::operator()(std::string prefix_name, int machine_number)
+int Machines::prefix_id(const std::string & prefix_name) const
 {
-    PPK_ASSERT_ERROR(_machinesByPrefix.count(prefix_name) == 1,"Machine with prefix '%s' does not exist",prefix_name.c_str());
-    Prefix * prefix=_machinesByPrefix.at(prefix_name);
-    PPK_ASSERT_ERROR(prefix->machinesInPrefix->count(machine_number) == 1, "There does not exist a Machine number '%d' in the prefix '%s'",machine_number,prefix_name.c_str());
-    return (*(prefix->machinesInPrefix))[machine_number];
+    auto it = _prefix_ids.find(prefix_name);
+    return it == _prefix_ids.end() ? -1 : it->second;
 }
 void Machines::set_core_percent(double core_percent)
 {
@@ -77,13 +104,15 @@ std::string Machines::to_json_string()
     std::string machines="{\n";
     machines+="\t\"_machines\":[\n\t\t";
     
-    std::map<int,Machine*>::iterator it;
-    for (it=_machinesById.begin();it!=_machinesById.end();)
+    bool first = true;
+    for (Machine * machine : _machines)
     {
-        machines += it->second->to_json_string();
-        it++;
-        if (it != _machinesById.end())
+        if (machine == nullptr)
+            continue;
+        if (!first)
             machines+=",\n\t\t";
+        first = false;
+        machines += machine->to_json_string();
     }
     machines+="\n\t]\n";
     machines+="}";
@@ -111,70 +140,66 @@ void Machines::add_machine_from_json_object(const rapidjson::Value & object){
     new_machine->id = object["id"].GetInt();
         
     
-    std::regex r(".*[a-zA-Z]+([0-9]+)");//all characters then at least one letter, then capture all numbers
-    //matches m[0](m[1])[not matched]  a30b(109)  @d(309)   b(12)   ab(309)[bc] 
+    //all characters then at least one letter, then all the numbers: the number starts after the last letter
+    //followed by a digit and runs to the first non-digit
+    //matches prefix(number)[ignored]  a30b(109)  @d(309)   b(12)   ab(309)[bc]
     //non-matches [1089]  --no characters
     //non-matches [bbb@], [ccbb]  --no numbers
-    
-    std::smatch m;
-    //std::regex_match(new_machine->name, m, r);
-    //new_machine->id = std::stoi(m.str(m.size()));
-    //new_machine->prefix = new_machine->name.substr(0,m.position(m.size()));
-    for(std::sregex_iterator i = std::sregex_iterator(new_machine->name.begin(), new_machine->name.end(), r);
-                            i != std::sregex_iterator();
-                            ++i )
+    const std::string & name = new_machine->name;
+    size_t number_begin = std::string::npos;
+    for (size_t i = name.size(); i-- > 1;)
     {
-        m = *i;
+        if (is_digit(name[i]) && is_letter(name[i-1]))
+        {
+            number_begin = i;
+            break;
+        }
     }
-    PPK_ASSERT_ERROR(m.size()==2,"Machine name should be any characters followed by at least one letter followed by numbers.  This should generate a regex match of size 2.  "
+    PPK_ASSERT_ERROR(number_begin != std::string::npos,"Machine name should be any characters, then at least one letter, then digits.  "
         "This is not the case with machine '%s'",new_machine->name.c_str());
-    new_machine->int_name = std::stoi(m[1]);
-    new_machine->prefix = new_machine->name.substr(0,m.position(1));
+    size_t number_end = number_begin;
+    while (number_end < name.size() && is_digit(name[number_end]))
+        number_end++;
+    new_machine->int_name = std::stoi(name.substr(number_begin,number_end-number_begin));
+    new_machine->prefix = name.substr(0,number_begin);
     new_machine->cores_available = int(new_machine->core_count * _core_percent);
     
 
 
     //ok we got the info, now add to containers
     //******************************************
-
-    _machinesM[new_machine->name] = new_machine; //all machines in a map.  Can get the machine if you know the machine name
-    _machinesById[new_machine->id]=new_machine;//all machines in a vector.  can get machines by index.
-    //_machinesByPrefix  // all machines separated by prefix name into maps separated by machine id.
-    //check if the prefix has already been made
-    if (_machinesByPrefix.count(new_machine->prefix) == 1)
-    {
-        //the prefix has already been made
-        //get the Prefix associated with that prefix and add the machine
-        Prefix * prefix=_machinesByPrefix.at(new_machine->prefix);
-        prefix->machineIds += new_machine->id;
-        prefix->machineIdsAvailable += new_machine->id;
-        
-        (*(prefix->machinesInPrefix))[new_machine->id]=new_machine;
-
-    }
-    else
+    PPK_ASSERT_ERROR(new_machine->id >= 0,"machine %s has a negative id",new_machine->name.c_str());
+    if (new_machine->id >= (int)_machines.size())
+        _machines.resize(new_machine->id + 1, nullptr);
+    PPK_ASSERT_ERROR(_machines[new_machine->id] == nullptr,"machine %s has the same id as machine %s",
+                     new_machine->name.c_str(),_machines[new_machine->id]->name.c_str());
+    _machines[new_machine->id] = new_machine; //all machines by id.  can get machines by index.
+    _nb_machines++;
+    _machinesM[new_machine->name] = new_machine; //all machines by name, for ingesting
+    //all machines separated by prefix, the prefix names are interned once here
+    auto prefix_it = _prefix_ids.find(new_machine->prefix);
+    if (prefix_it == _prefix_ids.end())
     {
-        //the prefix has not already been made
-        //make a new map and add the machine to that map
-        //then make a new prefix and add the map to the prefix
-        std::map<int,Machine *> * aMap = new std::map<int,Machine *>;
-        (*aMap)[new_machine->id]=new_machine;
-        Prefix * aPrefix = new Prefix;
-        aPrefix->machineIds = aPrefix->machineIdsAvailable = aPrefix->machineIdsUnavailable = IntervalSet::empty_interval_set();
-        aPrefix->repair_machines = IntervalSet::empty_interval_set();
-        aPrefix->machineIds += new_machine->id;
-        aPrefix->machineIdsAvailable += new_machine->id;
-        
-        aPrefix->machinesInPrefix = aMap;
-        _machinesByPrefix[new_machine->prefix]=aPrefix;
-
+        prefix_it = _prefix_ids.emplace(new_machine->prefix,(int)_prefixes.size()).first;
+        Prefix aPrefix;
+        aPrefix.name = new_machine->prefix;
+        aPrefix.machineIds = aPrefix.machineIdsAvailable = aPrefix.machineIdsUnavailable = IntervalSet::empty_interval_set();
+        aPrefix.repair_machines = IntervalSet::empty_interval_set();
+        _prefixes.push_back(aPrefix);
     }
+    new_machine->prefix_id = prefix_it->second;
+    Prefix & prefix = _prefixes[new_machine->prefix_id];
+    prefix.machineIds += new_machine->id;
+    prefix.machineIdsAvailable += new_machine->id;
+    //machines usually come in id order, keep the vector sorted when they don't
+    auto position = std::upper_bound(prefix.machinesInPrefix.begin(),prefix.machinesInPrefix.end(),new_machine,
+                                     [](const Machine * a, const Machine * b) { return a->id < b->id; });
+    prefix.machinesInPrefix.insert(position,new_machine);
 }
 void Machines::update_machine_from_json_object(const rapidjson::Value & object)
 {
     PPK_ASSERT_ERROR(object.HasMember("name"),"machine has no name");
-    std::string name;
-    Machine * new_machine = _machinesM[name];
+    Machine * new_machine = (*this)[std::string(object["name"].GetString())];
     PPK_ASSERT_ERROR(object.HasMember("cores_available"),"machine %s has no speed",new_machine->name.c_str());
     new_machine->cores_available = object["cores_available"].GetInt();
 }
@@ -3,11 +3,14 @@
 #define MACHINE_HPP
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <intervalset.hpp>
 
 #include <rapidjson/document.h>
 
+#include "pempek_assert.hpp"
+
 
 
 struct Machine{
@@ -16,6 +19,7 @@ struct Machine{
     std::string name;
     int int_name;
     std::string prefix;
+    int prefix_id = -1; //index of the prefix in Machines, interned when the machine is added
     int id;
     std::string role;
     int core_count = -1;
@@ -23,29 +27,63 @@ struct Machine{
     std::string to_json_string();
 };
 struct Prefix{
-    std::map<int,Machine *> * machinesInPrefix;
+    std::string name;
+    std::vector<Machine *> machinesInPrefix; //in id order
     IntervalSet machineIdsAvailable;
     IntervalSet machineIdsUnavailable;
     IntervalSet machineIds;
     IntervalSet repair_machines;
 
 };
+/**
+ * @brief All the machines of the platform, in a vector indexed by machine id
+ * @details Prefixes are interned to small integers when machines are added, so that looking a machine up by
+ * prefix and id is an indexed load and a comparison.  Looking machines up by name goes through a hash map,
+ * it is meant for ingesting, not for the scheduling loops.
+ */
 class Machines{
     public:
+            Machines() = default;
+            /**
+             * @brief Copies the machines of another platform, so that a platform built once can be used by several
+             * schedulers that each change the state of their machines
+             */
+            Machines(const Machines & other);
+            Machines & operator=(const Machines & other) = delete;
             ~Machines();
             void ingest(const rapidjson::Value & json);
-            Machine * operator[](std::string machine_name);
-            Machine * operator[](int machine_number);
-            Machine * operator()(std::string prefix_name,int machine_number);
+            Machine * operator[](const std::string & machine_name);
+            Machine * operator[](int machine_number)
+            {
+                PPK_ASSERT_ERROR(machine_number >= 0 && machine_number < (int)_machines.size() && _machines[machine_number] != nullptr,
+                                 "Machine with id '%d' does not exist",machine_number);
+                return _machines[machine_number];
+            }
+            Machine * operator()(const std::string & prefix_name,int machine_number);
+            Machine * operator()(int prefix_id,int machine_number)
+            {
+                Machine * machine = (*this)[machine_number];
+                PPK_ASSERT_ERROR(machine->prefix_id == prefix_id, "There does not exist a Machine number '%d' in the prefix #%d",
+                                 machine_number,prefix_id);
+                return machine;
+            }
+            /**
+             * @brief Returns the interned id of the prefix, -1 if no machine has it
+             */
+            int prefix_id(const std::string & prefix_name) const;
+            const Prefix & prefix(int prefix_id) const { return _prefixes[prefix_id]; }
+            int nb_prefixes() const { return (int)_prefixes.size(); }
+            int nb_machines() const { return _nb_machines; }
             void set_core_percent(double core_percent);
             void add_machine_from_json_object(const rapidjson::Value & object);
             void update_machine_from_json_object(const rapidjson::Value & object);
             std::string to_json_string();
     private:
-        std::map<std::string,Machine *> _machinesM; //machine by name
-        std::map<std::string,Prefix *> _machinesByPrefix;
-        // removed std::vector<Machine *> _machinesV; // a vector of all machines,not sure if useful.  machine id does not line up with vector index
-        std::map<int,Machine*> _machinesById;
+        std::vector<Machine *> _machines; //indexed by machine id, nullptr for the ids no machine has
+        int _nb_machines = 0;
+        std::unordered_map<std::string,Machine *> _machinesM; //machine by name
+        std::vector<Prefix> _prefixes; //indexed by prefix id
+        std::unordered_map<std::string,int> _prefix_ids;
         double _core_percent = 1.0;
 };
 
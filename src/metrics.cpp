@@ -0,0 +1,382 @@
+#include "metrics.hpp"
+
+#include <cstdio>
+
+#include <loguru.hpp>
+
+#include "pempek_assert.hpp"
+#include "external/batsched_profile.hpp"
+
+using namespace std;
+
+namespace
+{
+    //the computation amount a job brings to the queue, only known for parallel homogeneous profiles
+    double job_cpu(const Job * job)
+    {
+        const double SPEED = 1.0; //1 flop per second
+        if (job->profile == nullptr || job->profile->type != myBatsched::ProfileType::PARALLEL_HOMOGENEOUS)
+            return 0.0;
+        return static_cast<myBatsched::ParallelHomogeneousProfileData *>(job->profile->data)->cpu * SPEED;
+    }
+}
+
+MetricsFormat::MetricsFormat(const string & name, const string & file) :
+    _name(name), _file(file.empty() ? "metrics_" + name + ".csv" : file)
+{
+}
+
+MetricsFormat::~MetricsFormat()
+{
+}
+
+MetricsFormat * MetricsFormat::make(const string & name, const string & file)
+{
+    if (name == "events")
+        return new EventsMetricsFormat(file);
+    if (name == "state")
+        return new StateMetricsFormat(file);
+    if (name == "counters")
+        return new CountersMetricsFormat(file);
+    return nullptr;
+}
+
+const vector<string> & MetricsFormat::names()
+{
+    static const vector<string> names = {"events", "state", "counters"};
+    return names;
+}
+
+void MetricsFormat::on_event(const MetricsObserver & observer, MetricsEvent event, const Job * job, double date)
+{
+    (void) observer;
+    (void) event;
+    (void) job;
+    (void) date;
+}
+
+MetricsObserver::MetricsObserver(Workload * workload, Queue * queue, const Schedule * schedule) :
+    _workload(workload), _queue(queue), _schedule(schedule)
+{
+}
+
+MetricsObserver::~MetricsObserver()
+{
+    for (MetricsFormat * format : _formats)
+        delete format;
+    _formats.clear();
+}
+
+void MetricsObserver::add_format(MetricsFormat * format)
+{
+    for (const MetricsFormat * other : _formats)
+        PPK_ASSERT_ERROR(other->file() != format->file(), "Two metrics formats write to '%s'", format->file().c_str());
+    _formats.push_back(format);
+    _has_periodic_formats = _has_periodic_formats || format->periodic();
+}
+
+bool MetricsObserver::has_format(const string & name) const
+{
+    for (const MetricsFormat * format : _formats)
+        if (format->name() == name)
+            return true;
+    return false;
+}
+
+void MetricsObserver::open(b_log * log, const string & output_folder, bool append)
+{
+    _log = log;
+    for (MetricsFormat * format : _formats)
+    {
+        //the file is the log type: it is unique among the formats
+        _log->add_log_file(output_folder + "/" + format->file(), format->file(),
+                           append ? blog_open_method::APPEND : blog_open_method::OVERWRITE, true, format->separator());
+        if (!append)
+            _log->add_header(format->file(), format->header());
+    }
+}
+
+void MetricsObserver::notify(MetricsEvent event, const Job * job, double date)
+{
+    for (MetricsFormat * format : _formats)
+        format->on_event(*this, event, job, date);
+}
+
+bool MetricsObserver::remove_from_queue(const Job * job)
+{
+    auto queued = _queued.find(job);
+    if (queued == _queued.end())
+        return false;
+    _queued_nodes -= job->nb_requested_resources;
+    _queued_cpu -= queued->second.cpu;
+    _queued_node_seconds -= queued->second.node_seconds;
+    _queued.erase(queued);
+    return true;
+}
+
+bool MetricsObserver::remove_from_running(const Job * job)
+{
+    auto running = _running.find(job);
+    if (running == _running.end())
+        return false;
+    _used_machines -= job->nb_requested_resources;
+    _running.erase(running);
+    return true;
+}
+
+void MetricsObserver::on_job_submitted(const string & job_id, double date)
+{
+    const Job * job = (*_workload)[job_id];
+    QueuedJob queued;
+    queued.cpu = job_cpu(job);
+    queued.node_seconds = job->nb_requested_resources * job->walltime.convert_to<double>();
+    if (!_queued.emplace(job, queued).second)
+        return;
+    _queued_nodes += job->nb_requested_resources;
+    _queued_cpu += queued.cpu;
+    _queued_node_seconds += queued.node_seconds;
+    notify(MetricsEvent::SUBMITTED, job, date);
+}
+
+void MetricsObserver::on_job_started(const string & job_id, double date)
+{
+    const Job * job = (*_workload)[job_id];
+    if (!_running.emplace(job, date).second)
+        return;
+    //jobs restored as running from a checkpoint were never queued here
+    if (remove_from_queue(job))
+    {
+        _total_waiting_time += date - job->submission_time;
+        ++_nb_started;
+    }
+    _used_machines += job->nb_requested_resources;
+    notify(MetricsEvent::STARTED, job, date);
+}
+
+void MetricsObserver::on_job_ended(const string & job_id, double date)
+{
+    const Job * job = (*_workload)[job_id];
+    //the notify goes first so that the formats can still read the start date of the job
+    auto running = _running.find(job);
+    if (running == _running.end())
+        return;
+    _used_machines -= job->nb_requested_resources;
+    ++_nb_finished;
+    notify(MetricsEvent::ENDED, job, date);
+    _running.erase(job);
+}
+
+void MetricsObserver::on_job_killed(const string & job_id, double date)
+{
+    const Job * job = (*_workload)[job_id];
+    if (!remove_from_running(job))
+        return;
+    ++_nb_killed;
+    notify(MetricsEvent::KILLED, job, date);
+}
+
+void MetricsObserver::on_job_rejected(const string & job_id, double date)
+{
+    const Job * job = (*_workload)[job_id];
+    remove_from_queue(job);
+    ++_nb_rejected;
+    notify(MetricsEvent::REJECTED, job, date);
+}
+
+void MetricsObserver::on_deferred_decisions_made(double delay)
+{
+    ++_nb_delayed_decisions;
+    _total_decision_delay += delay;
+    if (delay > _max_decision_delay)
+        _max_decision_delay = delay;
+}
+
+double MetricsObserver::start_date(const Job * job) const
+{
+    auto running = _running.find(job);
+    return running == _running.end() ? -1 : running->second;
+}
+
+void MetricsObserver::flush(double date)
+{
+    if (_log == nullptr)
+        return;
+    for (MetricsFormat * format : _formats)
+        if (!format->periodic())
+            format->flush(*this, _log, date);
+    if (!_has_periodic_formats)
+        return;
+    if (_next_sample < 0)
+    {
+        _next_sample = date + _period;
+        return;
+    }
+    if (date < _next_sample)
+        return;
+    for (MetricsFormat * format : _formats)
+        if (format->periodic())
+            format->flush(*this, _log, date);
+    //a quiet simulation can jump over several sampling dates, they are not written twice
+    while (_next_sample <= date)
+        _next_sample += _period;
+}
+
+void MetricsObserver::discard()
+{
+    for (MetricsFormat * format : _formats)
+        format->discard();
+}
+
+double MetricsObserver::next_sample_date() const
+{
+    return _has_periodic_formats ? _next_sample : -1;
+}
+
+string EventsMetricsFormat::header() const
+{
+    return "simulated_time_index,trigger_event,job_id,req_nodes,walltime,runtime,arrival_time,start_time,end_time,"
+           "nb_jobs_in_queue,work_in_queue,utilization,queue";
+}
+
+void EventsMetricsFormat::on_event(const MetricsObserver & observer, MetricsEvent event, const Job * job, double date)
+{
+    Row row;
+    row.job = job;
+    row.start = -1.0;
+    row.end = -1.0;
+    row.nb_jobs_in_queue = observer.nb_jobs_in_queue();
+    row.work_in_queue = observer.queued_cpu() * observer.queued_nodes();
+    row.utilization = observer.utilization();
+    switch (event)
+    {
+        case MetricsEvent::SUBMITTED:
+            _arrivals.push_back(row);
+            break;
+        case MetricsEvent::STARTED:
+            row.start = date;
+            _starts.push_back(row);
+            break;
+        case MetricsEvent::ENDED:
+            row.start = observer.start_date(job);
+            row.end = date;
+            _ends.push_back(row);
+            break;
+        default:
+            break;
+    }
+}
+
+void EventsMetricsFormat::discard()
+{
+    _arrivals.clear();
+    _starts.clear();
+    _ends.clear();
+}
+
+void EventsMetricsFormat::flush(const MetricsObserver & observer, b_log * log, double date)
+{
+    if (_arrivals.empty() && _starts.empty() && _ends.empty())
+        return;
+    //the queue column is the same for every row of the batch: the predicted starts once the decisions are made
+    observer.schedule()->compute_predicted_runs(_predicted_runs);
+    string queue_string = "[";
+    int queue_count = 0;
+    for (auto job_it = observer.queue()->begin(); job_it != observer.queue()->end(); ++job_it)
+    {
+        const Job * job = (*job_it)->job;
+        auto run = _predicted_runs.find(job);
+        if (run == _predicted_runs.end())
+            continue;
+        queue_string += batsched_tools::string_format("%s{\"jb\":\"%s\",\"st\":%f}", queue_count == 0 ? "" : ",",
+                                                      job->id.c_str(), run->second.start.convert_to<double>());
+        queue_count++;
+        if (queue_count == observer.queue_depth())
+            break;
+    }
+    queue_string += "]";
+
+    const char * triggers[] = {"A", "S", "E"};
+    const vector<Row> * batches[] = {&_arrivals, &_starts, &_ends};
+    for (int i = 0; i < 3; ++i)
+    {
+        for (const Row & row : *batches[i])
+        {
+            FILE * file = log->begin_row(_file, date);
+            if (file == nullptr)
+                break;
+            double runtime = row.end < 0 ? -1.0 : row.end - row.start;
+            std::fprintf(file, "%s,%s,%d,%f,%f,%f,%f,%f,%d,%f,%f,%s",
+                         triggers[i], row.job->id.c_str(), row.job->nb_requested_resources,
+                         row.job->walltime.convert_to<double>(), runtime, row.job->submission_time, row.start, row.end,
+                         row.nb_jobs_in_queue, row.work_in_queue, row.utilization, queue_string.c_str());
+            log->end_row(_file);
+        }
+    }
+    discard();
+}
+
+void StateMetricsFormat::flush(const MetricsObserver & observer, b_log * log, double date)
+{
+    FILE * row = log->begin_row(_file, date);
+    if (row == nullptr)
+        return;
+    //import into pandas as 'df = pd.read_csv("file.csv",sep=";",header=0)'
+    //and json as myjson = json.loads(df["state"].values[<hour>])["running"||"queued"][<index>]["id"||"start"||"stop"]
+    std::fprintf(row, "%d;{\"running\":[", int(date / observer.period()));
+    //the stop of every running job and the start of every queued job come from a single pass over the schedule
+    observer.schedule()->compute_predicted_runs(_predicted_runs);
+    bool first = true;
+    for (const auto & running : observer.running_jobs())
+    {
+        const Job * job = running.first;
+        //variants without a schedule, and jobs killed but not yet reported as such, are not in the schedule
+        auto run = _predicted_runs.find(job);
+        Rational end_time = run != _predicted_runs.end() ? run->second.end : Rational(running.second) + job->walltime;
+        std::fprintf(row, "%s{\"id\":%d,\"stop\":%f}", first ? "" : ",",
+                     batsched_tools::get_job_parts(job->id).job_number, end_time.convert_to<double>());
+        first = false;
+    }
+    std::fputs("],\"queued\":[", row);
+    first = true;
+    int queue_count = 0;
+    for (auto job_it = observer.queue()->begin(); job_it != observer.queue()->end(); ++job_it)
+    {
+        const Job * job = (*job_it)->job;
+        auto run = _predicted_runs.find(job);
+        if (run != _predicted_runs.end())
+        {
+            Rational start_time = run->second.start;
+            Rational end_time = start_time + job->walltime;
+            std::fprintf(row, "%s{\"id\":%d,\"start\":%f,\"stop\":%f}", first ? "" : ",",
+                         batsched_tools::get_job_parts(job->id).job_number,
+                         start_time.convert_to<double>(), end_time.convert_to<double>());
+            first = false;
+        }
+        queue_count++;
+        if (queue_count == observer.queue_depth())
+            break;
+    }
+    std::fputs("]}", row);
+    log->end_row(_file);
+}
+
+string CountersMetricsFormat::header() const
+{
+    return "simulated_time,nb_jobs_in_queue,queued_nodes,queued_node_seconds,nb_running_jobs,used_machines,"
+           "utilization,nb_finished_jobs,nb_killed_jobs,nb_rejected_jobs,mean_waiting_time,nb_deferred_decisions,"
+           "mean_decision_delay,max_decision_delay";
+}
+
+void CountersMetricsFormat::flush(const MetricsObserver & observer, b_log * log, double date)
+{
+    FILE * row = log->begin_row(_file, date);
+    if (row == nullptr)
+        return;
+    std::fprintf(row, "%d,%f,%f,%d,%d,%f,%ld,%ld,%ld,%f,%ld,%f,%f",
+                 observer.nb_jobs_in_queue(), observer.queued_nodes(), observer.queued_node_seconds(),
+                 observer.nb_running_jobs(), observer.used_machines(), observer.utilization(),
+                 observer.nb_finished_jobs(), observer.nb_killed_jobs(), observer.nb_rejected_jobs(),
+                 observer.mean_waiting_time(), observer.nb_deferred_decisions(), observer.mean_decision_delay(),
+                 observer.max_decision_delay());
+    log->end_row(_file);
+}
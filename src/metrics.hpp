@@ -0,0 +1,237 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "json_workload.hpp"
+#include "queue.hpp"
+#include "schedule.hpp"
+#include "batsched_tools.hpp"
+
+class MetricsObserver;
+
+/**
+ * @brief The job events a MetricsObserver is fed with
+ */
+enum class MetricsEvent
+{
+    SUBMITTED, //!< the job entered the queue
+    STARTED,   //!< the job was executed
+    ENDED,     //!< the job completed
+    KILLED,    //!< the job was killed while running
+    REJECTED   //!< the job left the queue without running
+};
+
+/**
+ * @brief An output format of a MetricsObserver, written to its own csv file
+ * @details A format either writes rows for the events of a batch (on_event then flush once the decisions of the
+ *          batch are made) or is periodic and writes a row on each sampling date of the observer.
+ */
+class MetricsFormat
+{
+public:
+    /**
+     * @param[in] name The name of the format, as given in the 'metrics' variant option
+     * @param[in] file The file the format writes to, relative to the output folder.  metrics_<name>.csv if empty
+     */
+    MetricsFormat(const std::string & name, const std::string & file = "");
+    virtual ~MetricsFormat();
+
+    /**
+     * @brief Builds the format called name, nullptr if there is no such format
+     */
+    static MetricsFormat * make(const std::string & name, const std::string & file = "");
+    /** @brief The names make() knows */
+    static const std::vector<std::string> & names();
+
+    const std::string & name() const { return _name; }
+    const std::string & file() const { return _file; }
+    virtual std::string header() const = 0;
+    virtual std::string separator() const { return ","; }
+    virtual bool periodic() const { return false; }
+
+    /** @brief Called on every event, once the counters of the observer account for it */
+    virtual void on_event(const MetricsObserver & observer, MetricsEvent event, const Job * job, double date);
+    /** @brief Forgets the events seen since the last flush */
+    virtual void discard() {}
+    /** @brief Writes the rows of the events of the batch, or the row of the sampling date for periodic formats */
+    virtual void flush(const MetricsObserver & observer, b_log * log, double date) = 0;
+
+protected:
+    std::string _name;
+    std::string _file;
+};
+
+/**
+ * @brief Job counters maintained incrementally from job events, written through pluggable formats
+ * @details Every event is O(1): the observer never walks the queue or the schedule to maintain its counters.
+ *          Only the formats that print the queue ('events' and 'state') look at the schedule, once per flush.
+ */
+class MetricsObserver
+{
+public:
+    /**
+     * @param[in] workload The workload the job ids are looked up in
+     * @param[in] queue The queue of the algorithm, for the formats that print the queued jobs
+     * @param[in] schedule The schedule of the algorithm, for the predicted start of the queued jobs
+     */
+    MetricsObserver(Workload * workload, Queue * queue, const Schedule * schedule);
+    ~MetricsObserver();
+
+    /** @brief Takes ownership of format.  Two formats can not write to the same file */
+    void add_format(MetricsFormat * format);
+    bool has_format(const std::string & name) const;
+    void set_nb_machines(int nb_machines) { _nb_machines = nb_machines; }
+    /** @brief The simulated time between two rows of the periodic formats */
+    void set_period(double period) { _period = period; }
+    /**
+     * @brief Opens the file of every format in output_folder
+     * @param[in] append Whether the rows go after the ones of a previous run (start from checkpoint)
+     */
+    void open(b_log * log, const std::string & output_folder, bool append);
+
+    void on_job_submitted(const std::string & job_id, double date);
+    void on_job_started(const std::string & job_id, double date);
+    void on_job_ended(const std::string & job_id, double date);
+    void on_job_killed(const std::string & job_id, double date);
+    void on_job_rejected(const std::string & job_id, double date);
+    /** @brief A message was deferred to the end of a decision quantum */
+    void on_decisions_deferred() { ++_nb_deferred_decisions; }
+    /** @brief The deferred messages were decided, delay after the first of them */
+    void on_deferred_decisions_made(double delay);
+
+    /**
+     * @brief Writes the event rows of the batch, and the periodic rows if a sampling date has been reached
+     * @details The first call sets the first sampling date, one period later
+     */
+    void flush(double date);
+    /** @brief Drops the event rows of the batch (while recovering from a checkpoint) */
+    void discard();
+    /** @brief The date the periodic formats want to be flushed next, -1 if there are none */
+    double next_sample_date() const;
+
+    int nb_jobs_in_queue() const { return (int)_queued.size(); }
+    double queued_nodes() const { return _queued_nodes; }
+    double queued_cpu() const { return _queued_cpu; }
+    double queued_node_seconds() const { return _queued_node_seconds; }
+    int nb_running_jobs() const { return (int)_running.size(); }
+    int used_machines() const { return _used_machines; }
+    double utilization() const { return _nb_machines > 0 ? (double)_used_machines / _nb_machines : 0.0; }
+    long nb_finished_jobs() const { return _nb_finished; }
+    long nb_killed_jobs() const { return _nb_killed; }
+    long nb_rejected_jobs() const { return _nb_rejected; }
+    double mean_waiting_time() const { return _nb_started > 0 ? _total_waiting_time / _nb_started : 0.0; }
+    long nb_deferred_decisions() const { return _nb_deferred_decisions; }
+    /** @brief The mean and max delay between a deferred message and its decision, over the delayed decisions */
+    double mean_decision_delay() const { return _nb_delayed_decisions > 0 ? _total_decision_delay / _nb_delayed_decisions : 0.0; }
+    double max_decision_delay() const { return _max_decision_delay; }
+    /** @brief The date job started at, -1 if it is not running */
+    double start_date(const Job * job) const;
+    /** @brief The running jobs with their start date, in no particular order */
+    const std::unordered_map<const Job *, double> & running_jobs() const { return _running; }
+
+    Queue * queue() const { return _queue; }
+    const Schedule * schedule() const { return _schedule; }
+    int queue_depth() const { return _workload->_queue_depth; }
+    double period() const { return _period; }
+
+private:
+    //what a queued job adds to the queue counters, kept as the walltime of a job can change while it waits
+    struct QueuedJob
+    {
+        double cpu;
+        double node_seconds;
+    };
+
+    void notify(MetricsEvent event, const Job * job, double date);
+    bool remove_from_queue(const Job * job);
+    bool remove_from_running(const Job * job);
+
+private:
+    Workload * _workload;
+    Queue * _queue;
+    const Schedule * _schedule;
+    b_log * _log = nullptr;
+    std::vector<MetricsFormat *> _formats;
+    bool _has_periodic_formats = false;
+    int _nb_machines = 0;
+    double _period = 3600;
+    double _next_sample = -1;
+
+    std::unordered_map<const Job *, QueuedJob> _queued;
+    std::unordered_map<const Job *, double> _running; //!< running job -> start date
+    double _queued_nodes = 0;
+    double _queued_cpu = 0;
+    double _queued_node_seconds = 0;
+    int _used_machines = 0;
+    long _nb_started = 0;
+    long _nb_finished = 0;
+    long _nb_killed = 0;
+    long _nb_rejected = 0;
+    double _total_waiting_time = 0;
+    long _nb_deferred_decisions = 0;
+    long _nb_delayed_decisions = 0;
+    double _total_decision_delay = 0;
+    double _max_decision_delay = 0;
+};
+
+/**
+ * @brief One row per job event: A(rrival), S(tart) and E(nd), with the queue counters right after the event
+ *        and the predicted start of the first queued jobs
+ * @details The predicted starts come from the schedule of the variant: the queue column is always empty for the
+ *          variants that keep no schedule (easy_bf_fast2, fcfs_fast2, easy_bf3...)
+ */
+class EventsMetricsFormat : public MetricsFormat
+{
+public:
+    EventsMetricsFormat(const std::string & file = "") : MetricsFormat("events", file) {}
+    std::string header() const;
+    void on_event(const MetricsObserver & observer, MetricsEvent event, const Job * job, double date);
+    void discard();
+    void flush(const MetricsObserver & observer, b_log * log, double date);
+
+private:
+    struct Row
+    {
+        const Job * job;
+        double start;
+        double end;
+        int nb_jobs_in_queue;
+        double work_in_queue;
+        double utilization;
+    };
+    std::vector<Row> _arrivals, _starts, _ends;
+    std::unordered_map<const Job *, Schedule::PredictedRun> _predicted_runs; //kept between flushes so its buckets are reused
+};
+
+/**
+ * @brief One row per period with the running jobs and their stop, and the queued jobs with their predicted
+ *        start and stop, as a json object
+ * @details The stops and starts come from the schedule of the variant.  A running job missing from it stops at
+ *          its start plus its walltime, and the queued jobs are always empty for the variants that keep no schedule
+ */
+class StateMetricsFormat : public MetricsFormat
+{
+public:
+    StateMetricsFormat(const std::string & file = "") : MetricsFormat("state", file) {}
+    std::string header() const { return "sim_time;hour;state"; }
+    std::string separator() const { return ";"; }
+    bool periodic() const { return true; }
+    void flush(const MetricsObserver & observer, b_log * log, double date);
+
+private:
+    std::unordered_map<const Job *, Schedule::PredictedRun> _predicted_runs;
+};
+
+/**
+ * @brief One row per period with the counters of the observer only, O(1) per row
+ */
+class CountersMetricsFormat : public MetricsFormat
+{
+public:
+    CountersMetricsFormat(const std::string & file = "") : MetricsFormat("counters", file) {}
+    std::string header() const;
+    bool periodic() const { return true; }
+    void flush(const MetricsObserver & observer, b_log * log, double date);
+};
@@ -15,6 +15,13 @@
 
 using namespace std;
 
+Network::Network(zmq::context_t * context) :
+    _context(context)
+{
+    if (_context == nullptr)
+        _context = _own_context = new zmq::context_t;
+}
+
 Network::~Network()
 {
     if (_socket != nullptr)
@@ -22,11 +29,12 @@ Network::~Network()
         delete _socket;
         _socket = nullptr;
     }
+    delete _own_context;
 }
 
 void Network::bind(const std::string &socket_endpoint)
 {
-    _socket = new zmq::socket_t(_context, ZMQ_REP);
+    _socket = new zmq::socket_t(*_context, ZMQ_REP);
     _socket->bind(socket_endpoint);
 }
 
@@ -29,13 +29,24 @@ namespace network
 class Network
 {
 public:
+    /**
+     * @brief Creates an unbound network
+     * @param[in] context The ZMQ context of the socket, shared by the sockets of a server.  The network creates its own
+     *            one if nullptr
+     */
+    explicit Network(zmq::context_t * context = nullptr);
     ~Network();
+    Network(const Network &) = delete;
+    Network & operator=(const Network &) = delete;
 
     void bind(const std::string & socket_endpoint);
     void write(const std::string & content);
     void read(std::string & received_content);
+    /** @brief The bound socket, to poll several networks at once */
+    zmq::socket_t & socket() { return *_socket; }
 
 private:
-    zmq::context_t _context;
+    zmq::context_t * _own_context = nullptr;
+    zmq::context_t * _context = nullptr;
     zmq::socket_t * _socket = nullptr;
 };
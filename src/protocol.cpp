@@ -491,4 +491,9 @@ double JsonProtocolWriter::last_date()
     return _last_date;
 }
 
+const rapidjson::Value & JsonProtocolWriter::current_events() const
+{
+    return _events;
+}
+
 AbstractProtocolWriter::~AbstractProtocolWriter() {}
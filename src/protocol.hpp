@@ -158,6 +158,12 @@ public:
      * @return The latest date that has been set in the events
      */
     virtual double last_date() = 0;
+
+    /**
+     * @brief Returns the events pushed since the last call to clear, as a JSON array
+     * @return The events pushed since the last call to clear.  Consumed by generate_current_message
+     */
+    virtual const rapidjson::Value & current_events() const = 0;
 };
 
 /**
@@ -312,6 +318,12 @@ public:
      */
     double last_date();
 
+    /**
+     * @brief Returns the events pushed since the last call to clear, as a JSON array
+     * @return The events pushed since the last call to clear.  Consumed by generate_current_message
+     */
+    const rapidjson::Value & current_events() const;
+
 private:
     bool _is_empty = true; //!< Stores whether events have been pushed into the writer since last clear.
     double _last_date = -1; //!< The date of the latest pushed event/message
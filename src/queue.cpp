@@ -257,6 +257,8 @@ void Queue::append_job(const Job *job, SortableJobOrder::UpdateInformation *upda
     sjob->job = job;
     sjob->release_dates = job->submission_times;
     sjob->release_date = update_info->current_date;
+    sjob->load = job->nb_requested_resources * job->walltime;
+    _load += sjob->load;
 
     _jobs.push_back(sjob);
 }
@@ -276,6 +278,7 @@ std::list<SortableJob *>::iterator Queue::remove_job(const Job *job)
 std::list<SortableJob *>::iterator Queue::remove_job(std::list<SortableJob *>::iterator job_it)
 {
     SortableJob * sjob = *job_it;
+    _load -= sjob->load;
     delete sjob;
 
     return _jobs.erase(job_it);
@@ -283,6 +286,7 @@ std::list<SortableJob *>::iterator Queue::remove_job(std::list<SortableJob *>::i
 void Queue::clear()
 {
     _jobs.clear();
+    _load = 0;
 }
 
 void Queue::sort_queue(SortableJobOrder::UpdateInformation *update_info,
@@ -362,17 +366,7 @@ int Queue::nb_jobs() const
 
 Rational Queue::compute_load_estimation() const
 {
-    Rational load = 0;
-
-    for (auto queue_it = _jobs.begin(); queue_it != _jobs.end(); ++queue_it)
-    {
-        const SortableJob * sjob = *queue_it;
-        const Job * job = sjob->job;
-
-        load += job->nb_requested_resources * job->walltime;
-    }
-
-    return load;
+    return _load;
 }
 
 std::string Queue::to_string() const
@@ -418,6 +412,7 @@ std::list<SortableJob *>::const_iterator Queue::end() const
 Queue& Queue::operator=(const Queue&  other){
     _order = other._order;
     _jobs = other._jobs;
+    _load = other._load;
     return *this;
     
 }
@@ -9,6 +9,7 @@ struct Job;
 struct SortableJob
 {
     const Job * job;
+    Rational load; //!< requested resources x walltime when the job was queued
     Rational release_date;
     std::vector<double> release_dates;
     Rational slowdown;
@@ -134,6 +135,9 @@ public:
 
     bool is_empty() const;
     int nb_jobs() const;
+    /**
+     * @brief The sum of requested resources x walltime of the queued jobs, maintained on insertion and removal
+     */
     Rational compute_load_estimation() const;
     void clear();
 
@@ -150,4 +154,5 @@ public:
 private:
     std::list<SortableJob *> _jobs;
     SortableJobOrder * _order;
+    Rational _load = 0;
 };
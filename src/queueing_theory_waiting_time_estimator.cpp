@@ -1,54 +1,61 @@
 #include "queueing_theory_waiting_time_estimator.hpp"
 
+#include <limits>
+
 #include "pempek_assert.hpp"
 
 void QueueingTheoryWaitingTimeEstimator::add_submitted_job(const Job *job)
 {
-    _recently_submitted_jobs.push_back(job);
+    Submission submission;
+    submission.date = job->submission_time;
+    submission.area = job->nb_requested_resources * job->walltime;
+    _submitted_area += submission.area;
+    _submitted.push_back(submission);
 }
 
 void QueueingTheoryWaitingTimeEstimator::add_completed_job(const Job *job)
 {
-    _recently_completed_jobs.push_back(job);
+    _completed.push_back(job->completion_time);
 }
 
 void QueueingTheoryWaitingTimeEstimator::remove_old(Rational old_date_thresh)
 {
-    for (auto submit_lit = _recently_submitted_jobs.begin(); submit_lit != _recently_submitted_jobs.end(); )
+    while (!_submitted.empty() && _submitted.front().date < old_date_thresh)
     {
-        const Job * job = *submit_lit;
-        if (job->submission_time < old_date_thresh)
-            submit_lit = _recently_submitted_jobs.erase(submit_lit);
-        else
-            break;
+        _submitted_area -= _submitted.front().area;
+        _submitted.pop_front();
     }
 
-    for (auto complete_lit = _recently_completed_jobs.begin(); complete_lit != _recently_completed_jobs.end(); )
-    {
-        const Job * job = *complete_lit;
-        if (job->completion_time < old_date_thresh)
-            complete_lit = _recently_completed_jobs.erase(complete_lit);
-        else
-            break;
-    }
+    while (!_completed.empty() && _completed.front() < old_date_thresh)
+        _completed.pop_front();
 }
 
-Rational QueueingTheoryWaitingTimeEstimator::estimate_waiting_time(Rational period_length)
+double QueueingTheoryWaitingTimeEstimator::estimate_waiting_time(Rational period_length) const
 {
     PPK_ASSERT_ERROR(period_length > 0);
-    Rational arrival_rate = _recently_submitted_jobs.size() / period_length;
-    Rational service_rate = _recently_completed_jobs.size() / period_length;
+    Rational arrival_rate = _submitted.size() / period_length;
+    Rational service_rate = _completed.size() / period_length;
 
-    if (arrival_rate != service_rate && service_rate != 0)
-        return (1/(service_rate-arrival_rate)) - (1/service_rate);
+    if (service_rate > arrival_rate)
+        return (double)((1/(service_rate-arrival_rate)) - (1/service_rate));
     else
-        return std::numeric_limits<Rational>::infinity();
+        return std::numeric_limits<double>::infinity();
 }
 
-Rational QueueingTheoryWaitingTimeEstimator::estimate_waiting_time_by_area(Rational period_length, int nb_awake_machines)
+double QueueingTheoryWaitingTimeEstimator::estimate_waiting_time_by_area(Rational period_length, int nb_awake_machines) const
 {
-    (void) period_length;
-    (void) nb_awake_machines;
-    PPK_ASSERT_ERROR(false, "Not implemented");
-    return 0;
+    PPK_ASSERT_ERROR(period_length > 0);
+    PPK_ASSERT_ERROR(nb_awake_machines >= 0);
+    if (_submitted.empty())
+        return 0;
+    if (nb_awake_machines == 0)
+        return std::numeric_limits<double>::infinity();
+
+    // The awake machines are one server processing nb_awake_machines units of area per second
+    Rational utilization = _submitted_area / (period_length * nb_awake_machines);
+    if (utilization >= 1)
+        return std::numeric_limits<double>::infinity();
+
+    Rational mean_service_time = _submitted_area / (_submitted.size() * nb_awake_machines);
+    return (double)(utilization / (1 - utilization) * mean_service_time);
 }
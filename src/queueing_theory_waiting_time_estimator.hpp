@@ -1,20 +1,90 @@
 #pragma once
 
-#include <list>
+#include <vector>
 
 #include "json_workload.hpp"
 #include "exact_numbers.hpp"
 
+/**
+ * @brief A FIFO of values kept in a growable circular array: no allocation per push once the capacity is reached
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+    bool empty() const { return _size == 0; }
+    int size() const { return (int)_size; }
+    const T & front() const { return _items[_head]; }
+
+    void push_back(const T & item)
+    {
+        if (_size == _items.size())
+            grow();
+        _items[(_head + _size) % _items.size()] = item;
+        ++_size;
+    }
+
+    void pop_front()
+    {
+        _head = (_head + 1) % _items.size();
+        --_size;
+    }
+
+private:
+    void grow()
+    {
+        std::vector<T> items(_items.empty() ? 16 : 2 * _items.size());
+        for (size_t i = 0; i < _size; ++i)
+            items[i] = _items[(_head + i) % _items.size()];
+        _items.swap(items);
+        _head = 0;
+    }
+
+private:
+    std::vector<T> _items;
+    size_t _head = 0;
+    size_t _size = 0;
+};
+
+/**
+ * @brief Estimates the waiting time of new jobs from the jobs submitted and completed in a sliding window
+ * @details Jobs must be added in date order.  The window only keeps their dates and the running sum of their
+ *          areas, so that adding a job, sliding the window and estimating are all O(1) (amortized for remove_old).
+ */
 struct QueueingTheoryWaitingTimeEstimator
 {
     void add_submitted_job(const Job * job);
     void add_completed_job(const Job * job);
 
+    /**
+     * @brief Slides the window: forgets the jobs submitted (resp. completed) before old_date_thresh
+     */
     void remove_old(Rational old_date_thresh);
-    Rational estimate_waiting_time(Rational period_length);
-    Rational estimate_waiting_time_by_area(Rational period_length, int nb_awake_machines);
+    /**
+     * @brief The M/M/1 waiting time of the job arrival and completion rates over the last period_length seconds
+     * @return infinity if the jobs arrive at least as fast as they complete
+     */
+    double estimate_waiting_time(Rational period_length) const;
+    /**
+     * @brief The M/M/1 waiting time of the work (requested resources x walltime) submitted over the last
+     *        period_length seconds, served by nb_awake_machines machines
+     * @return 0 without submissions, infinity if the work arrives at least as fast as the machines can process it
+     */
+    double estimate_waiting_time_by_area(Rational period_length, int nb_awake_machines) const;
+
+    int nb_submitted_jobs() const { return _submitted.size(); }
+    int nb_completed_jobs() const { return _completed.size(); }
+    /** @brief The sum of requested resources x walltime of the submitted jobs in the window */
+    const Rational & submitted_area() const { return _submitted_area; }
 
 private:
-    std::list<const Job *> _recently_submitted_jobs;
-    std::list<const Job *> _recently_completed_jobs;
+    struct Submission
+    {
+        double date;
+        Rational area;
+    };
+
+    RingBuffer<Submission> _submitted;
+    RingBuffer<double> _completed;
+    Rational _submitted_area = 0;
 };
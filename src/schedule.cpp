@@ -1,4 +1,5 @@
 #include "schedule.hpp"
+#include <algorithm>
 #include <cstdlib>
 #include <vector>
 
@@ -87,9 +88,11 @@ void Schedule::incorrect_call_me_later(double difference)
     //we increased the walltime to 1 second larger than a reservation's run time so there should be enough padding for when the reservation ends
     //but we need to take care of the first time slice's end and also the next time slice's begin
     auto slice = _profile.begin();
+    journal_slice(slice);
     slice->end+=difference;
     slice->length+=difference;
     slice++;
+    journal_slice(slice);
     slice->begin+=difference;
     slice->length-=difference;
 
@@ -121,10 +124,13 @@ std::set<std::string> Schedule::get_jobs_that_should_have_been_submitted_already
 }
 void Schedule::ingest_schedule(const rapidjson::Document & doc)
 {
+    PPK_ASSERT_ERROR(!in_transaction(), "Schedule::ingest_schedule is not supported inside a transaction");
        
     using namespace rapidjson;
     //let's clear the schedule
     _profile.clear();
+    ++_revision;
+    free_area_changed();
     
     PPK_ASSERT_ERROR(doc.HasMember("Schedule"),"Trying to ingest schedule from checkpoint, but there is no 'Schedule' key");
     const Value & schedule = doc["Schedule"];
@@ -277,6 +283,9 @@ Schedule::TimeSlice Schedule::TimeSlice_from_json(const rapidjson::Value & Vslic
     {
         slice.allocated_jobs = JobMap_from_json(VTimeSlice["allocated_jobs"].GetArray(),slice.begin);
         slice.allocated_machines = IntervalSet::from_string_hyphen(VTimeSlice["allocated_machines"].GetString());
+        for (const auto & job_interval_pair : slice.allocated_jobs)
+            if (job_interval_pair.first->purpose == "reservation")
+                slice.nb_reservation_machines += job_interval_pair.second.size();
     }
     
     slice.has_reservation = VTimeSlice["has_reservation"].GetBool();
@@ -423,10 +432,13 @@ bool Schedule::remove_svg_highlight_machines(IntervalSet machines)
         return false;
 }
 IntervalSet Schedule::add_repair_machine(IntervalSet machine,double duration){
+    PPK_ASSERT_ERROR(!in_transaction(), "Schedule::add_repair_machine is not supported inside a transaction");
     //first add the repair machines to our IntervalSet
     IntervalSet added = machine - _repair_machines;
     int number_added = added.size();
     _repair_machines+=machine;
+    ++_revision;
+    free_area_changed();
     if(!added.is_empty())
     {
         
@@ -488,9 +500,12 @@ IntervalSet Schedule::add_repair_machines_as_job(IntervalSet machines,double dur
 //This function will remove the given machines that are in _repair_machines
 //It will also add back those machines that are not allocated to each time slice
 IntervalSet Schedule::remove_repair_machines(IntervalSet machines){
+    PPK_ASSERT_ERROR(!in_transaction(), "Schedule::remove_repair_machines is not supported inside a transaction");
     IntervalSet removed = _repair_machines & machines;
     _repair_machines-=machines;
     int number_removed = removed.size();
+    ++_revision;
+    free_area_changed();
     if (!removed.is_empty())
     {
         for (auto slice_it = _profile.begin();slice_it!=_profile.end();++slice_it)
@@ -545,7 +560,7 @@ double Schedule::get_utilization(){
 double Schedule::get_utilization_no_resv(){
     //if first slice has reservations take those machines out of the equation
     if (_profile.begin()->has_reservation){
-        int resv_machines = get_machines_running_reservations().size();
+        int resv_machines = _profile.begin()->nb_reservation_machines;
         return double(get_number_of_running_machines()-resv_machines)/double(_nb_machines);
     }
     else
@@ -672,7 +687,11 @@ IntervalSet Schedule::get_machines_running_reservations_on_slice(TimeSliceIterat
 }
 Schedule &Schedule::operator=(const Schedule &other)
 {
+    PPK_ASSERT_ERROR(!in_transaction(), "Cannot assign a schedule that is in a transaction");
     _profile = other._profile;
+    //the revision of other describes the new profile, not the prefix this schedule may have built
+    _revision = other._revision;
+    free_area_changed();
     _nb_machines = other._nb_machines;
     _output_number = other._output_number;
     _colors = other._colors;
@@ -680,6 +699,204 @@ Schedule &Schedule::operator=(const Schedule &other)
     return *this;
 }
 
+void Schedule::begin_transaction()
+{
+    Savepoint savepoint;
+    savepoint.undo_log_size = _undo_log.size();
+    savepoint.size = _size;
+    savepoint.nb_reservations_size = _nb_reservations_size;
+    savepoint.nb_jobs_size = _nb_jobs_size;
+    savepoint.smallest_time_slice_length = _smallest_time_slice_length;
+    savepoint.largest_time_slice_length = _largest_time_slice_length;
+    //the new level must journal the slices and jobs again, even those the enclosing level already journaled
+    savepoint.journaled_slices = std::move(_journaled_slices);
+    savepoint.journaled_jobs = std::move(_journaled_jobs);
+    _journaled_slices.clear();
+    _journaled_jobs.clear();
+    _savepoints.push_back(std::move(savepoint));
+}
+
+void Schedule::commit()
+{
+    PPK_ASSERT_ERROR(!_savepoints.empty(), "Cannot commit: the schedule is not in a transaction");
+    Savepoint & savepoint = _savepoints.back();
+    if (_savepoints.size() == 1)
+    {
+        _undo_log.clear();
+        _journaled_slices.clear();
+        _journaled_jobs.clear();
+        _erased_slices.clear();
+    }
+    else
+    {
+        //the enclosing transaction takes over the undo entries, only the journaled sets are merged back
+        savepoint.journaled_slices.insert(_journaled_slices.begin(), _journaled_slices.end());
+        savepoint.journaled_jobs.insert(_journaled_jobs.begin(), _journaled_jobs.end());
+        _journaled_slices = std::move(savepoint.journaled_slices);
+        _journaled_jobs = std::move(savepoint.journaled_jobs);
+    }
+    _savepoints.pop_back();
+}
+
+void Schedule::rollback()
+{
+    PPK_ASSERT_ERROR(!_savepoints.empty(), "Cannot rollback: the schedule is not in a transaction");
+    ++_revision;
+    Savepoint & savepoint = _savepoints.back();
+    while (_undo_log.size() > savepoint.undo_log_size)
+    {
+        UndoEntry & entry = _undo_log.back();
+        switch (entry.type)
+        {
+        case UndoEntry::Type::SLICE_MODIFIED:
+            //the begin of the first slice may have moved since it was journaled
+            free_area_changed(*(entry.slice));
+            free_area_changed(entry.old_slice);
+            *(entry.slice) = std::move(entry.old_slice);
+            break;
+        case UndoEntry::Type::SLICE_INSERTED:
+            free_area_changed(*(entry.slice));
+            _profile.erase(entry.slice);
+            break;
+        case UndoEntry::Type::SLICE_ERASED:
+            free_area_changed(*(entry.slice));
+            _profile.splice(entry.next, _erased_slices, entry.slice);
+            break;
+        case UndoEntry::Type::JOB_ALLOCATIONS:
+        {
+            //the allocations made during the transaction are only referenced by the job
+            std::unordered_set<JobAlloc *> new_allocs;
+            for (auto & alloc : entry.job->allocations)
+                new_allocs.insert(alloc.second);
+            for (auto & alloc : entry.old_allocations)
+                new_allocs.erase(alloc.second);
+            for (JobAlloc * alloc : new_allocs)
+                delete alloc;
+            entry.job->allocations = std::move(entry.old_allocations);
+            break;
+        }
+        }
+        _undo_log.pop_back();
+    }
+    _size = savepoint.size;
+    _nb_reservations_size = savepoint.nb_reservations_size;
+    _nb_jobs_size = savepoint.nb_jobs_size;
+    _smallest_time_slice_length = savepoint.smallest_time_slice_length;
+    _largest_time_slice_length = savepoint.largest_time_slice_length;
+    _journaled_slices = std::move(savepoint.journaled_slices);
+    _journaled_jobs = std::move(savepoint.journaled_jobs);
+    _savepoints.pop_back();
+    if (_savepoints.empty())
+        PPK_ASSERT_ERROR(_erased_slices.empty());
+}
+
+bool Schedule::in_transaction() const
+{
+    return !_savepoints.empty();
+}
+
+int Schedule::transaction_depth() const
+{
+    return (int)_savepoints.size();
+}
+
+void Schedule::journal_slice(TimeSliceIterator slice, bool free_area_changes)
+{
+    ++_revision;
+    if (free_area_changes)
+        free_area_changed(*slice);
+    if (_savepoints.empty() || !_journaled_slices.insert(&(*slice)).second)
+        return;
+    UndoEntry entry;
+    entry.type = UndoEntry::Type::SLICE_MODIFIED;
+    entry.slice = slice;
+    entry.old_slice = *slice;
+    _undo_log.push_back(std::move(entry));
+}
+
+void Schedule::journal_inserted_slice(TimeSliceIterator slice)
+{
+    ++_revision;
+    free_area_changed(*slice);
+    if (_savepoints.empty())
+        return;
+    //an inserted slice has no state to restore, it is simply erased on rollback
+    _journaled_slices.insert(&(*slice));
+    UndoEntry entry;
+    entry.type = UndoEntry::Type::SLICE_INSERTED;
+    entry.slice = slice;
+    _undo_log.push_back(std::move(entry));
+}
+
+void Schedule::journal_job_allocations(const Job * job)
+{
+    if (_savepoints.empty() || !_journaled_jobs.insert(job).second)
+        return;
+    UndoEntry entry;
+    entry.type = UndoEntry::Type::JOB_ALLOCATIONS;
+    entry.job = job;
+    entry.old_allocations = job->allocations;
+    _undo_log.push_back(std::move(entry));
+}
+
+Schedule::TimeSliceIterator Schedule::erase_slice(TimeSliceIterator slice)
+{
+    ++_revision;
+    free_area_changed(*slice);
+    if (_savepoints.empty())
+        return _profile.erase(slice);
+    auto next = slice;
+    ++next;
+    UndoEntry entry;
+    entry.type = UndoEntry::Type::SLICE_ERASED;
+    entry.slice = slice;
+    entry.next = next;
+    //splicing keeps the slice (and iterators to it) alive until the transaction ends
+    _erased_slices.splice(_erased_slices.end(), _profile, slice);
+    _undo_log.push_back(std::move(entry));
+    return next;
+}
+
+void Schedule::merge_split_slice(TimeSliceIterator first_slice_after_split)
+{
+    PPK_ASSERT_ERROR(_savepoints.empty(), "Schedule::merge_split_slice is for changes that are not journaled");
+    auto second_slice_after_split = first_slice_after_split;
+    ++second_slice_after_split;
+    PPK_ASSERT_ERROR(second_slice_after_split != _profile.end()
+                     && second_slice_after_split->begin == first_slice_after_split->end);
+    free_area_changed(*first_slice_after_split);
+    first_slice_after_split->end = second_slice_after_split->end;
+    first_slice_after_split->length = first_slice_after_split->end - first_slice_after_split->begin;
+    erase_slice(second_slice_after_split);
+}
+
+void Schedule::free_area_changed(const TimeSlice & slice)
+{
+    if (!_free_area_stale || slice.begin < _free_area_stale_from)
+    {
+        _free_area_stale = true;
+        _free_area_stale_from = slice.begin;
+    }
+}
+
+void Schedule::free_area_changed()
+{
+    _free_area_begins.clear();
+    _free_area_prefix.clear();
+    _free_area_machines.clear();
+    _free_area_stale = true;
+}
+
+void Schedule::free_area_first_slice_truncated(Rational old_begin)
+{
+    if (_free_area_begins.empty() || (_free_area_stale && _free_area_stale_from <= old_begin))
+        return;
+    //the free area up to the end of every slice is the same from the origin: only the origin moves
+    double begin = (double)_profile.begin()->begin;
+    _free_area_origin += _free_area_machines[0] * (begin - _free_area_begins[0]);
+    _free_area_begins[0] = begin;
+}
+
 void Schedule::update_first_slice(Rational current_time)
 {
     
@@ -693,8 +910,10 @@ void Schedule::update_first_slice(Rational current_time)
         current_time <= (slice->end+epsilon), "current_time=%g, slice->end=%g", (double)current_time, (double)slice->end+epsilon);
 
     Rational old_time = slice->begin;
+    journal_slice(slice, false);
     slice->begin = current_time;
     slice->length = slice->end - slice->begin;
+    free_area_first_slice_truncated(old_time);
     //LOG_F(INFO,"allocated_jobs.size: %d, old time: %.15f",slice->allocated_jobs.size(),old_time.convert_to<double>());
     for (auto it = slice->allocated_jobs.begin(); it != slice->allocated_jobs.end(); ++it)
     {
@@ -706,6 +925,7 @@ void Schedule::update_first_slice(Rational current_time)
 
         if (alloc_it != job_ref->allocations.end() && old_time != current_time)
         {
+            journal_job_allocations(job_ref);
             //LOG_F(INFO,"update: job_id: %s,current_time: %.15f",job_ref->id.c_str(),current_time.convert_to<double>());
             job_ref->allocations[current_time] = alloc_it->second;
             job_ref->allocations.erase(alloc_it);
@@ -722,8 +942,9 @@ void Schedule::update_first_slice_removing_remaining_jobs(Rational current_time)
         current_time >= slice->begin, "current_time=%g, slice->begin=%g", (double)current_time, (double)slice->begin);
 
     while (current_time >= slice->end)
-        slice = _profile.erase(slice);
+        slice = erase_slice(slice);
 
+    journal_slice(slice);
     slice->begin = current_time;
     slice->length = slice->end - slice->begin;
 }
@@ -904,6 +1125,27 @@ void Schedule::find_least_impactful_fit(JobAlloc* alloc,TimeSliceIterator begin_
 Schedule::ReservedTimeSlice Schedule::reserve_time_slice(const Job* job){
     if (_debug)
         output_to_svg("top reserve_time_slice " + job->id);
+    //the slices are split while probing, a failed probe leaves the schedule as it found it.
+    //Inside a transaction the probe is a savepoint of it, otherwise the splits are merged back:
+    //journaling the split slices would copy them for nothing once the reservation is placed
+    const bool journaled = in_transaction();
+    if (journaled)
+        begin_transaction();
+    std::vector<TimeSliceIterator> splits;
+    Rational smallest_time_slice_length = _smallest_time_slice_length;
+    Rational largest_time_slice_length = _largest_time_slice_length;
+    auto undo_probe = [&]()
+    {
+        if (journaled)
+        {
+            rollback();
+            return;
+        }
+        for (auto split = splits.rbegin(); split != splits.rend(); ++split)
+            merge_split_slice(*split);
+        _smallest_time_slice_length = smallest_time_slice_length;
+        _largest_time_slice_length = largest_time_slice_length;
+    };
     
     // Let's create the job allocation
     JobAlloc *alloc = new JobAlloc;
@@ -937,7 +1179,8 @@ Schedule::ReservedTimeSlice Schedule::reserve_time_slice(const Job* job){
         Rational split_date = job->start;
         if(_debug)
             output_to_svg("Before split slice " + job->id);
-        split_slice(slice_begin,split_date,first_slice_after_split,second_slice_after_split);
+        if (split_slice(slice_begin,split_date,first_slice_after_split,second_slice_after_split))
+            splits.push_back(first_slice_after_split);
         if (_debug)
             output_to_svg("After split slice " + job->id);
         LOG_F(INFO,"DEBUG line 306");
@@ -966,7 +1209,8 @@ Schedule::ReservedTimeSlice Schedule::reserve_time_slice(const Job* job){
         split_date = job->start+job->walltime;
         if (_debug)
             output_to_svg("Before split slice "+job->id);
-        split_slice(slice_end,split_date,first_slice_after_split,second_slice_after_split);
+        if (split_slice(slice_end,split_date,first_slice_after_split,second_slice_after_split))
+            splits.push_back(first_slice_after_split);
         if(_debug)
             output_to_svg("After split slice "+job->id);
         LOG_F(INFO,"DEBUG line 322");
@@ -1014,7 +1258,10 @@ LOG_F(INFO,"DEBUG line 331 %s",alloc->used_machines.to_string_hyphen().c_str());
                     {
                         if (!first_slice_is_suspect || (job->walltime != _profile.begin()->end))
                         {
+                            undo_probe();
                             reserved->success = false;
+                            reserved->slice_begin = _profile.end();
+                            reserved->slice_end = _profile.end();
                             return *reserved;
                         }
                         else
@@ -1043,6 +1290,17 @@ LOG_F(INFO,"DEBUG line 331 %s",alloc->used_machines.to_string_hyphen().c_str());
             reserved->success = false;
         
         reserved->job = job;
+        if (reserved->success)
+        {
+            if (journaled)
+                commit();
+        }
+        else
+        {
+            undo_probe();
+            reserved->slice_begin = _profile.end();
+            reserved->slice_end = _profile.end();
+        }
 
         //now return the reserved time slice
         //will need to act on the object to make it part of the schedule
@@ -1068,11 +1326,12 @@ void Schedule::add_reservation(ReservedTimeSlice reservation){
         {
           //  LOG_F(INFO,"DEBUG line 398");
             //LOG_F(INFO,"used machines %s",reservation.alloc->used_machines.to_string_hyphen().c_str());
+            journal_slice(slice_it);
             slice_it->available_machines -= reservation.alloc->used_machines;
             slice_it->allocated_machines += reservation.alloc->used_machines;
             //LOG_F(INFO,"DEBUG line 399+1");
             slice_it->nb_available_machines -= job->nb_requested_resources;
-            slice_it->allocated_jobs[job] = reservation.alloc->used_machines;
+            slice_it->allocate_job(job, reservation.alloc->used_machines);
             //LOG_F(INFO,"DEBUG line 402+1");
             slice_it->has_reservation = true;
             //LOG_F(INFO,"DEBUG line 404+1");
@@ -1188,6 +1447,7 @@ JobAlloc Schedule::add_current_reservation_after_time_slice(const Job *job,
                     alloc->end = alloc->begin + job->walltime;
                     alloc->started_in_first_slice = (pit == _profile.begin()) ? true : false;
                     alloc->job = job;
+                    journal_job_allocations(job);
                     job->allocations[beginning] = alloc;
 
                     // Let's split the current time slice if needed
@@ -1197,10 +1457,11 @@ JobAlloc Schedule::add_current_reservation_after_time_slice(const Job *job,
                     split_slice(pit, split_date, first_slice_after_split, second_slice_after_split);
                     
                     // Let's remove the allocated machines from the available machines of the time slice
+                    journal_slice(first_slice_after_split);
                     first_slice_after_split->available_machines.remove(alloc->used_machines);
                     first_slice_after_split->allocated_machines.insert(alloc->used_machines);
                     first_slice_after_split->nb_available_machines -= job->nb_requested_resources;
-                    first_slice_after_split->allocated_jobs[job] = alloc->used_machines;
+                    first_slice_after_split->allocate_job(job, alloc->used_machines);
                     first_slice_after_split->nb_reservations++;
                     if (first_slice_after_split->nb_reservations == 1) 
                         first_slice_after_split->has_reservation = true; //should only need to do this when first adding a reservation(nb_reservations == 1)
@@ -1246,19 +1507,21 @@ JobAlloc Schedule::add_current_reservation_after_time_slice(const Job *job,
                             alloc->end = alloc->begin + job->walltime;
                             alloc->started_in_first_slice = (pit == _profile.begin()) ? true : false;
                             alloc->job = job;
+                            journal_job_allocations(job);
                             job->allocations[alloc->begin] = alloc;
 
                             // Let's remove the used machines from the slices before pit2
                             auto pit3 = pit;
                             for (; pit3 != pit2; ++pit3)
                             {
+                                journal_slice(pit3);
                                 //if some of the machines are repair machines then they won't be in available machines
                                 //the intersection of available_machines and used machines tells us how many machines to subtract from nb_available_machines
                                 int subtract = (pit3->available_machines & alloc->used_machines).size();
                                 pit3->available_machines -= alloc->used_machines;
                                 pit3->allocated_machines += alloc->used_machines;
                                 pit3->nb_available_machines -= subtract;
-                                pit3->allocated_jobs[job] = alloc->used_machines;
+                                pit3->allocate_job(job, alloc->used_machines);
                                 pit3->nb_reservations++;
                             if (pit3->nb_reservations == 1)//means a reservation has been added
                                 pit3->has_reservation = true;
@@ -1271,11 +1534,12 @@ JobAlloc Schedule::add_current_reservation_after_time_slice(const Job *job,
                             split_slice(pit2, split_date, first_slice_after_split, second_slice_after_split);
 
                             // Let's remove the allocated machines from the available machines of the time slice
+                            journal_slice(first_slice_after_split);
                             int subtract = (first_slice_after_split->available_machines & alloc->used_machines).size();
                             first_slice_after_split->available_machines -= alloc->used_machines;
                             first_slice_after_split->allocated_machines += alloc->used_machines;
                             first_slice_after_split->nb_available_machines -= subtract;
-                            first_slice_after_split->allocated_jobs[job] = alloc->used_machines;
+                            first_slice_after_split->allocate_job(job, alloc->used_machines);
 
                             if (_debug)
                             {
@@ -1344,6 +1608,7 @@ bool Schedule::remove_reservations_if_ready(std::vector<const Job *>& jobs_remov
                             return false;
                         //we are removing the reservation from this next time slice so the next
                         //time slice has its number of reservations decreased
+                        journal_slice(slice);
                         if (slice->nb_reservations > 0)
                             slice->nb_reservations--;
                         //reservations will be removed, push this reservation.
@@ -1422,6 +1687,7 @@ JobAlloc Schedule::add_job_first_fit_after_time_slice(const Job *job,
                     alloc->started_in_first_slice = (pit == _profile.begin()) ? true : false;
                     alloc->job = job;
                     LOG_F(INFO,"job id: %s, beginning: %.15f, alloc: %s",job->id.c_str(),beginning.convert_to<double>(),alloc->used_machines.to_string_hyphen().c_str());
+                    journal_job_allocations(job);
                     job->allocations[beginning] = alloc;
                     
     
@@ -1433,10 +1699,11 @@ JobAlloc Schedule::add_job_first_fit_after_time_slice(const Job *job,
                     split_slice(pit, split_date, first_slice_after_split, second_slice_after_split);
 
                     // Let's remove the allocated machines from the available machines of the time slice
+                    journal_slice(first_slice_after_split);
                     first_slice_after_split->available_machines.remove(alloc->used_machines);
                     first_slice_after_split->allocated_machines.insert(alloc->used_machines);
                     first_slice_after_split->nb_available_machines -= job->nb_requested_resources;
-                    first_slice_after_split->allocated_jobs[job] = alloc->used_machines;
+                    first_slice_after_split->allocate_job(job, alloc->used_machines);
 
                     if (_debug)
                     {
@@ -1488,6 +1755,7 @@ JobAlloc Schedule::add_job_first_fit_after_time_slice(const Job *job,
                             alloc->end = alloc->begin + job->walltime;
                             alloc->started_in_first_slice = (pit == _profile.begin()) ? true : false;
                             alloc->job = job;
+                            journal_job_allocations(job);
                             job->allocations[alloc->begin] = alloc;
                             //LOG_F(INFO,"allocWXYZ:job id: %s  alloc: %s",job->id.c_str(),alloc->used_machines.to_string_hyphen().c_str());
 
@@ -1495,10 +1763,11 @@ JobAlloc Schedule::add_job_first_fit_after_time_slice(const Job *job,
                             auto pit3 = pit;
                             for (; pit3 != pit2; ++pit3)
                             {
+                                journal_slice(pit3);
                                 pit3->available_machines -= alloc->used_machines;
                                 pit3->allocated_machines += alloc->used_machines;
                                 pit3->nb_available_machines -= job->nb_requested_resources;
-                                pit3->allocated_jobs[job] = alloc->used_machines;
+                                pit3->allocate_job(job, alloc->used_machines);
                                 //LOG_F(INFO,"allocXYZ:job id: %s  alloc: %s timeslice: %f",job->id.c_str(),alloc->used_machines.to_string_hyphen().c_str(),pit3->begin.convert_to<double>());
                             }
 
@@ -1509,10 +1778,11 @@ JobAlloc Schedule::add_job_first_fit_after_time_slice(const Job *job,
                             split_slice(pit2, split_date, first_slice_after_split, second_slice_after_split);
 
                             // Let's remove the allocated machines from the available machines of the time slice
+                            journal_slice(first_slice_after_split);
                             first_slice_after_split->available_machines -= alloc->used_machines;
                             first_slice_after_split->allocated_machines += alloc->used_machines;
                             first_slice_after_split->nb_available_machines -= job->nb_requested_resources;
-                            first_slice_after_split->allocated_jobs[job] = alloc->used_machines;
+                            first_slice_after_split->allocate_job(job, alloc->used_machines);
 
                             if (_debug)
                             {
@@ -1674,6 +1944,52 @@ Rational Schedule::finite_horizon() const
     return it->begin;
 }
 
+double Schedule::liquid_load_date(double area, double starting_time) const
+{
+    if (_free_area_stale)
+    {
+        //the entries of the slices before the first one that changed are kept
+        size_t nb_kept = std::lower_bound(_free_area_begins.begin(), _free_area_begins.end(),
+                                          (double)_free_area_stale_from) - _free_area_begins.begin();
+        PPK_ASSERT_ERROR(nb_kept <= _profile.size());
+        _free_area_begins.resize(nb_kept);
+        _free_area_prefix.resize(nb_kept);
+        _free_area_machines.resize(nb_kept);
+        if (nb_kept == 0)
+            _free_area_origin = 0;
+        double prefix = nb_kept == 0 ? _free_area_origin : _free_area_prefix.back();
+        for (auto slice = std::next(_profile.begin(), nb_kept); slice != _profile.end(); ++slice)
+        {
+            //available_machines rather than nb_available_machines, which does not follow current reservations
+            int nb_machines = (int)slice->available_machines.size();
+            double begin = (double)slice->begin;
+            prefix += nb_machines * ((double)slice->end - begin);
+            _free_area_begins.push_back(begin);
+            _free_area_prefix.push_back(prefix);
+            _free_area_machines.push_back(nb_machines);
+        }
+        _free_area_stale = false;
+    }
+
+    if (area <= 0)
+        return starting_time;
+    // The slice starting_time is in, and the free area the profile has before starting_time
+    auto after_start = std::upper_bound(_free_area_begins.begin(), _free_area_begins.end(), starting_time);
+    PPK_ASSERT_ERROR(after_start != _free_area_begins.begin(), "starting_time=%g is before the schedule", starting_time);
+    size_t first = (after_start - _free_area_begins.begin()) - 1;
+    double before_first = first == 0 ? _free_area_origin : _free_area_prefix[first - 1];
+    double target = before_first + _free_area_machines[first] * (starting_time - _free_area_begins[first]) + area;
+
+    // The first slice by the end of which the area is processed
+    auto reached = std::lower_bound(_free_area_prefix.begin() + first, _free_area_prefix.end(), target);
+    // Degenerate case: all the machines are probably in a sleep state
+    if (reached == _free_area_prefix.end())
+        return (double)infinite_horizon();
+    size_t last = reached - _free_area_prefix.begin();
+    double before_last = last == 0 ? _free_area_origin : _free_area_prefix[last - 1];
+    return _free_area_begins[last] + (target - before_last) / _free_area_machines[last];
+}
+
 Rational Schedule::infinite_horizon() const
 {
     PPK_ASSERT_ERROR(_profile.size() > 0);
@@ -1762,6 +2078,7 @@ bool Schedule::split_slice(Schedule::TimeSliceIterator slice_to_split, Rational
     {
         // The split must be done.
         // Let's create the new slice
+        journal_slice(slice_to_split);
         TimeSlice new_slice = *slice_to_split;
 
         new_slice.begin = date;
@@ -1782,6 +2099,7 @@ bool Schedule::split_slice(Schedule::TimeSliceIterator slice_to_split, Rational
 
         // Let's update returned iterators
         second_slice_after_split = _profile.insert(list_insert_it, new_slice);
+        journal_inserted_slice(second_slice_after_split);
         first_slice_after_split = second_slice_after_split;
         --first_slice_after_split;
         LOG_F(INFO,"slice split, first:%f   second:%f",first_slice_after_split->end.convert_to<double>(),second_slice_after_split->end.convert_to<double>());
@@ -1878,6 +2196,20 @@ Schedule::TimeSliceConstIterator Schedule::find_last_occurence_of_job(
         return _profile.end();
 }
 
+void Schedule::compute_predicted_runs(std::unordered_map<const Job *, PredictedRun> & runs) const
+{
+    runs.clear();
+    for (const TimeSlice & slice : _profile)
+    {
+        for (const auto & job_machines : slice.allocated_jobs)
+        {
+            auto inserted = runs.emplace(job_machines.first, PredictedRun{slice.begin, slice.end});
+            if (!inserted.second)
+                inserted.first->second.end = slice.end;
+        }
+    }
+}
+
 Schedule::TimeSliceIterator Schedule::find_last_time_slice_before_date(Rational date, bool assert_not_found)
 {
     PPK_ASSERT_ERROR(_profile.size() > 0);
@@ -2575,6 +2907,7 @@ void Schedule::remove_job_internal(const Job *job, Schedule::TimeSliceIterator r
     PPK_ASSERT_ERROR(removal_point->allocated_jobs.count(job) == 1);
     IntervalSet job_machines = removal_point->allocated_jobs.at(job);
     //lets make sure we delete the current allocations from the job
+    journal_job_allocations(job);
     job->allocations.clear();
     //LOG_F(INFO," current allocated machines %s \n current repair machines inside remove_job_internal %s",
       //      job_machines.to_string_hyphen().c_str(),
@@ -2609,8 +2942,10 @@ void Schedule::remove_job_internal(const Job *job, Schedule::TimeSliceIterator r
     for (auto pit = removal_point; pit != _profile.end(); ++pit)
     {
         // If the job was succesfully erased from the current slice (the job was in it)
-        if (pit->allocated_jobs.erase(job) == 1)
+        if (pit->contains_job(job))
         {
+            journal_slice(pit);
+            pit->deallocate_job(job);
             pit->available_machines.insert(job_machines);
             pit->allocated_machines.remove(job_machines);
             pit->nb_available_machines += job_machines.size();
@@ -2653,13 +2988,15 @@ void Schedule::remove_job_internal(const Job *job, Schedule::TimeSliceIterator r
                     
 
                     // pit is updated to ensure --pit points to a valid location after erasure
-                    pit = _profile.erase(previous);
+                    pit = erase_slice(previous);
                 }
             }
 
             // Let's iterate the slices while the job is in it, and erase it
-            for (++pit; pit != _profile.end() && pit->allocated_jobs.erase(job) == 1; ++pit)
+            for (++pit; pit != _profile.end() && pit->contains_job(job); ++pit)
             {
+                journal_slice(pit);
+                pit->deallocate_job(job);
                 pit->available_machines.insert(job_machines);
                 pit->allocated_machines.remove(job_machines);
                 pit->nb_available_machines += job_machines.size();
@@ -2700,7 +3037,7 @@ void Schedule::remove_job_internal(const Job *job, Schedule::TimeSliceIterator r
                         set_smallest_and_largest_time_slice_length(pit->length);
 
                         // pit is updated to ensure --pit points to a valid location after erasure
-                        pit = _profile.erase(previous);
+                        pit = erase_slice(previous);
                     }
                 }
             }
@@ -2730,6 +3067,7 @@ void Schedule::remove_job_internal(const Job *job, Schedule::TimeSliceIterator r
                 if ((previous->allocated_jobs == pit->allocated_jobs) || (previousString == pitString ))
                     {
                         LOG_F(INFO,"TRUE 2732");
+                        journal_slice(pit);
                         PPK_ASSERT_ERROR(previous->available_machines == pit->available_machines,
                             "Two consecutive time slices, do NOT use the same resources "
                             "whereas they contain the same jobs. Slices:\n%s%s",
@@ -2740,7 +3078,7 @@ void Schedule::remove_job_internal(const Job *job, Schedule::TimeSliceIterator r
                         set_smallest_and_largest_time_slice_length(pit->length);
 
                         // pit is updated to ensure --pit points to a valid location after erasure
-                        pit = _profile.erase(previous);
+                        pit = erase_slice(previous);
                     }
                 }
             }
@@ -2769,6 +3107,25 @@ bool Schedule::TimeSlice::contains_job(const Job *job) const
     return allocated_jobs.count(job);
 }
 
+void Schedule::TimeSlice::allocate_job(const Job *job, const IntervalSet &machines)
+{
+    deallocate_job(job);
+    allocated_jobs[job] = machines;
+    if (job->purpose == "reservation")
+        nb_reservation_machines += machines.size();
+}
+
+bool Schedule::TimeSlice::deallocate_job(const Job *job)
+{
+    auto it = allocated_jobs.find(job);
+    if (it == allocated_jobs.end())
+        return false;
+    if (job->purpose == "reservation")
+        nb_reservation_machines -= it->second.size();
+    allocated_jobs.erase(it);
+    return true;
+}
+
 bool Schedule::TimeSlice::contains_matching_job(std::function<bool(const Job *)> matching_function) const
 {
     for (auto mit : allocated_jobs)
@@ -2,6 +2,9 @@
 
 #include <list>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "exact_numbers.hpp"
 #include "locality.hpp"
@@ -29,10 +32,13 @@ public:
         IntervalSet available_machines;
         IntervalSet allocated_machines;//machines in timeslice currently running jobs.  This does not include machines that are down(repair_machines).
         int nb_available_machines;
-        std::map<const Job *, IntervalSet, JobComparator> allocated_jobs;
+        int nb_reservation_machines = 0; //number of machines of allocated_jobs running reservations
+        std::map<const Job *, IntervalSet, JobComparator> allocated_jobs; //modified through allocate_job/deallocate_job to keep nb_reservation_machines up to date
         //std::map<const Job *, IntervalSet, JobComparator> allocated_reservations;
 
         bool contains_job(const Job * job) const;
+        void allocate_job(const Job * job, const IntervalSet & machines);
+        bool deallocate_job(const Job * job); //returns whether the job was in the slice
         bool contains_matching_job(std::function<bool(const Job *)> matching_function) const;
         bool operator==(const TimeSlice & t);
         const Job * job_from_job_id(std::string job_id) const;
@@ -54,6 +60,12 @@ public:
     typedef std::list<TimeSlice>::iterator TimeSliceIterator;
     typedef std::list<TimeSlice>::const_iterator TimeSliceConstIterator;
 
+    struct PredictedRun
+    {
+        Rational start; //!< The beginning of the first slice the job is in
+        Rational end; //!< The end of the last slice the job is in
+    };
+
     
 
     struct ReservedTimeSlice{
@@ -87,6 +99,32 @@ public:
     Schedule & operator=(const Schedule & other);
     void set_now(Rational now);
 
+    /**
+     * @brief Starts recording every change made to the schedule, so that it can be undone by rollback()
+     * @details This is how a what-if placement is evaluated without copying the whole schedule:
+     *          the cost of a transaction is proportional to what changed, not to the size of the profile.
+     *          Covered operations are the job insertions and removals, the reservations, split_slice
+     *          and the first slice updates. Slices modified directly through begin()/end() are not recorded.
+     *          Transactions can be nested: a nested transaction acts as a savepoint of the enclosing one.
+     */
+    void begin_transaction();
+    /**
+     * @brief Keeps every change made since the matching begin_transaction()
+     * @details Committing a nested transaction hands its changes over to the enclosing one,
+     *          which can still roll them back.
+     */
+    void commit();
+    /**
+     * @brief Undoes every change made since the matching begin_transaction()
+     * @details Iterators to slices that existed at begin_transaction() are valid again afterwards
+     */
+    void rollback();
+    bool in_transaction() const;
+    /**
+     * @brief The number of transactions currently open, 0 outside of any transaction
+     */
+    int transaction_depth() const;
+
     void update_first_slice(Rational current_time);
     void update_first_slice_removing_remaining_jobs(Rational current_time);
 
@@ -166,6 +204,20 @@ public:
     Rational finite_horizon() const;
     Rational infinite_horizon() const;
 
+    /**
+     * @brief A number that changes whenever the profile changes, so that what is derived from it can be cached
+     */
+    unsigned long revision() const { return _revision; }
+    /**
+     * @brief The date at which area units of work would be processed if they flowed into the free machines
+     *        of the profile from starting_time on
+     * @details Reads a prefix sum of the free area of the slices in O(log(nb_slices)).  The sum is brought up to
+     *          date from the first slice that changed since the last call; moving the beginning of the first slice
+     *          (update_first_slice) only shifts it.  infinite_horizon() if the free area of the profile is never
+     *          large enough
+     */
+    double liquid_load_date(double area, double starting_time) const;
+
     std::multimap<std::string, JobAlloc> jobs_allocations() const;
     bool contains_job(const Job * job) const;
 
@@ -177,6 +229,13 @@ public:
     TimeSliceIterator find_last_occurence_of_job(const Job * job, TimeSliceIterator starting_point);
     TimeSliceConstIterator find_first_occurence_of_job(const Job * job, TimeSliceConstIterator starting_point) const;
     TimeSliceConstIterator find_last_occurence_of_job(const Job * job, TimeSliceConstIterator starting_point) const;
+    /**
+     * @brief Computes the predicted start and end of every job in the schedule, in one pass over the profile
+     * @details Use it instead of one find_first_occurence_of_job/find_last_occurence_of_job call per job
+     *          when many jobs are looked up at once.
+     * @param[out] runs The predicted runs, by job. It is cleared first, so it can be reused between calls
+     */
+    void compute_predicted_runs(std::unordered_map<const Job *, PredictedRun> & runs) const;
 
     TimeSliceIterator find_last_time_slice_before_date(Rational date, bool assert_not_found = true);
     TimeSliceConstIterator find_last_time_slice_before_date(Rational date, bool assert_not_found = true) const;
@@ -214,6 +273,46 @@ private:
     void generate_colors(int nb_colors = 32);
     void remove_job_internal(const Job * job, TimeSliceIterator removal_point);
 
+    //journaling of the changes made during a transaction, no-ops outside of one except for the revision
+    void journal_slice(TimeSliceIterator slice, bool free_area_changes = true);
+    void journal_inserted_slice(TimeSliceIterator slice);
+    void journal_job_allocations(const Job * job);
+    TimeSliceIterator erase_slice(TimeSliceIterator slice);
+    //undoes a split_slice outside of a transaction: the slice after first_slice_after_split is merged back into it
+    void merge_split_slice(TimeSliceIterator first_slice_after_split);
+
+    //the free area prefix of liquid_load_date is rebuilt from the first slice given here, or from scratch
+    void free_area_changed(const TimeSlice & slice);
+    void free_area_changed();
+    //the beginning of the first slice moved forward from old_begin, nothing else changed
+    void free_area_first_slice_truncated(Rational old_begin);
+
+private:
+    struct UndoEntry
+    {
+        enum class Type{SLICE_MODIFIED, SLICE_INSERTED, SLICE_ERASED, JOB_ALLOCATIONS};
+        Type type;
+        TimeSliceIterator slice; //the modified, inserted or erased slice
+        TimeSliceIterator next; //where an erased slice goes back
+        TimeSlice old_slice;
+        const Job * job = nullptr;
+        std::map<Rational, JobAlloc*> old_allocations;
+    };
+
+    //what begin_transaction() saves, to undo or hand over the changes of one transaction level
+    struct Savepoint
+    {
+        std::size_t undo_log_size = 0;
+        int size = 0;
+        int nb_reservations_size = 0;
+        int nb_jobs_size = 0;
+        Rational smallest_time_slice_length = 0;
+        Rational largest_time_slice_length = 0;
+        //the journaled slices and jobs of the enclosing transaction, set aside while this one records
+        std::unordered_set<const TimeSlice *> journaled_slices;
+        std::unordered_set<const Job *> journaled_jobs;
+    };
+
 private:
     
     Rational _now = 0;
@@ -248,6 +347,20 @@ private:
     double _svg_time_end = -1.0;
     Workload * _workload = nullptr;
     batsched_tools::start_from_chkpt * _start_from_checkpoint=nullptr;
+
+    std::vector<Savepoint> _savepoints; //one per open transaction, innermost last
+    std::vector<UndoEntry> _undo_log;
+    std::unordered_set<const TimeSlice *> _journaled_slices; //slices whose state before the innermost transaction is already known
+    std::unordered_set<const Job *> _journaled_jobs;
+    std::list<TimeSlice> _erased_slices; //erased slices are kept here until the outermost transaction ends, so rollback can put them back
+
+    unsigned long _revision = 1;
+    mutable std::vector<double> _free_area_begins; //begin of each slice
+    mutable std::vector<double> _free_area_prefix; //free area from the origin to the end of each slice
+    mutable std::vector<int> _free_area_machines; //available machines of each slice
+    mutable double _free_area_origin = 0; //free area from the origin to the begin of the first slice
+    mutable bool _free_area_stale = true; //whether the entries from _free_area_stale_from on must be rebuilt
+    mutable Rational _free_area_stale_from = 0; //begin of the first slice whose entry is stale
 };
 
 /**
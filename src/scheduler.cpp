@@ -0,0 +1,632 @@
+#include "scheduler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+
+#include <rapidjson/writer.h>
+
+#include <loguru.hpp>
+
+#include "isalgorithm.hpp"
+#include "decision.hpp"
+#include "json_workload.hpp"
+#include "pempek_assert.hpp"
+#include "data_storage.hpp"
+#include "batsched_tools.hpp"
+#include "machine.hpp"
+#include "shared_data.hpp"
+
+#include "algo/easy_bf.hpp"
+#include "algo/easy_bf2.hpp"
+#include "algo/easy_bf3.hpp"
+#include "algo/conservative_bf.hpp"
+#include "algo/easy_bf_fast2.hpp"
+#include "algo/easy_bf_fast2_holdback.hpp"
+#include "algo/easy_bf_plot_liquid_load_horizon.hpp"
+#include "algo/fcfs_fast2.hpp"
+#include "algo/conservative_bf_metrics.hpp"
+#include "algo/conservative_bf_metrics_roci.hpp"
+#include "algo/energy_bf.hpp"
+#include "algo/energy_bf_dicho.hpp"
+#include "algo/energy_bf_idle_sleeper.hpp"
+#include "algo/energy_bf_monitoring_period.hpp"
+#include "algo/energy_bf_monitoring_inertial_shutdown.hpp"
+#include "algo/energy_bf_machine_subpart_sleeper.hpp"
+#include "algo/energy_watcher.hpp"
+
+using namespace std;
+
+namespace r = rapidjson;
+
+namespace
+{
+    //the checkpoint signals received by the process, by signal number.  A signal handler has nowhere else to
+    //write: every Scheduler watching a signal compares its count with the count it saw last
+    std::atomic<unsigned long> nb_checkpoint_signals[NSIG];
+
+    void on_checkpoint_signal(int signum)
+    {
+        nb_checkpoint_signals[signum]++;
+    }
+}
+
+const set<string> & Scheduler::variants()
+{
+    static const set<string> variants = {"conservative_bf","conservative_bf_metrics","conservative_bf_metrics_roci","crasher", "easy_bf","easy_bf2","easy_bf3", "easy_bf_fast",
+                                         "easy_bf_fast2","easy_bf_fast2_holdback",
+                                         "easy_bf_plot_liquid_load_horizon",
+                                         "energy_bf", "energy_bf_dicho", "energy_bf_idle_sleeper",
+                                         "energy_bf_monitoring",
+                                         "energy_bf_monitoring_inertial", "energy_bf_subpart_sleeper",
+                                         "energy_watcher", "fcfs_fast",
+                                         "fcfs_fast2",
+                                         "filler", "killer", "killer2", "random", "rejecter",
+                                         "sequencer", "sleeper", "submitter", "waiting_time_estimator"};
+    return variants;
+}
+
+const set<string> & Scheduler::selection_policies()
+{
+    static const set<string> policies = {"basic", "best_fit", "contiguous", "topology"};
+    return policies;
+}
+
+const set<string> & Scheduler::queue_orders()
+{
+    static const set<string> orders = {"fcfs", "original_fcfs" ,"lcfs", "desc_bounded_slowdown", "desc_slowdown",
+                                       "asc_size", "desc_size", "asc_walltime", "desc_walltime"};
+    return orders;
+}
+
+ISchedulingAlgorithm * Scheduler::make_algorithm(const string & name, Workload * w, SchedulingDecision * decision,
+                                                 Queue * queue, ResourceSelector * selector, double rjms_delay,
+                                                 rapidjson::Document * variant_options)
+{
+    //crasher, easy_bf_fast, fcfs_fast, filler, killer, killer2, random, rejecter, sequencer, sleeper, submitter
+    //and waiting_time_estimator are not built
+    if (name == "easy_bf")
+        return new EasyBackfilling(w, decision, queue, selector, rjms_delay, variant_options);
+    else if (name == "easy_bf2")
+        return new EasyBackfilling2(w, decision, queue, selector, rjms_delay, variant_options);
+    else if (name == "easy_bf3")
+        return new EasyBackfilling3(w, decision, queue, selector, rjms_delay, variant_options);
+    else if (name == "fcfs_fast2")
+        return new FCFSFast2(w, decision, queue, selector, rjms_delay, variant_options);
+    else if (name == "easy_bf_fast2")
+        return new easy_bf_fast2(w, decision, queue, selector, rjms_delay, variant_options);
+    else if (name == "easy_bf_fast2_holdback")
+        return new easy_bf_fast2_holdback(w, decision, queue, selector, rjms_delay, variant_options);
+    else if (name == "easy_bf_plot_liquid_load_horizon")
+        return new EasyBackfillingPlotLiquidLoadHorizon(w, decision, queue, selector, rjms_delay, variant_options);
+    else if (name == "conservative_bf")
+        return new ConservativeBackfilling(w, decision, queue, selector, rjms_delay, variant_options);
+    else if (name == "conservative_bf_metrics")
+        return new ConservativeBackfilling_metrics(w, decision, queue, selector, rjms_delay, variant_options);
+    else if (name == "conservative_bf_metrics_roci")
+        return new ConservativeBackfilling_metrics_roci(w, decision, queue, selector, rjms_delay, variant_options);
+    else if (name == "energy_bf")
+        return new EnergyBackfilling(w, decision, queue, selector, rjms_delay, variant_options);
+    else if (name == "energy_bf_dicho")
+        return new EnergyBackfillingDichotomy(w, decision, queue, selector, rjms_delay, variant_options);
+    else if (name == "energy_bf_idle_sleeper")
+        return new EnergyBackfillingIdleSleeper(w, decision, queue, selector, rjms_delay, variant_options);
+    else if (name == "energy_bf_monitoring")
+        return new EnergyBackfillingMonitoringPeriod(w, decision, queue, selector, rjms_delay, variant_options);
+    else if (name == "energy_bf_monitoring_inertial")
+        return new EnergyBackfillingMonitoringInertialShutdown(w, decision, queue, selector, rjms_delay, variant_options);
+    else if (name == "energy_bf_subpart_sleeper")
+        return new EnergyBackfillingMachineSubpartSleeper(w, decision, queue, selector, rjms_delay, variant_options);
+    else if (name == "energy_watcher")
+        return new EnergyWatcher(w, decision, queue, selector, rjms_delay, variant_options);
+    return nullptr;
+}
+
+Scheduler::Scheduler(const SchedulerOptions & options) :
+    _shared_data(options.shared_data),
+    _call_make_decisions_on_single_nop(options.call_make_decisions_on_single_nop)
+{
+    PPK_ASSERT_ERROR(options.rjms_delay >= 0, "Invalid rjms_delay (%g): Must be non-negative", options.rjms_delay);
+
+    // Workload creation
+    _workload = new Workload;
+    _workload->set_rjms_delay(options.rjms_delay);
+
+    // Scheduling parameters
+    _decision = new SchedulingDecision;
+
+    // Queue order
+    const string & queue_order = options.queue_order;
+    PPK_ASSERT_ERROR(queue_orders().count(queue_order) == 1, "Invalid queue order '%s'", queue_order.c_str());
+    if (queue_order == "fcfs")
+        _order = new FCFSOrder;
+    else if (queue_order == "original_fcfs")
+        _order = new OriginalFCFSOrder;
+    else if (queue_order == "lcfs")
+        _order = new LCFSOrder;
+    else if (queue_order == "desc_bounded_slowdown")
+        _order = new DescendingBoundedSlowdownOrder(1);
+    else if (queue_order == "desc_slowdown")
+        _order = new DescendingSlowdownOrder;
+    else if (queue_order == "asc_size")
+        _order = new AscendingSizeOrder;
+    else if (queue_order == "desc_size")
+        _order = new DescendingSizeOrder;
+    else if (queue_order == "asc_walltime")
+        _order = new AscendingWalltimeOrder;
+    else if (queue_order == "desc_walltime")
+        _order = new DescendingWalltimeOrder;
+    //the variants keep the original submission order whatever the option says
+    delete _order;
+    _order = new OriginalFCFSOrder;
+    _queue = new Queue(_order);
+
+    // Resource selector
+    const string & selection_policy = options.selection_policy;
+    if (selection_policy == "basic")
+        _selector = new BasicResourceSelector;
+    else if (selection_policy == "contiguous")
+        _selector = new ContiguousResourceSelector;
+    else if (selection_policy == "best_fit")
+        _selector = new BestFitResourceSelector;
+    else if (selection_policy == "topology")
+    {
+        PPK_ASSERT_ERROR(!options.topology_filepath.empty(),
+                         "The 'topology' resource selection policy requires a topology file");
+        if (_shared_data != nullptr)
+            _selector = new TopologyResourceSelector(_shared_data->topology(options.topology_filepath));
+        else
+            _selector = new TopologyResourceSelector(options.topology_filepath);
+    }
+    else
+        PPK_ASSERT_ERROR(false, "Invalid resource selection policy '%s'", selection_policy.c_str());
+
+    // Scheduling variant options
+    _variant_options.Parse(options.variant_options.c_str());
+    PPK_ASSERT_ERROR(!_variant_options.HasParseError() && _variant_options.IsObject(),
+                     "Invalid variant options: Not a JSON object. variant_options='%s'", options.variant_options.c_str());
+    LOG_F(1, "variant_options = '%s'", options.variant_options.c_str());
+
+    // Scheduling variant
+    _algo = make_algorithm(options.variant, _workload, _decision, _queue, _selector, options.rjms_delay,
+                           &_variant_options);
+    PPK_ASSERT_ERROR(_algo != nullptr, "Invalid variant '%s': not built in batsched", options.variant.c_str());
+
+    // Redis creation
+    _redis = new RedisStorage;
+    _algo->set_redis(_redis);
+}
+
+Scheduler::~Scheduler()
+{
+    //the variant goes first, it may still use the others
+    delete _algo;
+    delete _queue;
+    delete _order;
+    delete _selector;
+    delete _decision;
+    delete _workload;
+    delete _redis;
+    delete _machines;
+}
+
+void Scheduler::request_checkpoint()
+{
+    LOG_F(INFO,"batsim checkpoint from signal == true");
+    _algo->on_signal_checkpoint();
+    _algo->add_decision_trigger(ISchedulingAlgorithm::TRIGGER_OTHER);
+}
+
+void Scheduler::speculate()
+{
+    //the algorithm may use the time the simulator takes to answer
+    if (!_finished)
+        _algo->speculate(_decisions_date);
+}
+
+string Scheduler::handle_message(const string & message)
+{
+    r::Document doc;
+    doc.Parse(message.c_str());
+    PPK_ASSERT_ERROR(!doc.HasParseError() && doc.IsObject(), "Invalid message: Not a JSON object");
+    decide(doc["now"].GetDouble(), doc["events"]);
+    return _decision->content(_decisions_date);
+}
+
+const r::Value & Scheduler::decide(double now, const r::Value & events_array)
+{
+    //ok we have a message, get and set real time for use with checkpointing batsim
+    _algo->set_real_time(chrono::system_clock::now());
+    _decision->clear();
+
+    if (_checkpoint_signal != -1 && nb_checkpoint_signals[_checkpoint_signal] != _nb_checkpoint_signals_seen)
+    {
+        _nb_checkpoint_signals_seen = nb_checkpoint_signals[_checkpoint_signal];
+        request_checkpoint();
+    }
+
+    double message_date = now;
+    double current_date = message_date;
+    bool requested_callback_received = false;
+
+    //the speculation of the algorithm only holds for a message of completions it expected
+    vector<string> completed_jobs;
+    for (unsigned int event_i = 0; event_i < events_array.Size(); ++event_i)
+    {
+        if (string(events_array[event_i]["type"].GetString()) != "JOB_COMPLETED")
+        {
+            completed_jobs.clear();
+            break;
+        }
+        completed_jobs.push_back(events_array[event_i]["data"]["job_id"].GetString());
+    }
+    _algo->end_speculation(message_date, completed_jobs);
+
+    // Let's handle all received events
+    for (unsigned int event_i = 0; event_i < events_array.Size(); ++event_i)
+    {
+        
+        const r::Value & event_object = events_array[event_i];
+        const std::string event_type = event_object["type"].GetString();
+        current_date = event_object["timestamp"].GetDouble();
+        const r::Value & event_data = event_object["data"];
+        
+        //LOG_F(INFO,"line 405 main.cpp");
+        if (event_type == "SIMULATION_BEGINS")
+        {
+            //the algorithm keeps the state of its simulation: the servers create a Scheduler per simulation
+            PPK_ASSERT_ERROR(_machines == nullptr,
+                             "A Scheduler serves a single simulation, SIMULATION_BEGINS was received twice");
+            int signal = event_data["config"]["checkpoint-signal"].GetInt();
+            LOG_F(INFO,"CHECKPOINT SIGNAL=%d",signal);
+            //register signal for checkpointing
+            if (signal != -1)
+            {
+                PPK_ASSERT_ERROR(signal > 0 && signal < NSIG, "Invalid checkpoint signal %d", signal);
+                _checkpoint_signal = signal;
+                _nb_checkpoint_signals_seen = nb_checkpoint_signals[signal];
+                std::signal(signal, on_checkpoint_signal);
+            }
+            std::string checkpoint_batsim = event_data["config"]["checkpoint-batsim-interval"]["raw"].GetString();
+            if (checkpoint_batsim != "False")
+            {
+                    int total_seconds = event_data["config"]["checkpoint-batsim-interval"]["total_seconds"].GetInt();
+                    std::string checkpoint_type = event_data["config"]["checkpoint-batsim-interval"]["type"].GetString();
+                    bool once = event_data["config"]["checkpoint-batsim-interval"]["once"].GetBool();
+                    _algo->set_checkpoint_time(total_seconds,checkpoint_type,once);
+                         
+            }
+            else
+                _algo->set_checkpoint_time(0,"False",false);
+            int nb_resources;
+            // DO this for retrocompatibility with batsim 2 API
+            if (event_data.HasMember("nb_compute_resources"))
+            {
+                nb_resources = event_data["nb_compute_resources"].GetInt();
+            }
+            else
+            {
+                nb_resources = event_data["nb_resources"].GetInt();
+            }
+            _redis_enabled = event_data["config"]["redis-enabled"].GetBool();
+
+            if (_redis_enabled)
+            {
+                string redis_hostname = event_data["config"]["redis-hostname"].GetString();
+                int redis_port = event_data["config"]["redis-port"].GetInt();
+                string redis_prefix = event_data["config"]["redis-prefix"].GetString();
+
+                _redis->connect_to_server(redis_hostname, redis_port, nullptr);
+                _redis->set_instance_key_prefix(redis_prefix);
+            }
+
+
+            const rapidjson::Value & Vstart_from_checkpoint = event_data["config"]["start-from-checkpoint"];
+            _workload->start_from_checkpoint = new batsched_tools::start_from_chkpt();
+            _workload->start_from_checkpoint->started_from_checkpoint = Vstart_from_checkpoint["started_from_checkpoint"].GetBool();
+            _workload->start_from_checkpoint->nb_folder = Vstart_from_checkpoint["nb_folder"].GetInt();
+            _workload->start_from_checkpoint->nb_checkpoint = Vstart_from_checkpoint["nb_checkpoint"].GetInt();
+            _workload->start_from_checkpoint->nb_previously_completed = Vstart_from_checkpoint["nb_previously_completed"].GetInt();
+            _workload->start_from_checkpoint->nb_original_jobs = Vstart_from_checkpoint["nb_original_jobs"].GetInt();
+            for (const rapidjson::Value & job : Vstart_from_checkpoint["expected_submissions"].GetArray())
+            {
+                _workload->start_from_checkpoint->jobs_that_should_have_been_submitted_already.insert(job.GetString());
+            }
+
+            double core_percent = event_data["config"]["core-percent"].GetDouble();
+            if (_shared_data != nullptr)
+                _machines = _shared_data->make_machines(event_data["compute_resources"], core_percent);
+            else
+            {
+                _machines = new Machines;
+                _machines->set_core_percent(core_percent);
+                for(const rapidjson::Value & resource : event_data["compute_resources"].GetArray())
+                {
+                    _machines->add_machine_from_json_object(resource);
+                }
+            }
+            _algo->set_machines(_machines);
+            _workload->_checkpointing_on = event_data["config"]["checkpointing_on"].GetBool();
+            _workload->_compute_checkpointing = event_data["config"]["compute_checkpointing"].GetBool();
+            _workload->_checkpointing_interval = event_data["config"]["checkpointing_interval"].GetDouble();
+            std::string failure_file_path = event_data["config"]["failure-from-file"].GetString();
+            LOG_F(ERROR,"fff: %s",failure_file_path.c_str());
+            if (failure_file_path != "none")
+            {
+               LOG_F(ERROR,"here");
+                std::map<double,batsched_tools::failure_tuple> failure_map = _shared_data != nullptr ?
+                    _shared_data->failure_map(failure_file_path) : batsched_tools::parse_failure_file(failure_file_path);
+                for (auto myPair:failure_map)
+                    LOG_F(ERROR,"%f %d",myPair.first,myPair.second.machine_down);
+                _algo->set_failure_map(failure_map);
+            }
+            
+            _workload->_MTBF = event_data["config"]["MTBF"].GetDouble();
+            _workload->_SMTBF = event_data["config"]["SMTBF"].GetDouble();
+            _workload->_fixed_failures = event_data["config"]["fixed_failures"].GetDouble();
+            
+            _workload->_repair_time = event_data["config"]["repair_time"].GetDouble();
+            _workload->_host_speed = event_data["compute_resources"][0]["speed"].GetDouble();
+            _workload->_seed_failures = event_data["config"]["seed-failures"].GetInt();
+            _workload->_seed_failure_machine = event_data["config"]["seed-failure-machine"].GetInt();
+            _workload->_queue_depth = event_data["config"]["scheduler-queue-depth"].GetInt();
+            _workload->_subtract_progress_from_walltime = event_data["config"]["subtract-progress-from-walltime"].GetBool();
+            _workload->_seed_repair_time = event_data["config"]["seed-repair-time"].GetInt();
+            _workload->_MTTR = event_data["config"]["MTTR"].GetDouble();
+            _workload->_reject_jobs_after_nb_repairs = event_data["config"]["reject-jobs-after-nb-repairs"].GetInt();
+            
+                         
+            LOG_F(INFO, "before set workloads");
+            /*
+            JUST DOING SINGLE WORKLOADS
+            _algo->set_workloads(&myWorkloads);
+            */
+        LOG_F(INFO, "after set workloads");
+            _decision->set_redis(_redis_enabled, _redis);
+            
+            _algo->set_nb_machines(nb_resources);
+            
+            if (_workload->start_from_checkpoint->started_from_checkpoint)
+                _algo->on_start_from_checkpoint(current_date,event_data);
+            else
+                _algo->on_simulation_start(current_date, event_data);
+            _algo->add_decision_trigger(ISchedulingAlgorithm::TRIGGER_OTHER);
+        }
+        else if (event_type == "SIMULATION_ENDS")
+        {
+            _algo->on_simulation_end(current_date);
+            _algo->add_decision_trigger(ISchedulingAlgorithm::TRIGGER_OTHER);
+            _finished = true;
+        }
+        else if (event_type == "JOB_SUBMITTED")
+        {
+         
+            string job_id = event_data["job_id"].GetString();
+           
+            if (_redis_enabled)
+                _workload->add_job_from_redis(*_redis, job_id, current_date);
+            else
+                _workload->add_job_from_json_object(event_data,job_id,current_date);
+            
+            _algo->on_job_release(current_date, {job_id});
+            _algo->add_decision_trigger(ISchedulingAlgorithm::TRIGGER_QUEUE);
+            
+        }
+        else if (event_type == "JOB_COMPLETED")
+        {
+            //LOG_F(INFO,"line 486 main.cpp");
+            string job_id = event_data["job_id"].GetString();
+            //LOG_F(INFO,"line 488 main.cpp");
+            (*_workload)[job_id]->completion_time = current_date;
+            //LOG_F(INFO,"line 490 main.cpp");
+            _algo->on_job_end(current_date, {job_id});
+            _algo->add_decision_trigger(ISchedulingAlgorithm::TRIGGER_QUEUE);
+            //LOG_F(INFO,"line 492 main.cpp");
+        }
+        else if (event_type == "RESOURCE_STATE_CHANGED")
+        {
+            IntervalSet resources = IntervalSet::from_string_hyphen(event_data["resources"].GetString(), " ");
+            string new_state = event_data["state"].GetString();
+            _algo->on_machine_state_changed(current_date, resources, std::stoi(new_state));
+            _algo->add_decision_trigger(ISchedulingAlgorithm::TRIGGER_MACHINES);
+        }
+        else if (event_type == "JOB_KILLED")
+        {
+            LOG_F(INFO,"DEBUG");
+            const r::Value & job_msgs = event_data["job_msgs"];
+            PPK_ASSERT_ERROR(event_data["job_msgs"].IsArray());
+            LOG_F(INFO,"DEBUG");
+            std::unordered_map<std::string,batsched_tools::Job_Message *> job_msgs_map;
+
+            for (auto itr = job_msgs.Begin(); itr != job_msgs.End(); ++itr)
+            {
+                LOG_F(INFO,"DEBUG");
+                batsched_tools::Job_Message * msg = new batsched_tools::Job_Message;
+                msg->id = (*itr)["id"].GetString();
+                LOG_F(INFO,"DEBUG");
+                msg->forWhat = static_cast<batsched_tools::KILL_TYPES>((*itr)["forWhat"].GetInt());
+                const r::Value & job_progress = (*itr)["job_progress"];
+                r::StringBuffer sb;
+                r::Writer<r::StringBuffer> writer(sb);
+                job_progress.Accept(writer);
+                msg->progress_str = sb.GetString();
+                
+                
+                LOG_F(INFO,"DEBUG");
+                LOG_F(INFO,"DEBUG");
+                //job_progress.CopyFrom( itr->value["job_progress"].,doc.GetAllocator());                    
+                r::Document d;
+                d.Parse(sb.GetString());
+                LOG_F(INFO,"DEBUG");
+
+                while( !(d.HasMember("progress")))
+                {
+                    PPK_ASSERT_ERROR(d.HasMember("current_task"),"While traversing the job_progress rapidjson of a JOB_KILLED event there was no 'progress' or 'current_task'");
+                    d["current_task"].Accept(writer);
+                    
+                    d.Parse(sb.GetString());
+                }
+                LOG_F(INFO,"DEBUG");
+                msg->progress = d["progress"].GetDouble();
+                job_msgs_map.insert(std::make_pair(msg->id,msg));
+            }
+
+            _algo->on_job_killed(current_date, job_msgs_map);
+            _algo->add_decision_trigger(ISchedulingAlgorithm::TRIGGER_QUEUE);
+        }
+        else if (event_type == "REQUESTED_CALL")
+        {
+            LOG_F(INFO,"DEBUG");
+            requested_callback_received = true;
+            batsched_tools::CALL_ME_LATERS cml;
+            LOG_F(INFO,"DEBUG");
+            cml.id = event_data["id"].GetInt();
+            LOG_F(INFO,"DEBUG");
+            cml.forWhat = static_cast<batsched_tools::call_me_later_types>(event_data["forWhat"].GetInt());
+            LOG_F(INFO,"DEBUG");
+            cml.extra_data = event_data["extra_data"].GetString();
+            LOG_F(INFO,"DEBUG");
+            //one call back stands for all the call me laters requested for the same date
+            for (const batsched_tools::CALL_ME_LATERS & fired : _decision->fired_call_me_laters(cml))
+            {
+                //the metrics wakeups belong to the base algorithm, whatever the variant
+                if (fired.forWhat == batsched_tools::call_me_later_types::METRICS)
+                    _algo->on_metrics_call(current_date,fired);
+                else if (fired.forWhat == batsched_tools::call_me_later_types::DECISION_QUANTUM)
+                    _algo->on_decision_quantum_call(current_date,fired);
+                else
+                {
+                    _algo->on_requested_call(current_date,fired);
+                    _algo->add_decision_trigger(ISchedulingAlgorithm::TRIGGER_CALL);
+                }
+            }
+            LOG_F(INFO,"DEBUG");
+        }
+        else if (event_type == "ANSWER")
+        {
+            for (auto itr = event_data.MemberBegin(); itr != event_data.MemberEnd(); ++itr)
+            {
+                string key_value = itr->name.GetString();
+
+                if (key_value == "consumed_energy")
+                {
+                    double consumed_joules = itr->value.GetDouble();
+                    _algo->on_answer_energy_consumption(current_date, consumed_joules);
+                    _algo->add_decision_trigger(ISchedulingAlgorithm::TRIGGER_OTHER);
+                }
+                else
+                {
+                    PPK_ASSERT_ERROR(false, "Unknown ANSWER type received '%s'", key_value.c_str());
+                }
+            }
+        }
+        else if (event_type == "QUERY")
+        {
+            const r::Value & requests = event_data["requests"];
+
+            for (auto itr = requests.MemberBegin(); itr != requests.MemberEnd(); ++itr)
+            {
+                string key_value = itr->name.GetString();
+
+                if (key_value == "estimate_waiting_time")
+                {
+                    const r::Value & request_object = itr->value;
+                    string job_id = request_object["job_id"].GetString();
+                    _workload->add_job_from_json_object(request_object["job"], job_id, current_date);
+
+                    _algo->on_query_estimate_waiting_time(current_date, job_id);
+                    _algo->add_decision_trigger(ISchedulingAlgorithm::TRIGGER_OTHER);
+                }
+                else
+                {
+                    PPK_ASSERT_ERROR(false, "Unknown QUERY type received '%s'", key_value.c_str());
+                }
+            }
+        }
+        else if (event_type == "NOTIFY")
+        {
+            string notify_type = event_data["type"].GetString();
+
+            if (notify_type == "no_more_static_job_to_submit")
+            {
+                _algo->on_no_more_static_job_to_submit_received(current_date);
+                _algo->add_decision_trigger(ISchedulingAlgorithm::TRIGGER_OTHER);
+            }
+            else if (notify_type == "no_more_external_event_to_occur")
+            {
+                _algo->on_no_more_external_event_to_occur(current_date);
+                _algo->add_decision_trigger(ISchedulingAlgorithm::TRIGGER_OTHER);
+            }
+            else if (notify_type == "event_machine_available")
+            {
+                IntervalSet resources = IntervalSet::from_string_hyphen(event_data["resources"].GetString(), " ");
+                _algo->on_machine_available_notify_event(current_date, resources);
+                _algo->add_decision_trigger(ISchedulingAlgorithm::TRIGGER_MACHINES);
+            }
+            else if (notify_type == "event_machine_unavailable")
+            {
+                IntervalSet resources = IntervalSet::from_string_hyphen(event_data["resources"].GetString(), " ");
+                _algo->on_machine_unavailable_notify_event(current_date, resources);
+                _algo->add_decision_trigger(ISchedulingAlgorithm::TRIGGER_MACHINES);
+            }
+            else if (notify_type == "myKillJob")
+            {
+                
+                    _algo->on_myKillJob_notify_event(current_date);
+                    _algo->add_decision_trigger(ISchedulingAlgorithm::TRIGGER_QUEUE);
+                
+            }
+            else if (notify_type == "job_fault")
+            {
+                LOG_F(INFO,"main.cpp notify_type==jobfault");
+                std::string job = event_data["job"].GetString();
+                _algo->on_job_fault_notify_event(current_date,job);
+                _algo->add_decision_trigger(ISchedulingAlgorithm::TRIGGER_QUEUE);
+            }
+            else if (notify_type == "batsim_metadata")
+            {
+                
+                std::string json_desc = event_data["metadata"].GetString();
+                LOG_F(INFO,"batsim_meta: %s",json_desc.c_str());
+                //LOG_F(INFO,"line 599 main.cpp");
+            }
+            else if (notify_type == "test")
+            {
+                    LOG_F(INFO,"test %f",current_date);
+            }
+            else
+            {
+                throw runtime_error("Unknown NOTIFY type received. Type = " + notify_type);
+            }
+
+        }
+        else
+        {
+            throw runtime_error("Unknown event received. Type = " + event_type);
+        }
+        //LOG_F(INFO,"line 615 main.cpp");
+    }
+
+    bool requested_callback_only = requested_callback_received && (events_array.Size() == 1);
+    // make_decisions is not called if (!call_make_decisions_on_single_nop && single_nop_received),
+    // nor when none of the events can change a decision of the algorithm (a METRICS wakeup, a NOTIFY of
+    // batsim metadata...) or while the submissions and completions wait for the end of a decision quantum:
+    // the answer is sent right away
+    _decisions_made = !(!_call_make_decisions_on_single_nop && requested_callback_only) &&
+                      _algo->should_make_decisions(message_date);
+    if (_decisions_made)
+    {
+        SortableJobOrder::UpdateInformation update_info(current_date);
+        LOG_F(INFO, "before make decisions");
+        _algo->set_clear_recent_data_structures(true);
+        _algo->make_decisions(message_date, &update_info, nullptr);
+        LOG_F(INFO,"_clear_recent_data_structures: %d",_algo->get_clear_recent_data_structures());
+        _algo->clear_recent_data_structures();
+    }
+    //whether make_decisions ran or not, a failure wakeup has to request the next failure
+    _algo->schedule_next_failure(message_date);
+    _algo->write_metrics(message_date);
+    _decisions_date = max(message_date, _decision->last_date());
+    return _decision->events();
+}
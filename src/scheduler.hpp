@@ -0,0 +1,111 @@
+#pragma once
+
+#include <set>
+#include <string>
+
+#include <rapidjson/document.h>
+
+class ISchedulingAlgorithm;
+class SchedulingDecision;
+class Workload;
+class Queue;
+class SortableJobOrder;
+class ResourceSelector;
+class RedisStorage;
+class Machines;
+class SharedData;
+
+/**
+ * @brief What a Scheduler is made of, as given to batsched on its command line
+ */
+struct SchedulerOptions
+{
+    std::string variant; //!< one of Scheduler::variants()
+    std::string selection_policy = "basic"; //!< one of Scheduler::selection_policies()
+    std::string topology_filepath; //!< the machine groups of the topology selection policy
+    std::string queue_order = "fcfs"; //!< one of Scheduler::queue_orders()
+    std::string variant_options = "{}"; //!< the variant options, as a JSON object
+    double rjms_delay = 0.0; //!< the time the RJMS takes to do some things like killing a job
+    bool call_make_decisions_on_single_nop = true; //!< whether make_decisions is called on a message holding one REQUESTED_CALL only
+    SharedData * shared_data = nullptr; //!< where the platform comes from when several Schedulers share it, not owned
+};
+
+/**
+ * @brief A batsched scheduling variant driven in-process: the events of a Batsim message in, the decisions out
+ * @details This is the event loop of batsched without the transport.  decide() takes the events as a rapidjson
+ *          array and gives the decisions back as another one, so that a simulator or a test driver linking the
+ *          batsched library pays neither serialization nor a socket hop.  handle_message() does the same on
+ *          serialized Batsim messages, which is all the batsched executable adds on top of its ZMQ socket.
+ */
+class Scheduler
+{
+public:
+    static const std::set<std::string> & variants();
+    static const std::set<std::string> & selection_policies();
+    static const std::set<std::string> & queue_orders();
+
+    /**
+     * @brief Builds the variant called name, nullptr if batsched does not build it
+     */
+    static ISchedulingAlgorithm * make_algorithm(const std::string & name, Workload * workload,
+                                                 SchedulingDecision * decision, Queue * queue,
+                                                 ResourceSelector * selector, double rjms_delay,
+                                                 rapidjson::Document * variant_options);
+
+    explicit Scheduler(const SchedulerOptions & options);
+    ~Scheduler();
+    Scheduler(const Scheduler &) = delete;
+    Scheduler & operator=(const Scheduler &) = delete;
+
+    /**
+     * @brief Handles the events of one message and makes the decisions they call for
+     * @param[in] now The date of the message
+     * @param[in] events The events of the message, as the "events" array of a Batsim message
+     * @return The decisions, as the "events" array of the answer.  Valid until the next call
+     */
+    const rapidjson::Value & decide(double now, const rapidjson::Value & events);
+    /** @brief The "now" of the answer to the last message: its date, or the date of a later decision */
+    double decisions_date() const { return _decisions_date; }
+    /** @brief Whether the last message called make_decisions, rather than being answered right away */
+    bool decisions_made() const { return _decisions_made; }
+    /**
+     * @brief decide() on a serialized Batsim message, returns the serialized answer
+     */
+    std::string handle_message(const std::string & message);
+
+    /**
+     * @brief Checkpoints batsched on the next message
+     * @details The checkpoint signal announced by SIMULATION_BEGINS does the same: every Scheduler watching it
+     *          checkpoints on its next message
+     */
+    void request_checkpoint();
+    /**
+     * @brief Lets the variant precompute its next decision until the next message (the 'speculation' variant option)
+     * @details To be called once the answer is on its way, as decide() ends the speculation
+     */
+    void speculate();
+    /** @brief Whether the SIMULATION_ENDS event was received */
+    bool finished() const { return _finished; }
+
+    ISchedulingAlgorithm * algorithm() { return _algo; }
+    Workload * workload() { return _workload; }
+
+private:
+    Workload * _workload = nullptr;
+    SchedulingDecision * _decision = nullptr;
+    SortableJobOrder * _order = nullptr;
+    Queue * _queue = nullptr;
+    ResourceSelector * _selector = nullptr;
+    rapidjson::Document _variant_options;
+    ISchedulingAlgorithm * _algo = nullptr;
+    RedisStorage * _redis = nullptr;
+    Machines * _machines = nullptr;
+    SharedData * _shared_data = nullptr;
+    bool _redis_enabled = false;
+    bool _call_make_decisions_on_single_nop = true;
+    int _checkpoint_signal = -1;
+    unsigned long _nb_checkpoint_signals_seen = 0;
+    bool _finished = false;
+    bool _decisions_made = false;
+    double _decisions_date = 0;
+};
@@ -0,0 +1,150 @@
+#include "server.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+#include <boost/algorithm/string.hpp>
+
+#include <loguru.hpp>
+
+#include "network.hpp"
+#include "pempek_assert.hpp"
+
+using namespace std;
+
+namespace
+{
+    //how long a worker waits on its sockets before checking whether the server stopped, in milliseconds
+    const long poll_timeout = 100;
+}
+
+SchedulerServer::SchedulerServer(const SchedulerOptions & options, const vector<string> & endpoints,
+                                 int nb_threads, int nb_simulations) :
+    _options(options),
+    _nb_simulations(nb_simulations)
+{
+    PPK_ASSERT_ERROR(!endpoints.empty(), "The server needs at least one socket endpoint");
+    PPK_ASSERT_ERROR(nb_threads >= 0, "Invalid number of threads (%d): Must be non-negative", nb_threads);
+    PPK_ASSERT_ERROR(nb_simulations >= 0, "Invalid number of simulations (%d): Must be non-negative", nb_simulations);
+    _options.shared_data = &_shared_data;
+
+    if (nb_threads == 0)
+        nb_threads = max(1, (int)thread::hardware_concurrency());
+    _nb_threads = min(nb_threads, (int)endpoints.size());
+
+    _instances.resize(endpoints.size());
+    for (unsigned int i = 0; i < endpoints.size(); ++i)
+    {
+        Instance & instance = _instances[i];
+        instance.endpoint = endpoints[i];
+        instance.network = new Network(&_context);
+        instance.network->bind(instance.endpoint);
+        instance.scheduler = new Scheduler(_options);
+    }
+}
+
+SchedulerServer::~SchedulerServer()
+{
+    for (Instance & instance : _instances)
+    {
+        delete instance.scheduler;
+        delete instance.network;
+    }
+}
+
+void SchedulerServer::run()
+{
+    LOG_F(INFO, "Serving %d endpoints with %d threads", (int)_instances.size(), _nb_threads);
+    vector<thread> workers;
+    for (int worker = 1; worker < _nb_threads; ++worker)
+        workers.push_back(thread(&SchedulerServer::serve, this, worker));
+    serve(0);
+    for (thread & worker : workers)
+        worker.join();
+    LOG_F(INFO, "%ld simulations served, %ld answered from the shared platform",
+          (long)_nb_simulations_served, _shared_data.nb_hits());
+
+    if (_error)
+        rethrow_exception(_error);
+}
+
+bool SchedulerServer::done(const Instance & instance) const
+{
+    return _nb_simulations > 0 && instance.nb_simulations >= _nb_simulations;
+}
+
+void SchedulerServer::serve(int worker)
+{
+    vector<Instance *> instances;
+    for (unsigned int i = worker; i < _instances.size(); i += _nb_threads)
+        instances.push_back(&_instances[i]);
+
+    try
+    {
+        while (!_stop)
+        {
+            //the endpoints that served all their simulations are not polled anymore
+            vector<Instance *> serving;
+            vector<zmq::pollitem_t> items;
+            for (Instance * instance : instances)
+            {
+                if (done(*instance))
+                    continue;
+                serving.push_back(instance);
+                items.push_back({static_cast<void *>(instance->network->socket()), 0, ZMQ_POLLIN, 0});
+            }
+            if (serving.empty())
+                return;
+
+            try
+            {
+                zmq::poll(items.data(), items.size(), poll_timeout);
+            }
+            catch (zmq::error_t &)
+            {
+                //interrupted by a signal, the checkpoint signal for instance
+                continue;
+            }
+            for (unsigned int i = 0; i < items.size() && !_stop; ++i)
+            {
+                if (items[i].revents & ZMQ_POLLIN)
+                    serve_message(*serving[i]);
+            }
+        }
+    }
+    catch (const std::exception & e)
+    {
+        LOG_F(ERROR, "%s", e.what());
+        lock_guard<mutex> lock(_error_mutex);
+        if (!_error)
+            _error = current_exception();
+        _stop = true;
+    }
+}
+
+void SchedulerServer::serve_message(Instance & instance)
+{
+    string received_message;
+    instance.network->read(received_message);
+    if (boost::trim_copy(received_message).empty())
+        throw runtime_error("Empty message received on '" + instance.endpoint + "' (connection lost ?)");
+
+    const string & message_to_send = instance.scheduler->handle_message(received_message);
+    instance.network->write(message_to_send);
+    if (!instance.scheduler->finished())
+    {
+        //the algorithm may use the time Batsim takes to answer
+        instance.scheduler->speculate();
+        return;
+    }
+
+    //the next Batsim on this endpoint gets a fresh scheduler, the platform is already built
+    ++instance.nb_simulations;
+    ++_nb_simulations_served;
+    LOG_F(INFO, "Simulation %d ended on '%s'", instance.nb_simulations, instance.endpoint.c_str());
+    delete instance.scheduler;
+    instance.scheduler = nullptr;
+    if (!done(instance))
+        instance.scheduler = new Scheduler(_options);
+}
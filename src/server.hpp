@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <zmq.hpp>
+
+#include "scheduler.hpp"
+#include "shared_data.hpp"
+
+class Network;
+
+/**
+ * @brief Hosts one Scheduler per socket endpoint in one process, for the many short simulations of a sweep
+ * @details Every endpoint serves one Batsim at a time, and one simulation after the other: the Scheduler of an
+ *          endpoint is replaced by a fresh one when its simulation ends.  A pool of worker threads polls the
+ *          sockets, each worker serving its share of the endpoints, and all the Schedulers share their platform
+ *          through one SharedData.  An error in any simulation stops the server.
+ */
+class SchedulerServer
+{
+public:
+    /**
+     * @param[in] options The options of every Scheduler, whose shared_data is set by the server
+     * @param[in] endpoints The socket endpoints, one Scheduler each
+     * @param[in] nb_threads The number of worker threads, 0 for one per core.  At most one per endpoint
+     * @param[in] nb_simulations The number of simulations each endpoint serves before the server stops, 0 for no limit
+     */
+    SchedulerServer(const SchedulerOptions & options, const std::vector<std::string> & endpoints,
+                    int nb_threads = 0, int nb_simulations = 0);
+    ~SchedulerServer();
+    SchedulerServer(const SchedulerServer &) = delete;
+    SchedulerServer & operator=(const SchedulerServer &) = delete;
+
+    /** @brief Serves the simulations until every endpoint served nb_simulations or an error stops the server */
+    void run();
+
+    int nb_threads() const { return _nb_threads; }
+    /** @brief The number of simulations that ended, on all endpoints */
+    long nb_simulations_served() const { return _nb_simulations_served; }
+    SharedData & shared_data() { return _shared_data; }
+
+private:
+    struct Instance
+    {
+        std::string endpoint;
+        Network * network = nullptr;
+        Scheduler * scheduler = nullptr;
+        int nb_simulations = 0;
+    };
+
+    /** @brief The loop of a worker thread, on the instances whose index is worker modulo the number of workers */
+    void serve(int worker);
+    /** @brief Answers the message waiting on the socket of instance */
+    void serve_message(Instance & instance);
+    bool done(const Instance & instance) const;
+
+private:
+    SchedulerOptions _options;
+    SharedData _shared_data;
+    zmq::context_t _context;
+    std::vector<Instance> _instances;
+    int _nb_threads;
+    int _nb_simulations;
+    std::atomic<long> _nb_simulations_served{0};
+    std::atomic<bool> _stop{false};
+    std::mutex _error_mutex;
+    std::exception_ptr _error;
+};
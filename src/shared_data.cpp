@@ -0,0 +1,74 @@
+#include "shared_data.hpp"
+
+#include <fstream>
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <loguru.hpp>
+
+#include "machine.hpp"
+#include "pempek_assert.hpp"
+
+using namespace std;
+
+SharedData::~SharedData()
+{
+    for (auto & key_machines : _machines)
+        delete key_machines.second;
+}
+
+Machines * SharedData::make_machines(const rapidjson::Value & compute_resources, double core_percent)
+{
+    PPK_ASSERT_ERROR(compute_resources.IsArray(), "Invalid compute resources: Not a JSON array");
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    compute_resources.Accept(writer);
+    string key = to_string(core_percent) + buffer.GetString();
+
+    lock_guard<mutex> lock(_mutex);
+    auto it = _machines.find(key);
+    if (it != _machines.end())
+    {
+        ++_nb_hits;
+        return new Machines(*it->second);
+    }
+    Machines * machines = new Machines;
+    machines->set_core_percent(core_percent);
+    for (const rapidjson::Value & resource : compute_resources.GetArray())
+        machines->add_machine_from_json_object(resource);
+    _machines[key] = machines;
+    LOG_F(INFO, "Shared platform of %d machines built", machines->nb_machines());
+    return new Machines(*machines);
+}
+
+const rapidjson::Document & SharedData::topology(const string & topology_filepath)
+{
+    lock_guard<mutex> lock(_mutex);
+    unique_ptr<rapidjson::Document> & doc = _topologies[topology_filepath];
+    if (doc != nullptr)
+    {
+        ++_nb_hits;
+        return *doc;
+    }
+    ifstream file(topology_filepath);
+    PPK_ASSERT_ERROR(file.is_open(), "Couldn't open topology file '%s'", topology_filepath.c_str());
+    string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    unique_ptr<rapidjson::Document> parsed(new rapidjson::Document);
+    parsed->Parse(content.c_str());
+    PPK_ASSERT_ERROR(!parsed->HasParseError(), "Invalid topology file '%s': not a JSON document", topology_filepath.c_str());
+    doc = std::move(parsed);
+    return *doc;
+}
+
+map<double,batsched_tools::failure_tuple> SharedData::failure_map(const string & failure_file_path)
+{
+    lock_guard<mutex> lock(_mutex);
+    auto it = _failure_maps.find(failure_file_path);
+    if (it != _failure_maps.end())
+    {
+        ++_nb_hits;
+        return it->second;
+    }
+    return _failure_maps[failure_file_path] = batsched_tools::parse_failure_file(failure_file_path);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <rapidjson/document.h>
+
+#include "batsched_tools.hpp"
+
+class Machines;
+
+/**
+ * @brief The read-only data of the simulations, built once and shared by the Schedulers of a process
+ * @details The platform of a simulation (its compute resources, the topology of the machine groups) and its failure
+ *          file are the same across the simulations of a sweep.  They are parsed the first time a Scheduler asks for
+ *          them, and every Scheduler gets a copy of what it changes (the machines) or a reference to what it only
+ *          reads (the topology).  The jobs are not shared: they come with the messages of each simulation.
+ *          The methods can be called from several threads, the data lives as long as the SharedData.
+ */
+class SharedData
+{
+public:
+    SharedData() = default;
+    ~SharedData();
+    SharedData(const SharedData &) = delete;
+    SharedData & operator=(const SharedData &) = delete;
+
+    /**
+     * @brief The machines of the compute resources of a SIMULATION_BEGINS event, owned by the caller
+     * @param[in] compute_resources The "compute_resources" array of the event
+     * @param[in] core_percent The share of the cores of each machine that jobs can use
+     */
+    Machines * make_machines(const rapidjson::Value & compute_resources, double core_percent);
+    /** @brief The parsed topology file of the topology resource selection policy */
+    const rapidjson::Document & topology(const std::string & topology_filepath);
+    /** @brief The parsed failure file, see batsched_tools::parse_failure_file */
+    std::map<double,batsched_tools::failure_tuple> failure_map(const std::string & failure_file_path);
+
+    /** @brief How many requests were answered from data already built */
+    long nb_hits() const { return _nb_hits; }
+
+private:
+    std::mutex _mutex;
+    std::unordered_map<std::string, const Machines *> _machines; //!< by serialized compute resources and core percent
+    std::unordered_map<std::string, std::unique_ptr<rapidjson::Document>> _topologies; //!< by file path
+    std::unordered_map<std::string, std::map<double,batsched_tools::failure_tuple>> _failure_maps; //!< by file path
+    std::atomic<long> _nb_hits{0};
+};
@@ -0,0 +1,66 @@
+#include "speculation.hpp"
+
+#include "pempek_assert.hpp"
+
+SpeculativeWorker::SpeculativeWorker()
+{
+    _thread = std::thread(&SpeculativeWorker::run, this);
+}
+
+SpeculativeWorker::~SpeculativeWorker()
+{
+    if (_started)
+        finish(true);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake_up.notify_all();
+    _thread.join();
+}
+
+void SpeculativeWorker::start(Task task)
+{
+    PPK_ASSERT_ERROR(!_started, "A speculative task is already running");
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _task = std::move(task);
+        _cancelled = false;
+        _done = false;
+        _has_task = true;
+    }
+    _started = true;
+    _wake_up.notify_all();
+}
+
+bool SpeculativeWorker::finish(bool cancel)
+{
+    if (!_started)
+        return false;
+    if (cancel)
+        _cancelled = true;
+    std::unique_lock<std::mutex> lock(_mutex);
+    _wake_up.wait(lock, [this] { return _done; });
+    _started = false;
+    _task = nullptr;
+    return _result;
+}
+
+void SpeculativeWorker::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _wake_up.wait(lock, [this] { return _has_task || _stop; });
+        if (_stop)
+            return;
+        _has_task = false;
+        Task task = _task;
+        lock.unlock();
+        bool result = task(_cancelled);
+        lock.lock();
+        _result = result;
+        _done = true;
+        _wake_up.notify_all();
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief A background thread that runs one speculative task at a time
+ * @details The algorithms use it while the drivers wait for the next message: the task precomputes the decision of
+ *          the most likely next event, and the algorithm keeps or drops its result once the message is known.
+ *          A task may work on the state of the algorithm, as the algorithm does not touch that state between start()
+ *          and finish().  The thread is created once and sleeps between tasks.
+ */
+class SpeculativeWorker
+{
+public:
+    /** @brief Returns whether its result can be used.  It should stop early, returning false, once cancelled is set */
+    typedef std::function<bool(const std::atomic<bool> & cancelled)> Task;
+
+    SpeculativeWorker();
+    /** @brief Cancels the running task and stops the thread */
+    ~SpeculativeWorker();
+
+    /** @brief Runs task in the background.  The previous task must have been finished */
+    void start(Task task);
+    /**
+     * @brief Waits for the task started last
+     * @param[in] cancel Whether the task is asked to stop first
+     * @return What the task returned, false if there was no task
+     */
+    bool finish(bool cancel);
+    /** @brief Whether a task was started and not finished yet */
+    bool started() const { return _started; }
+
+private:
+    void run();
+
+private:
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _wake_up;
+    Task _task;
+    bool _started = false; //only read and written by the owner thread
+    bool _has_task = false;
+    bool _done = false;
+    bool _result = false;
+    bool _stop = false;
+    std::atomic<bool> _cancelled{false};
+};
@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <fstream>
+#include <set>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/format.hpp>
+
+#include <rapidjson/document.h>
+
+#include <loguru.hpp>
+
+#include "external/taywee_args.hpp"
+
+#include "pempek_assert.hpp"
+#include "synthetic_workload.hpp"
+#include "synthetic_simulator.hpp"
+#include "scheduler.hpp"
+
+using namespace std;
+using namespace boost;
+
+// batsched-synth: runs the scheduling variants against a generated workload, without Batsim nor ZMQ,
+// and reports how fast each variant makes its decisions.
+
+static string read_file_or_string(const string & value, const string & filepath)
+{
+    if (filepath.empty())
+        return value;
+    ifstream file(filepath);
+    PPK_ASSERT_ERROR(file.is_open(), "Couldn't open file '%s'", filepath.c_str());
+    return string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+int main(int argc, char ** argv)
+{
+    const set<string> variants_set = {"conservative_bf", "conservative_bf_metrics", "conservative_bf_metrics_roci",
+                                      "easy_bf", "easy_bf2", "easy_bf3", "easy_bf_fast2", "easy_bf_fast2_holdback",
+                                      "fcfs_fast2"};
+    const set<string> & policies_set = Scheduler::selection_policies();
+    const string variants_string = "{" + boost::algorithm::join(variants_set, ", ") + "}";
+    const string policies_string = "{" + boost::algorithm::join(policies_set, ", ") + "}";
+
+    args::ArgumentParser parser("Drives batsched scheduling variants with a synthetic workload, without Batsim.");
+    args::HelpFlag flag_help(parser, "help", "Display this help menu", {'h', "help"});
+    args::ValueFlag<string> flag_scheduling_variants(parser, "variants", "Comma-separated scheduling variants to run. Available values are " + variants_string, {'v', "variants"}, "easy_bf_fast2");
+    args::ValueFlag<string> flag_selection_policy(parser, "policy", "Sets the resource selection policy. Available values are " + policies_string, {'p', "policy"}, "basic");
+    args::ValueFlag<string> flag_topology_filepath(parser, "topology-filepath", "Sets the JSON file describing the machine groups (switches, racks...) used by the topology resource selection policy.", {"topology_filepath"}, "");
+    args::ValueFlag<double> flag_rjms_delay(parser, "delay", "Sets the expected time that the RJMS takes to do some things like killing a job", {'d', "rjms_delay"}, 0.0);
+    args::ValueFlag<string> flag_variant_options(parser, "options", "Sets the scheduling variant options. Must be formatted as a JSON object.", {"variant_options"}, "{}");
+    args::ValueFlag<string> flag_variant_options_filepath(parser, "options-filepath", "Sets the scheduling variant options as the content of the given filepath.", {"variant_options_filepath"}, "");
+    args::ValueFlag<string> flag_synth_options(parser, "synth-options", "Sets the synthetic scenario (platform, arrivals, sizes, walltimes, failures). Must be formatted as a JSON object.", {"synth_options"}, "{}");
+    args::ValueFlag<string> flag_synth_options_filepath(parser, "synth-options-filepath", "Sets the synthetic scenario as the content of the given filepath.", {"synth_options_filepath"}, "");
+    args::ValueFlag<string> flag_output_folder(parser, "folder", "Folder where the variants write their own output files.", {'o', "output_folder"}, "/tmp/batsched-synth");
+    args::ValueFlag<string> flag_stats(parser, "stats", "File where the JSON statistics are written. stdout if empty.", {"stats"}, "");
+    args::ValueFlag<string> flag_verbosity_level(parser, "verbosity-level", "Sets the verbosity level. Available values are {debug, info, quiet, silent}", {"verbosity"}, "quiet");
+
+    try
+    {
+        parser.ParseCLI(argc, argv);
+        if (policies_set.count(flag_selection_policy.Get()) == 0)
+            throw args::ValidationError(str(format("Invalid '%1%' value (%2%): Not in %3%")
+                                            % flag_selection_policy.Name()
+                                            % flag_selection_policy.Get()
+                                            % policies_string));
+        if (flag_selection_policy.Get() == "topology" && flag_topology_filepath.Get().empty())
+            throw args::ValidationError(str(format("The '%1%' resource selection policy requires '%2%'")
+                                            % flag_selection_policy.Get()
+                                            % flag_topology_filepath.Name()));
+    }
+    catch(args::Help&)
+    {
+        parser.helpParams.addDefault = true;
+        printf("%s", parser.Help().c_str());
+        return 0;
+    }
+    catch(args::ParseError & e)
+    {
+        printf("%s\n", e.what());
+        return 1;
+    }
+    catch(args::ValidationError & e)
+    {
+        printf("%s\n", e.what());
+        return 1;
+    }
+
+    string verbosity_level = flag_verbosity_level.Get();
+    if (verbosity_level == "debug")
+        loguru::g_stderr_verbosity = loguru::Verbosity_1;
+    else if (verbosity_level == "info")
+        loguru::g_stderr_verbosity = loguru::Verbosity_INFO;
+    else if (verbosity_level == "silent")
+        loguru::g_stderr_verbosity = loguru::Verbosity_OFF;
+    else
+        loguru::g_stderr_verbosity = loguru::Verbosity_WARNING;
+
+    vector<string> variants;
+    boost::split(variants, flag_scheduling_variants.Get(), boost::is_any_of(","));
+    for (const string & variant : variants)
+    {
+        if (variants_set.count(variant) == 0)
+        {
+            printf("Invalid variant '%s'. Available values are %s\n", variant.c_str(), variants_string.c_str());
+            return 1;
+        }
+    }
+
+    string synth_options_str = read_file_or_string(flag_synth_options.Get(), flag_synth_options_filepath.Get());
+    rapidjson::Document synth_options_doc;
+    synth_options_doc.Parse(synth_options_str.c_str());
+    if (synth_options_doc.HasParseError() || !synth_options_doc.IsObject())
+    {
+        printf("Invalid synthetic options: Not a JSON object. synth_options='%s'\n", synth_options_str.c_str());
+        return 1;
+    }
+    string variant_options = read_file_or_string(flag_variant_options.Get(), flag_variant_options_filepath.Get());
+    rapidjson::Document variant_options_doc;
+    variant_options_doc.Parse(variant_options.c_str());
+    if (variant_options_doc.HasParseError() || !variant_options_doc.IsObject())
+    {
+        printf("Invalid variant options: Not a JSON object. variant_options='%s'\n", variant_options.c_str());
+        return 1;
+    }
+
+    SyntheticOptions options;
+    options.from_json(synth_options_doc);
+    SyntheticWorkloadGenerator generator(options);
+    const vector<SyntheticJob> jobs = generator.generate();
+
+    string stats = "[";
+    for (const string & variant : variants)
+    {
+        SchedulerOptions scheduler_options;
+        scheduler_options.variant = variant;
+        scheduler_options.selection_policy = flag_selection_policy.Get();
+        scheduler_options.topology_filepath = flag_topology_filepath.Get();
+        scheduler_options.variant_options = variant_options;
+        scheduler_options.rjms_delay = flag_rjms_delay.Get();
+
+        SyntheticStats variant_stats;
+        {
+            Scheduler scheduler(scheduler_options);
+            SyntheticSimulator simulator(scheduler, options, jobs, flag_output_folder.Get() + "/" + variant);
+            variant_stats = simulator.run(variant);
+        }
+        stats += (stats.size() > 1 ? ",\n" : "\n") + variant_stats.to_json_string();
+    }
+    stats += "\n]\n";
+
+    if (flag_stats.Get().empty())
+        printf("%s", stats.c_str());
+    else
+    {
+        ofstream f(flag_stats.Get());
+        PPK_ASSERT_ERROR(f.is_open(), "Couldn't open stats file '%s'", flag_stats.Get().c_str());
+        f << stats;
+    }
+    return 0;
+}
@@ -0,0 +1,413 @@
+#include "synthetic_simulator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <rapidjson/writer.h>
+#include <rapidjson/stringbuffer.h>
+
+#include <loguru.hpp>
+
+#include "isalgorithm.hpp"
+#include "json_workload.hpp"
+#include "pempek_assert.hpp"
+#include "batsched_tools.hpp"
+#if __has_include(<filesystem>)
+#include <filesystem>
+namespace fs = std::filesystem;
+#elif __has_include(<experimental/filesystem>)
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+
+using namespace std;
+namespace r = rapidjson;
+
+string SyntheticStats::to_json_string() const
+{
+    return batsched_tools::string_format(
+        "{\"variant\":\"%s\",\"nb_machines\":%d,\"nb_jobs\":%d,"
+        "\"nb_messages\":%ld,\"nb_skipped_decisions\":%ld,\"nb_deferred_decisions\":%ld,\"nb_speculations\":%ld,\"nb_speculation_hits\":%ld,\"nb_events\":%ld,\"scheduler_seconds\":%.9g,\"total_seconds\":%.9g,"
+        "\"events_per_second\":%.9g,\"messages_per_second\":%.9g,"
+        "\"latency_mean_us\":%.9g,\"latency_p50_us\":%.9g,\"latency_p90_us\":%.9g,"
+        "\"latency_p99_us\":%.9g,\"latency_max_us\":%.9g,"
+        "\"makespan\":%.15g,\"mean_waiting_time\":%.15g,\"nb_started\":%d,\"nb_completed\":%d,"
+        "\"nb_killed\":%d,\"nb_rejected\":%d,\"nb_resubmitted\":%d,\"nb_call_me_laters\":%ld,"
+        "\"finished\":%s}",
+        variant.c_str(), nb_machines, nb_jobs,
+        nb_messages, nb_skipped_decisions, nb_deferred_decisions, nb_speculations, nb_speculation_hits, nb_events, scheduler_seconds, total_seconds,
+        events_per_second, messages_per_second,
+        latency_mean_us, latency_p50_us, latency_p90_us,
+        latency_p99_us, latency_max_us,
+        makespan, mean_waiting_time, nb_started, nb_completed,
+        nb_killed, nb_rejected, nb_resubmitted, nb_call_me_laters,
+        finished ? "true" : "false");
+}
+
+SyntheticSimulator::SyntheticSimulator(Scheduler & scheduler,
+                                       const SyntheticOptions & options,
+                                       const vector<SyntheticJob> & jobs,
+                                       const string & output_folder) :
+    _scheduler(scheduler),
+    _options(options),
+    _jobs(jobs),
+    _output_folder(output_folder)
+{
+}
+
+void SyntheticSimulator::push(Event event)
+{
+    event.order = _next_order++;
+    _events.push(event);
+}
+
+string SyntheticSimulator::simulation_begins_data(const SyntheticOptions & options, const string & output_folder)
+{
+    string resources;
+    resources.reserve(options.nb_machines * 96);
+    const int nb_partitions = (int)options.machine_prefixes.size();
+    for (int i = 0; i < options.nb_machines; ++i)
+    {
+        if (i != 0)
+            resources += ",";
+        const string & prefix = options.machine_prefixes[(long)i * nb_partitions / options.nb_machines];
+        resources += batsched_tools::string_format(
+            "{\"id\":%d,\"name\":\"%s%d\",\"core_count\":%d,\"speed\":%.15g,\"repair_time\":%.15g}",
+            i, prefix.c_str(), i, options.core_count, options.machine_speed, options.repair_time);
+    }
+    string config = batsched_tools::string_format(
+        "{\"output-folder\":\"%s/out\",\"output-extra-info\":false,\"set-generators-from-file\":false,"
+        "\"queue-policy\":\"FCFS\",\"share-packing\":%s,\"share-packing-holdback\":0,\"core-percent\":%.15g,"
+        "\"output-svg\":\"none\",\"output-svg-method\":\"svg\","
+        "\"svg-frame-start\":1,\"svg-frame-end\":-1,\"svg-output-start\":1,\"svg-output-end\":-1,"
+        "\"svg-time-start\":-1,\"svg-time-end\":-1,"
+        "\"reschedule-policy\":\"RESCHEDULE_AFFECTED\",\"impact-policy\":\"LEAST_KILLING_LARGEST_FIRST\","
+        "\"checkpoint-signal\":-1,\"checkpoint-batsim-interval\":{\"raw\":\"False\"},"
+        "\"redis-enabled\":false,\"checkpointing_on\":false,\"compute_checkpointing\":false,\"checkpointing_interval\":-1.0,"
+        "\"failure-from-file\":\"none\",\"MTBF\":%.15g,\"SMTBF\":%.15g,\"fixed_failures\":%.15g,"
+        "\"repair_time\":%.15g,\"MTTR\":%.15g,\"seed-failures\":%d,\"seed-failure-machine\":%d,\"seed-repair-time\":%d,"
+        "\"scheduler-queue-depth\":%d,\"subtract-progress-from-walltime\":false,\"reject-jobs-after-nb-repairs\":%d,"
+        "\"start-from-checkpoint\":{\"started_from_checkpoint\":false,\"nb_folder\":0,\"nb_checkpoint\":0,"
+        "\"nb_previously_completed\":0,\"nb_original_jobs\":0,\"expected_submissions\":[]}}",
+        output_folder.c_str(), options.share_packing ? "true" : "false", options.core_percent,
+        options.MTBF, options.SMTBF, options.fixed_failures,
+        options.repair_time, options.MTTR, options.seed_failures, options.seed_failure_machine, options.seed_repair_time,
+        options.queue_depth, options.reject_jobs_after_nb_repairs);
+    return "{\"nb_resources\":" + std::to_string(options.nb_machines) +
+           ",\"compute_resources\":[" + resources + "],\"config\":" + config + "}";
+}
+
+void SyntheticSimulator::make_message(const vector<Event> & events, double date, bool begin, r::Document & message) const
+{
+    message.SetArray();
+    r::Document::AllocatorType & alloc = message.GetAllocator();
+    auto add_event = [&message, &alloc, date](const char * type, r::Value & data)
+    {
+        r::Value event(r::kObjectType);
+        event.AddMember("timestamp", r::Value().SetDouble(date), alloc);
+        event.AddMember("type", r::Value(type, alloc), alloc);
+        event.AddMember("data", data, alloc);
+        message.PushBack(event, alloc);
+    };
+    auto parse = [&alloc](const string & json, r::Value & value)
+    {
+        r::Document doc;
+        doc.Parse(json.c_str());
+        PPK_ASSERT_ERROR(!doc.HasParseError(), "Invalid synthetic event data '%s'", json.c_str());
+        value.CopyFrom(doc, alloc);
+    };
+
+    if (begin)
+    {
+        r::Value data;
+        parse(simulation_begins_data(_options, _output_folder), data);
+        add_event("SIMULATION_BEGINS", data);
+    }
+
+    //the kills of a message are delivered as a single JOB_KILLED, so the variants handle them together
+    r::Value job_msgs(r::kArrayType);
+    for (const Event & event : events)
+    {
+        r::Value data(r::kObjectType);
+        switch (event.type)
+        {
+        case EventType::JOB_SUBMITTED:
+            parse(event.data, data);
+            add_event("JOB_SUBMITTED", data);
+            break;
+        case EventType::JOB_COMPLETED:
+            data.AddMember("job_id", r::Value(event.job_id.c_str(), alloc), alloc);
+            data.AddMember("job_state", "COMPLETED_SUCCESSFULLY", alloc);
+            add_event("JOB_COMPLETED", data);
+            break;
+        case EventType::JOB_KILLED:
+        {
+            r::Value progress(r::kObjectType);
+            progress.AddMember("progress", r::Value().SetDouble(event.progress), alloc);
+            data.AddMember("id", r::Value(event.job_id.c_str(), alloc), alloc);
+            data.AddMember("forWhat", event.for_what, alloc);
+            data.AddMember("job_progress", progress, alloc);
+            job_msgs.PushBack(data, alloc);
+            break;
+        }
+        case EventType::REQUESTED_CALL:
+            data.AddMember("id", event.cml.id, alloc);
+            data.AddMember("forWhat", static_cast<int>(event.cml.forWhat), alloc);
+            data.AddMember("extra_data", r::Value(event.cml.extra_data.c_str(), alloc), alloc);
+            add_event("REQUESTED_CALL", data);
+            break;
+        case EventType::NO_MORE_STATIC_JOB_TO_SUBMIT:
+            data.AddMember("type", "no_more_static_job_to_submit", alloc);
+            add_event("NOTIFY", data);
+            break;
+        }
+    }
+    if (!job_msgs.Empty())
+    {
+        r::Value data(r::kObjectType);
+        data.AddMember("job_msgs", job_msgs, alloc);
+        add_event("JOB_KILLED", data);
+    }
+}
+
+void SyntheticSimulator::apply_decisions(const r::Value & decisions, double date)
+{
+    Workload & workload = *_scheduler.workload();
+    for (const r::Value & event : decisions.GetArray())
+    {
+        const string type = event["type"].GetString();
+        const r::Value & data = event["data"];
+        double event_date = std::max(date, event["timestamp"].GetDouble());
+
+        if (type == "EXECUTE_JOB")
+        {
+            string job_id = data["job_id"].GetString();
+            PPK_ASSERT_ERROR(_running.count(job_id) == 0, "Job '%s' started twice", job_id.c_str());
+            Job * job = workload[job_id];
+            double runtime = _runtimes.at(job_id);
+            double duration = job->has_walltime ? std::min(runtime, (double) job->walltime) : runtime;
+
+            RunningJob running{event_date, runtime, _next_execution++};
+            _running[job_id] = running;
+            _stats.nb_started++;
+            _total_waiting_time += event_date - job->submission_time;
+
+            Event completed;
+            completed.date = event_date + duration;
+            completed.type = EventType::JOB_COMPLETED;
+            completed.job_id = job_id;
+            completed.execution = running.execution;
+            push(completed);
+        }
+        else if (type == "KILL_JOB")
+        {
+            for (const r::Value & job_msg : data["job_msgs"].GetArray())
+            {
+                string job_id = job_msg["id"].GetString();
+                auto it = _running.find(job_id);
+                if (it == _running.end())
+                    continue; //already completed, Batsim ignores it too
+
+                Event killed;
+                killed.date = event_date;
+                killed.type = EventType::JOB_KILLED;
+                killed.job_id = job_id;
+                killed.for_what = job_msg["forWhat"].GetInt();
+                double progress = (event_date - it->second.start) / it->second.runtime;
+                killed.progress = std::min(std::max(progress, 0.0), 1.0);
+                push(killed);
+
+                _running.erase(it);
+                _stats.nb_killed++;
+                _nb_unfinished_jobs--;
+            }
+        }
+        else if (type == "REJECT_JOB")
+        {
+            _stats.nb_rejected++;
+            _nb_unfinished_jobs--;
+        }
+        else if (type == "CALL_ME_LATER")
+        {
+            //the event is dated when the call is requested, the call itself in its data
+            Event call;
+            call.date = std::max(event_date, data["timestamp"].GetDouble());
+            call.type = EventType::REQUESTED_CALL;
+            call.cml.id = data["id"].GetInt();
+            call.cml.forWhat = static_cast<batsched_tools::call_me_later_types>(data["forWhat"].GetInt());
+            call.cml.extra_data = data["extra_data"].GetString();
+            call.cml.time = call.date;
+            push(call);
+            _stats.nb_call_me_laters++;
+        }
+        else if (type == "REGISTER_JOB")
+        {
+            //dynamic (re)submission: Batsim acknowledges it with a JOB_SUBMITTED at the same date
+            PPK_ASSERT_ERROR(data.HasMember("job") && data.HasMember("profile"),
+                             "The synthetic simulator needs job and profile descriptions in REGISTER_JOB");
+            string job_id = data["job_id"].GetString();
+            r::StringBuffer buffer;
+            r::Writer<r::StringBuffer> writer(buffer);
+            data.Accept(writer);
+
+            _runtimes[job_id] = data["profile"]["delay"].GetDouble();
+            Event submitted;
+            submitted.date = event_date;
+            submitted.type = EventType::JOB_SUBMITTED;
+            submitted.job_id = job_id;
+            submitted.data = buffer.GetString();
+            push(submitted);
+            _stats.nb_resubmitted++;
+            _nb_unfinished_jobs++;
+        }
+        //REGISTER_PROFILE, SET_JOB_METADATA, SET_RESOURCE_STATE and NOTIFY have no effect on a delay-only platform
+    }
+}
+
+bool SyntheticSimulator::all_jobs_done() const
+{
+    return _nb_unfinished_jobs == 0 && _running.empty();
+}
+
+SyntheticStats SyntheticSimulator::run(const string & variant)
+{
+    using clock = std::chrono::steady_clock;
+    auto run_start = clock::now();
+
+    _stats = SyntheticStats();
+    _stats.variant = variant;
+    _stats.nb_machines = _options.nb_machines;
+    _stats.nb_jobs = _jobs.size();
+
+    //the algorithms write their logs in <output-folder without /out>/log
+    fs::create_directories(_output_folder + "/log");
+    fs::create_directories(_output_folder + "/out");
+
+    for (const SyntheticJob & job : _jobs)
+    {
+        Event submitted;
+        submitted.date = job.submission_time;
+        submitted.type = EventType::JOB_SUBMITTED;
+        submitted.job_id = job.id;
+        submitted.data = job.to_json_string();
+        push(submitted);
+        _runtimes[job.id] = job.runtime;
+    }
+    _nb_unfinished_jobs = _jobs.size();
+    {
+        Event no_more;
+        no_more.date = _jobs.empty() ? 0 : _jobs.back().submission_time;
+        no_more.type = EventType::NO_MORE_STATIC_JOB_TO_SUBMIT;
+        push(no_more);
+    }
+
+    double date = 0;
+    bool begin = true;
+    while (begin || !_events.empty())
+    {
+        vector<Event> message;
+        if (!begin)
+        {
+            date = _events.top().date;
+            if (_options.max_simulated_time != -1 && date > _options.max_simulated_time)
+                break;
+            while (!_events.empty() && _events.top().date == date)
+            {
+                const Event & top = _events.top();
+                //completions of killed executions are dropped, as Batsim never sends them
+                bool stale = top.type == EventType::JOB_COMPLETED &&
+                             (_running.count(top.job_id) == 0 || _running.at(top.job_id).execution != top.execution);
+                if (!stale)
+                    message.push_back(top);
+                _events.pop();
+            }
+            if (message.empty())
+                continue;
+            for (const Event & event : message)
+            {
+                if (event.type == EventType::JOB_COMPLETED)
+                {
+                    _running.erase(event.job_id);
+                    _stats.nb_completed++;
+                    _nb_unfinished_jobs--;
+                }
+            }
+        }
+
+        r::Document events;
+        make_message(message, date, begin, events);
+        ISchedulingAlgorithm * algo = _scheduler.algorithm();
+        long nb_deferred = algo->nb_deferred_decisions();
+        auto decision_start = clock::now();
+        const r::Value & decisions = _scheduler.decide(date, events);
+        auto decision_end = clock::now();
+        //the worker runs while the simulator computes the next message, as it would while Batsim does
+        _scheduler.speculate();
+
+        if (!_scheduler.decisions_made())
+        {
+            if (algo->nb_deferred_decisions() > nb_deferred)
+                _stats.nb_deferred_decisions++;
+            else
+                _stats.nb_skipped_decisions++;
+        }
+        _stats.nb_events += events.Size();
+        _latencies.push_back(chrono::duration<double, micro>(decision_end - decision_start).count());
+        _stats.nb_messages++;
+        begin = false;
+
+        apply_decisions(decisions, date);
+        _stats.makespan = date;
+
+        if (all_jobs_done())
+        {
+            _stats.finished = true;
+            break;
+        }
+    }
+
+    {
+        //as Batsim, end the simulation with its own message, which is not measured
+        r::Document events(r::kArrayType);
+        r::Value end(r::kObjectType);
+        end.AddMember("timestamp", r::Value().SetDouble(date), events.GetAllocator());
+        end.AddMember("type", "SIMULATION_ENDS", events.GetAllocator());
+        end.AddMember("data", r::Value(r::kObjectType), events.GetAllocator());
+        events.PushBack(end, events.GetAllocator());
+        _scheduler.decide(date, events);
+    }
+
+    _stats.total_seconds = chrono::duration<double>(clock::now() - run_start).count();
+    _stats.nb_speculations = _scheduler.algorithm()->nb_speculations();
+    _stats.nb_speculation_hits = _scheduler.algorithm()->nb_speculation_hits();
+    if (!_latencies.empty())
+    {
+        double sum = 0;
+        for (double latency : _latencies)
+            sum += latency;
+        _stats.scheduler_seconds = sum / 1e6;
+        _stats.latency_mean_us = sum / _latencies.size();
+        vector<double> sorted = _latencies;
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&sorted](double p)
+        {
+            size_t index = std::min(sorted.size() - 1, size_t(ceil(p * sorted.size())) - 1);
+            return sorted[index];
+        };
+        _stats.latency_p50_us = percentile(0.50);
+        _stats.latency_p90_us = percentile(0.90);
+        _stats.latency_p99_us = percentile(0.99);
+        _stats.latency_max_us = sorted.back();
+        if (_stats.scheduler_seconds > 0)
+        {
+            _stats.events_per_second = _stats.nb_events / _stats.scheduler_seconds;
+            _stats.messages_per_second = _stats.nb_messages / _stats.scheduler_seconds;
+        }
+    }
+    if (_stats.nb_started > 0)
+        _stats.mean_waiting_time = _total_waiting_time / _stats.nb_started;
+
+    LOG_F(INFO, "Synthetic run of '%s' done: %s", variant.c_str(), _stats.to_json_string().c_str());
+    return _stats;
+}
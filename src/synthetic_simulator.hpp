@@ -0,0 +1,140 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <queue>
+#include <map>
+#include <unordered_map>
+
+#include <rapidjson/document.h>
+
+#include "batsched_tools.hpp"
+#include "scheduler.hpp"
+#include "synthetic_workload.hpp"
+
+/**
+ * @brief Throughput and latency figures of one SyntheticSimulator run
+ */
+struct SyntheticStats
+{
+    std::string variant;
+    int nb_machines = 0;
+    int nb_jobs = 0;
+
+    //scheduler cost
+    long nb_messages = 0; //!< number of Batsim-like messages
+    long nb_skipped_decisions = 0; //!< messages answered without make_decisions, none of their events mattering
+    long nb_deferred_decisions = 0; //!< messages answered without make_decisions, their events waiting for the end of a decision quantum
+    long nb_speculations = 0; //!< decisions precomputed between two messages ('speculation' variant option)
+    long nb_speculation_hits = 0; //!< precomputed decisions the next message used
+    long nb_events = 0; //!< number of events delivered to the scheduler
+    double scheduler_seconds = 0; //!< real time spent in Scheduler::decide (callbacks + make_decisions)
+    double total_seconds = 0; //!< real time of the whole run, simulator included
+    double events_per_second = 0;
+    double messages_per_second = 0;
+    double latency_mean_us = 0;
+    double latency_p50_us = 0;
+    double latency_p90_us = 0;
+    double latency_p99_us = 0;
+    double latency_max_us = 0;
+
+    //simulation outcome
+    double makespan = 0;
+    double mean_waiting_time = 0;
+    int nb_started = 0;
+    int nb_completed = 0;
+    int nb_killed = 0;
+    int nb_rejected = 0;
+    int nb_resubmitted = 0;
+    long nb_call_me_laters = 0;
+    bool finished = false; //!< false if the run stopped on max_simulated_time or with unfinished jobs
+
+    std::string to_json_string() const;
+};
+
+/**
+ * @brief Plays the role of Batsim for a Scheduler, in-process and without ZMQ
+ * @details Jobs are executed as delay profiles: a job started at date d completes at
+ *          d + min(runtime, walltime) unless it is killed before.  Events of the same date are
+ *          grouped into a single message, given to Scheduler::decide() as the events of a Batsim message.
+ *          The decisions are read from the events decide() returns, so only the serialization of the
+ *          messages is left out of what gets measured.
+ */
+class SyntheticSimulator
+{
+public:
+    /**
+     * @param[in] scheduler A Scheduler that has not received SIMULATION_BEGINS yet, not owned
+     */
+    SyntheticSimulator(Scheduler & scheduler,
+                       const SyntheticOptions & options,
+                       const std::vector<SyntheticJob> & jobs,
+                       const std::string & output_folder);
+
+    /**
+     * @brief Runs the whole simulation and returns the measured statistics
+     */
+    SyntheticStats run(const std::string & variant);
+
+    /**
+     * @brief The SIMULATION_BEGINS data Batsim would send for the platform of options, everything that is not
+     *        synthetic turned off.  The variants write their output files in output_folder/out
+     */
+    static std::string simulation_begins_data(const SyntheticOptions & options, const std::string & output_folder);
+
+private:
+    enum class EventType
+    {
+        JOB_SUBMITTED,
+        JOB_COMPLETED,
+        JOB_KILLED,
+        REQUESTED_CALL,
+        NO_MORE_STATIC_JOB_TO_SUBMIT
+    };
+    struct Event
+    {
+        double date;
+        long order; //!< keeps events of the same date in insertion order
+        EventType type;
+        std::string job_id;
+        std::string data; //!< JOB_SUBMITTED only: the event data, as json
+        double progress = 0; //!< JOB_KILLED only: the progress of the job when it was killed
+        long execution = -1; //!< JOB_COMPLETED only: the execution this completion belongs to
+        int for_what = 0; //!< JOB_KILLED only: the batsched_tools::KILL_TYPES of the kill
+        batsched_tools::CALL_ME_LATERS cml;
+    };
+    struct EventLater
+    {
+        bool operator()(const Event & a, const Event & b) const
+        {
+            return (a.date > b.date) || (a.date == b.date && a.order > b.order);
+        }
+    };
+    struct RunningJob
+    {
+        double start;
+        double runtime;
+        long execution;
+    };
+
+    void push(Event event);
+    /** @brief The events of a message, as the "events" array of a Batsim message */
+    void make_message(const std::vector<Event> & events, double date, bool begin, rapidjson::Document & message) const;
+    void apply_decisions(const rapidjson::Value & decisions, double date);
+    bool all_jobs_done() const;
+
+    Scheduler & _scheduler;
+    const SyntheticOptions & _options;
+    const std::vector<SyntheticJob> & _jobs;
+    std::string _output_folder;
+
+    std::priority_queue<Event, std::vector<Event>, EventLater> _events;
+    long _next_order = 0;
+    long _next_execution = 0;
+    std::unordered_map<std::string,double> _runtimes; //!< runtime of every job known by the simulator
+    std::unordered_map<std::string,RunningJob> _running;
+    int _nb_unfinished_jobs = 0; //!< submitted (or to be submitted) jobs not completed, killed or rejected yet
+    std::vector<double> _latencies;
+    SyntheticStats _stats;
+    double _total_waiting_time = 0;
+};
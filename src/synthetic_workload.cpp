@@ -0,0 +1,243 @@
+#include "synthetic_workload.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <loguru.hpp>
+
+#include "pempek_assert.hpp"
+#include "batsched_tools.hpp"
+
+using namespace std;
+
+string SyntheticJob::to_json_string() const
+{
+    //the job part mimics what Batsim sends on JOB_SUBMITTED, the members are the ones
+    //Workload::job_from_json_object() and SchedulingDecision::handle_resubmission() rely on
+    auto sep = id.find('!');
+    string profile_name = (sep == string::npos) ? id : id.substr(sep + 1);
+    return batsched_tools::string_format(
+        "{\"job_id\":\"%s\","
+        "\"job\":{\"id\":\"%s\",\"res\":%d,\"subtime\":%.15g,\"original_submit\":%.15g,\"original_start\":-1.0,"
+        "\"walltime\":%.15g,\"profile\":\"%s\",\"from_workload\":true,\"submission_times\":[%.15g]},"
+        "\"profile\":{\"type\":\"delay\",\"delay\":%.15g}}",
+        id.c_str(),
+        id.c_str(), nb_requested_resources, submission_time, submission_time,
+        walltime, profile_name.c_str(), submission_time,
+        runtime);
+}
+
+void SyntheticDistribution::from_json(const rapidjson::Value & json, const string & what)
+{
+    PPK_ASSERT_ERROR(json.IsObject(), "Invalid synthetic options: '%s' should be an object", what.c_str());
+    PPK_ASSERT_ERROR(json.HasMember("type") && json["type"].IsString(),
+                     "Invalid synthetic options: '%s' should have a string 'type' member", what.c_str());
+    type = json["type"].GetString();
+
+    auto get_number = [&json, &what](const char * member, double & value)
+    {
+        PPK_ASSERT_ERROR(json.HasMember(member), "Invalid synthetic options: '%s' of type '%s' needs a '%s' member",
+                         what.c_str(), json["type"].GetString(), member);
+        PPK_ASSERT_ERROR(json[member].IsNumber(), "Invalid synthetic options: '%s.%s' should be a number",
+                         what.c_str(), member);
+        value = json[member].GetDouble();
+    };
+
+    if (type == "constant")
+        get_number("value", value);
+    else if (type == "uniform" || type == "power_of_two")
+    {
+        get_number("min", min);
+        get_number("max", max);
+        PPK_ASSERT_ERROR(min <= max, "Invalid synthetic options: '%s' has min > max", what.c_str());
+    }
+    else if (type == "exponential")
+    {
+        get_number("mean", mean);
+        PPK_ASSERT_ERROR(mean > 0, "Invalid synthetic options: '%s.mean' should be strictly positive", what.c_str());
+    }
+    else if (type == "lognormal")
+    {
+        get_number("mu", mu);
+        get_number("sigma", sigma);
+    }
+    else
+        PPK_ASSERT_ERROR(false, "Invalid synthetic options: '%s' has an unknown type '%s'", what.c_str(), type.c_str());
+}
+
+double SyntheticDistribution::draw(mt19937 & generator) const
+{
+    if (type == "constant")
+        return value;
+    else if (type == "uniform")
+        return uniform_real_distribution<double>(min, max)(generator);
+    else if (type == "exponential")
+        return exponential_distribution<double>(1.0 / mean)(generator);
+    else if (type == "lognormal")
+        return lognormal_distribution<double>(mu, sigma)(generator);
+    else //power_of_two
+    {
+        int low = int(ceil(log2(std::max(min, 1.0))));
+        int high = int(floor(log2(std::max(max, 1.0))));
+        return pow(2.0, uniform_int_distribution<int>(low, std::max(low, high))(generator));
+    }
+}
+
+SyntheticOptions::SyntheticOptions()
+{
+    size.type = "uniform";
+    size.min = 1;
+    size.max = 16;
+    runtime.type = "exponential";
+    runtime.mean = 3600;
+    walltime_factor.type = "uniform";
+    walltime_factor.min = 1.0;
+    walltime_factor.max = 3.0;
+}
+
+void SyntheticOptions::from_json(const rapidjson::Value & json)
+{
+    PPK_ASSERT_ERROR(json.IsObject(), "Invalid synthetic options: not a JSON object");
+
+    auto get_double = [&json](const char * member, double & value)
+    {
+        if (json.HasMember(member))
+        {
+            PPK_ASSERT_ERROR(json[member].IsNumber(), "Invalid synthetic options: '%s' should be a number", member);
+            value = json[member].GetDouble();
+        }
+    };
+    auto get_int = [&json](const char * member, int & value)
+    {
+        if (json.HasMember(member))
+        {
+            PPK_ASSERT_ERROR(json[member].IsInt(), "Invalid synthetic options: '%s' should be an integer", member);
+            value = json[member].GetInt();
+        }
+    };
+    auto get_string = [&json](const char * member, string & value)
+    {
+        if (json.HasMember(member))
+        {
+            PPK_ASSERT_ERROR(json[member].IsString(), "Invalid synthetic options: '%s' should be a string", member);
+            value = json[member].GetString();
+        }
+    };
+
+    if (json.HasMember("seed"))
+    {
+        PPK_ASSERT_ERROR(json["seed"].IsUint(), "Invalid synthetic options: 'seed' should be an unsigned integer");
+        seed = json["seed"].GetUint();
+    }
+    get_string("workload_name", workload_name);
+
+    get_int("nb_machines", nb_machines);
+    get_int("core_count", core_count);
+    get_double("core_percent", core_percent);
+    if (json.HasMember("machine_prefix"))
+    {
+        machine_prefixes.clear();
+        machine_prefixes.push_back("");
+        get_string("machine_prefix", machine_prefixes[0]);
+    }
+    if (json.HasMember("machine_prefixes"))
+    {
+        PPK_ASSERT_ERROR(json["machine_prefixes"].IsArray() && !json["machine_prefixes"].Empty(),
+                         "Invalid synthetic options: 'machine_prefixes' should be a non-empty array of strings");
+        machine_prefixes.clear();
+        for (const rapidjson::Value & prefix : json["machine_prefixes"].GetArray())
+        {
+            PPK_ASSERT_ERROR(prefix.IsString(), "Invalid synthetic options: 'machine_prefixes' should be a non-empty array of strings");
+            machine_prefixes.push_back(prefix.GetString());
+        }
+    }
+    get_double("machine_speed", machine_speed);
+    PPK_ASSERT_ERROR(nb_machines > 0, "Invalid synthetic options: 'nb_machines' should be strictly positive");
+    PPK_ASSERT_ERROR((int)machine_prefixes.size() <= nb_machines,
+                     "Invalid synthetic options: more 'machine_prefixes' than 'nb_machines'");
+
+    get_int("nb_jobs", nb_jobs);
+    get_string("arrival", arrival);
+    get_double("arrival_rate", arrival_rate);
+    get_int("burst_size", burst_size);
+    get_double("burst_interval", burst_interval);
+    PPK_ASSERT_ERROR(arrival == "poisson" || arrival == "uniform" || arrival == "burst",
+                     "Invalid synthetic options: 'arrival' should be poisson, uniform or burst, not '%s'", arrival.c_str());
+    PPK_ASSERT_ERROR(arrival_rate > 0, "Invalid synthetic options: 'arrival_rate' should be strictly positive");
+    PPK_ASSERT_ERROR(burst_size > 0, "Invalid synthetic options: 'burst_size' should be strictly positive");
+    if (json.HasMember("size"))
+        size.from_json(json["size"], "size");
+    if (json.HasMember("runtime"))
+        runtime.from_json(json["runtime"], "runtime");
+    if (json.HasMember("walltime_factor"))
+        walltime_factor.from_json(json["walltime_factor"], "walltime_factor");
+    get_double("overrun_fraction", overrun_fraction);
+
+    get_double("MTBF", MTBF);
+    get_double("SMTBF", SMTBF);
+    get_double("fixed_failures", fixed_failures);
+    get_double("repair_time", repair_time);
+    get_double("MTTR", MTTR);
+    get_int("seed_failures", seed_failures);
+    get_int("seed_failure_machine", seed_failure_machine);
+    get_int("seed_repair_time", seed_repair_time);
+    if (json.HasMember("share_packing"))
+    {
+        PPK_ASSERT_ERROR(json["share_packing"].IsBool(), "Invalid synthetic options: 'share_packing' should be a boolean");
+        share_packing = json["share_packing"].GetBool();
+    }
+    get_int("queue_depth", queue_depth);
+    get_int("reject_jobs_after_nb_repairs", reject_jobs_after_nb_repairs);
+
+    get_double("max_simulated_time", max_simulated_time);
+}
+
+SyntheticWorkloadGenerator::SyntheticWorkloadGenerator(const SyntheticOptions & options) :
+    _options(options)
+{
+    //one generator per drawn quantity, so changing e.g. the size distribution does not change the arrivals
+    _generator_arrival.seed(options.seed);
+    _generator_size.seed(options.seed + 1);
+    _generator_runtime.seed(options.seed + 2);
+    _generator_walltime.seed(options.seed + 3);
+}
+
+double SyntheticWorkloadGenerator::next_submission_time(int job_index, double previous)
+{
+    if (_options.arrival == "poisson")
+        return previous + exponential_distribution<double>(_options.arrival_rate)(_generator_arrival);
+    else if (_options.arrival == "uniform")
+        return previous + 1.0 / _options.arrival_rate;
+    else //burst
+        return (job_index / _options.burst_size) * _options.burst_interval;
+}
+
+vector<SyntheticJob> SyntheticWorkloadGenerator::generate()
+{
+    vector<SyntheticJob> jobs;
+    jobs.reserve(_options.nb_jobs);
+    uniform_real_distribution<double> overrun(0.0, 1.0);
+    double date = 0;
+
+    for (int i = 0; i < _options.nb_jobs; ++i)
+    {
+        SyntheticJob job;
+        job.id = _options.workload_name + "!" + to_string(i);
+        date = next_submission_time(i, date);
+        job.submission_time = date;
+
+        int size = int(round(_options.size.draw(_generator_size)));
+        job.nb_requested_resources = std::min(std::max(size, 1), _options.nb_machines);
+
+        //Batsim works with whole seconds for delay profiles most of the time, keep it that way
+        job.runtime = std::max(1.0, round(_options.runtime.draw(_generator_runtime)));
+        double factor = std::max(_options.walltime_factor.draw(_generator_walltime), 1.0);
+        job.walltime = ceil(job.runtime * factor);
+        if (overrun(_generator_walltime) < _options.overrun_fraction)
+            job.walltime = std::max(1.0, floor(job.runtime / 2.0));
+
+        jobs.push_back(job);
+    }
+    LOG_F(INFO, "Generated %d synthetic jobs, last submission at %g", _options.nb_jobs, date);
+    return jobs;
+}
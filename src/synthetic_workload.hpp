@@ -0,0 +1,113 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <random>
+
+#include <rapidjson/document.h>
+
+/**
+ * @brief A job produced by the SyntheticWorkloadGenerator
+ */
+struct SyntheticJob
+{
+    std::string id; //!< The complete job identifier (workload!number)
+    int nb_requested_resources; //!< The number of machines requested
+    double submission_time; //!< The date at which the job is submitted
+    double runtime; //!< The real execution time of the job (delay profile)
+    double walltime; //!< The walltime given to the scheduler
+
+    std::string to_json_string() const; //!< The JOB_SUBMITTED data ({"job":...,"profile":...}) of this job
+};
+
+/**
+ * @brief A random distribution described in the synthetic options
+ * @details Described as a JSON object with a "type" member and type-dependent parameters:
+ *          {"type":"constant","value":v}, {"type":"uniform","min":a,"max":b},
+ *          {"type":"exponential","mean":m}, {"type":"lognormal","mu":mu,"sigma":s}
+ *          and {"type":"power_of_two","min":a,"max":b} (sizes only).
+ */
+struct SyntheticDistribution
+{
+    std::string type = "constant";
+    double value = 1.0;
+    double min = 1.0;
+    double max = 1.0;
+    double mean = 1.0;
+    double mu = 0.0;
+    double sigma = 1.0;
+
+    void from_json(const rapidjson::Value & json, const std::string & what);
+    double draw(std::mt19937 & generator) const;
+};
+
+/**
+ * @brief The knobs of a synthetic scale-testing scenario
+ * @details Every member has a default, so an empty JSON object is a valid scenario.
+ */
+struct SyntheticOptions
+{
+    unsigned long seed = 42;
+    std::string workload_name = "w0";
+
+    //platform
+    int nb_machines = 128;
+    int core_count = 1;
+    double core_percent = 1.0;
+    std::vector<std::string> machine_prefixes{"a"}; //!< the machines are split into one contiguous partition per prefix
+    double machine_speed = 1.0;
+
+    //jobs
+    int nb_jobs = 1000;
+    std::string arrival = "poisson"; //!< "poisson", "uniform" or "burst"
+    double arrival_rate = 0.1; //!< jobs per second for "poisson" and "uniform"
+    int burst_size = 100; //!< jobs per burst for "burst"
+    double burst_interval = 3600; //!< seconds between bursts for "burst"
+    SyntheticDistribution size;
+    SyntheticDistribution runtime;
+    SyntheticDistribution walltime_factor; //!< walltime = runtime * factor
+    double overrun_fraction = 0.0; //!< fraction of jobs whose runtime exceeds their walltime
+
+    //failures, forwarded to the scheduler exactly as Batsim would
+    double MTBF = -1.0;
+    double SMTBF = -1.0;
+    double fixed_failures = -1.0;
+    double repair_time = 0.0;
+    double MTTR = -1.0;
+    int seed_failures = 1;
+    int seed_failure_machine = 1;
+    int seed_repair_time = 1;
+    bool share_packing = false;
+    int queue_depth = -1;
+    int reject_jobs_after_nb_repairs = -1;
+
+    //simulation
+    double max_simulated_time = -1.0; //!< stops the simulation after this date if not -1
+
+    SyntheticOptions();
+    void from_json(const rapidjson::Value & json);
+};
+
+/**
+ * @brief Generates a reproducible stream of jobs from SyntheticOptions
+ */
+class SyntheticWorkloadGenerator
+{
+public:
+    SyntheticWorkloadGenerator(const SyntheticOptions & options);
+
+    /**
+     * @brief Generates all the jobs of the scenario, sorted by submission time
+     * @details The same options always give the same jobs, so several variants can be compared on the same input.
+     */
+    std::vector<SyntheticJob> generate();
+
+private:
+    double next_submission_time(int job_index, double previous);
+
+    const SyntheticOptions & _options;
+    std::mt19937 _generator_arrival;
+    std::mt19937 _generator_size;
+    std::mt19937 _generator_runtime;
+    std::mt19937 _generator_walltime;
+};
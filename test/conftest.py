@@ -42,6 +42,27 @@ def pytest_generate_tests(metafunc):
         ]
         metafunc.parametrize('one_basic_algo', algos)
 
+    if 'synth_algo' in metafunc.fixturenames:
+        algos = [
+            'conservative_bf',
+            'easy_bf3',
+            'easy_bf_fast2',
+            'fcfs_fast2'
+        ]
+        metafunc.parametrize('synth_algo', algos)
+
+    if 'energy_bf_algo' in metafunc.fixturenames:
+        algos = [
+            'energy_bf',
+            'energy_bf_dicho',
+            'energy_bf_idle_sleeper',
+            'energy_bf_monitoring',
+            'energy_bf_monitoring_inertial',
+            'energy_bf_subpart_sleeper',
+            'energy_watcher'
+        ]
+        metafunc.parametrize('energy_bf_algo', algos)
+
     if 'redis_enabled' in metafunc.fixturenames:
         metafunc.parametrize('redis_enabled', [True, False])
 
@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+import csv
+import os
+import subprocess
+
+from helper import *
+
+def schedule_results(export_prefix):
+    with open(f'{export_prefix}_schedule.csv') as f:
+        row = next(csv.DictReader(f))
+    # simulation_time and scheduling_time are wall clock times, they differ from one run to the other
+    return {key: row[key] for key in ['nb_jobs', 'nb_jobs_finished', 'nb_jobs_success', 'nb_jobs_killed',
+        'makespan', 'mean_waiting_time', 'max_turnaround_time']}
+
+def test_server_simulations(platform, workload, one_basic_algo):
+    # one batsched process serves two simulations, one after the other, on the same endpoint
+    algo = one_basic_algo
+    test_name = f'server-{algo}-{platform.name}-{workload.name}'
+    output_dir, robin_filename, _ = init_instance(test_name)
+
+    alone_prefix = f'{output_dir}/alone/out'
+    create_dir_rec_if_needed(os.path.dirname(alone_prefix))
+    instance = RobinInstance(output_dir=os.path.dirname(alone_prefix),
+        batcmd=gen_batsim_cmd(platform.filename, workload.filename, alone_prefix, ""),
+        schedcmd=f"batsched -v '{algo}'",
+        simulation_timeout=30, ready_timeout=5,
+        success_timeout=10, failure_timeout=0
+    )
+    instance.to_file(robin_filename)
+    ret = run_robin(robin_filename)
+    assert ret.returncode == 0
+
+    port = 28001
+    server = subprocess.Popen(['batsched', '-v', algo,
+        '--server-endpoint', f'tcp://*:{port}',
+        '--server-simulations', '2'])
+    try:
+        server_prefixes = [f'{output_dir}/server-{i}/out' for i in range(2)]
+        for prefix in server_prefixes:
+            create_dir_rec_if_needed(os.path.dirname(prefix))
+            batcmd = gen_batsim_cmd(platform.filename, workload.filename, prefix, f"-s 'tcp://localhost:{port}'")
+            ret = subprocess.run(batcmd, shell=True, timeout=30)
+            assert ret.returncode == 0
+        # the endpoint served its simulations: batsched exits
+        assert server.wait(timeout=10) == 0
+    finally:
+        if server.poll() is None:
+            server.kill()
+
+    reference = schedule_results(alone_prefix)
+    for prefix in server_prefixes:
+        assert schedule_results(prefix) == reference
@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+import json
+import subprocess
+
+from helper import *
+
+def run_synth(test_name, algo, synth_options, variant_options={}):
+    output_dir, _, _ = init_instance(test_name)
+    stats_filename = f'{output_dir}/stats.json'
+    ret = subprocess.run(['batsched-synth', '-v', algo,
+        '--synth_options', json.dumps(synth_options),
+        '--variant_options', json.dumps(variant_options),
+        '--output_folder', output_dir,
+        '--stats', stats_filename], timeout=60)
+    assert ret.returncode == 0
+    with open(stats_filename) as f:
+        stats = json.load(f)
+    assert len(stats) == 1
+    assert stats[0]['variant'] == algo
+    stats[0]['output_dir'] = f'{output_dir}/{algo}'
+    return stats[0]
+
+def test_synthetic_no_failures(synth_algo):
+    synth_options = {
+        "seed": 1, "nb_machines": 64, "nb_jobs": 200,
+        "arrival": "poisson", "arrival_rate": 0.05,
+        "size": {"type": "power_of_two", "min": 1, "max": 32},
+        "runtime": {"type": "uniform", "min": 60, "max": 1200}
+    }
+    stats = run_synth(f'synth-{synth_algo}-no-failures', synth_algo, synth_options)
+    assert stats['finished']
+    assert stats['nb_completed'] == 200
+    assert stats['nb_messages'] > 0
+    assert stats['latency_p50_us'] <= stats['latency_max_us']
+
+def test_synthetic_failures(synth_algo):
+    synth_options = {
+        "seed": 2, "nb_machines": 32, "nb_jobs": 100,
+        "arrival": "burst", "burst_size": 25, "burst_interval": 600,
+        "runtime": {"type": "exponential", "mean": 600},
+        "SMTBF": 3600, "repair_time": 60,
+        "max_simulated_time": 1000000
+    }
+    stats = run_synth(f'synth-{synth_algo}-failures', synth_algo, synth_options)
+    assert stats['finished']
+    assert stats['nb_call_me_laters'] > 0
+    # every job ends exactly once: completed, rejected, or killed without being resubmitted under a new id
+    assert stats['nb_resubmitted'] <= stats['nb_killed']
+    assert stats['nb_completed'] + stats['nb_rejected'] + stats['nb_killed'] - stats['nb_resubmitted'] == 100
+
+def test_synthetic_partitions(synth_algo):
+    # the failing machines and their repairs are spread over two machine prefixes
+    synth_options = {
+        "seed": 2, "nb_machines": 32, "nb_jobs": 100,
+        "machine_prefixes": ["a", "b"],
+        "arrival": "burst", "burst_size": 25, "burst_interval": 600,
+        "runtime": {"type": "exponential", "mean": 600},
+        "SMTBF": 1800, "repair_time": 60,
+        "max_simulated_time": 1000000
+    }
+    stats = run_synth(f'synth-{synth_algo}-partitions', synth_algo, synth_options)
+    assert stats['finished']
+    assert stats['nb_call_me_laters'] > 0
+    assert stats['nb_completed'] + stats['nb_rejected'] + stats['nb_killed'] - stats['nb_resubmitted'] == 100
+
+def test_synthetic_metrics(synth_algo):
+    synth_options = {
+        "seed": 3, "nb_machines": 32, "nb_jobs": 100,
+        "arrival": "poisson", "arrival_rate": 0.05,
+        "runtime": {"type": "uniform", "min": 60, "max": 1200}
+    }
+    variant_options = {"metrics": ["events", "counters"], "metrics_period": 600}
+    stats = run_synth(f'synth-{synth_algo}-metrics', synth_algo, synth_options, variant_options)
+    assert stats['nb_completed'] == 100
+    with open(f"{stats['output_dir']}/metrics_events.csv") as f:
+        rows = f.read().splitlines()[1:]
+    # one arrival, one start and one end per job
+    for trigger in ['A', 'S', 'E']:
+        assert len([row for row in rows if row.split(',')[1] == trigger]) == 100
+    with open(f"{stats['output_dir']}/metrics_counters.csv") as f:
+        assert len(f.read().splitlines()) > 1
+    # a METRICS wakeup changes no decision: conservative_bf answers it without make_decisions
+    assert stats['nb_skipped_decisions'] <= stats['nb_messages']
+    if synth_algo == 'conservative_bf':
+        assert stats['nb_skipped_decisions'] > 0
+    # the skipped calls would not have changed the schedule
+    reference = run_synth(f'synth-{synth_algo}-metrics-no-skip', synth_algo, synth_options,
+        dict(variant_options, skip_decisions=False))
+    assert reference['nb_skipped_decisions'] == 0
+    assert stats['makespan'] == reference['makespan']
+    assert stats['mean_waiting_time'] == reference['mean_waiting_time']
+
+def test_synthetic_state_metrics(synth_algo):
+    # the killed jobs leave the schedule before their kill is reported, the variants without a schedule have none:
+    # every running job still gets a stop
+    synth_options = {
+        "seed": 4, "nb_machines": 32, "nb_jobs": 100,
+        "arrival": "burst", "burst_size": 25, "burst_interval": 600,
+        "runtime": {"type": "exponential", "mean": 600},
+        "SMTBF": 3600, "repair_time": 60,
+        "max_simulated_time": 1000000
+    }
+    variant_options = {"metrics": ["state"], "metrics_period": 300}
+    stats = run_synth(f'synth-{synth_algo}-state', synth_algo, synth_options, variant_options)
+    assert stats['finished']
+    assert stats['nb_call_me_laters'] > 0
+    with open(f"{stats['output_dir']}/metrics_state.csv") as f:
+        rows = f.read().splitlines()[1:]
+    assert len(rows) > 0
+    for row in rows:
+        state = json.loads(row.split(';')[2])
+        assert all(job['stop'] > 0 for job in state['running'])
+        if synth_algo != 'conservative_bf':
+            assert state['queued'] == []
+
+def test_synthetic_decision_quantum(synth_algo):
+    synth_options = {
+        "seed": 5, "nb_machines": 32, "nb_jobs": 200,
+        "arrival": "poisson", "arrival_rate": 0.5,
+        "runtime": {"type": "uniform", "min": 60, "max": 1200}
+    }
+    variant_options = {"decision_quantum": 30, "metrics": ["counters"], "metrics_period": 600}
+    stats = run_synth(f'synth-{synth_algo}-quantum', synth_algo, synth_options, variant_options)
+    # the deferred submissions are still decided, at the end of their quantum
+    assert stats['nb_completed'] == 200
+    assert stats['nb_deferred_decisions'] > 0
+    with open(f"{stats['output_dir']}/metrics_counters.csv") as f:
+        rows = f.read().splitlines()
+    header = rows[0].split(',')
+    last = dict(zip(header, rows[-1].split(',')))
+    assert float(last['max_decision_delay']) <= 30
+
+def test_synthetic_decision_quantum_at_walltime_ends():
+    # walltimes equal to runtimes: the completions come when the present leaves the first time slice of
+    # conservative_bf, they cannot wait for the end of the quantum
+    synth_options = {
+        "seed": 5, "nb_machines": 32, "nb_jobs": 200,
+        "arrival": "poisson", "arrival_rate": 0.5,
+        "runtime": {"type": "uniform", "min": 60, "max": 1200},
+        "walltime_factor": {"type": "constant", "value": 1}
+    }
+    variant_options = {"decision_quantum": 30, "metrics": ["counters"], "metrics_period": 600}
+    stats = run_synth('synth-conservative_bf-quantum-walltime-ends', 'conservative_bf', synth_options, variant_options)
+    assert stats['finished']
+    assert stats['nb_completed'] == 200
+    assert stats['nb_deferred_decisions'] > 0
+    with open(f"{stats['output_dir']}/metrics_counters.csv") as f:
+        rows = f.read().splitlines()
+    header = rows[0].split(',')
+    last = dict(zip(header, rows[-1].split(',')))
+    assert float(last['max_decision_delay']) <= 30
+
+def test_synthetic_speculation(synth_algo):
+    # walltimes equal to runtimes: the first completions of the schedule are the ones that happen
+    synth_options = {
+        "seed": 6, "nb_machines": 32, "nb_jobs": 200,
+        "arrival": "poisson", "arrival_rate": 0.05,
+        "runtime": {"type": "uniform", "min": 60, "max": 1200},
+        "walltime_factor": {"type": "constant", "value": 1}
+    }
+    reference = run_synth(f'synth-{synth_algo}-no-speculation', synth_algo, synth_options)
+    stats = run_synth(f'synth-{synth_algo}-speculation', synth_algo, synth_options, {"speculation": True})
+    # a precomputed decision is only used when it is the one that would have been made
+    assert stats['nb_completed'] == 200
+    assert stats['makespan'] == reference['makespan']
+    assert stats['mean_waiting_time'] == reference['mean_waiting_time']
+    assert stats['nb_speculation_hits'] <= stats['nb_speculations']
+    if synth_algo == 'conservative_bf':
+        assert stats['nb_speculation_hits'] > 0
+
+def test_synthetic_schedulers_in_one_process():
+    # batsched-synth drives one Scheduler per variant in the same process: they must not share any state
+    synth_options = {
+        "seed": 7, "nb_machines": 32, "nb_jobs": 100,
+        "arrival": "poisson", "arrival_rate": 0.05,
+        "runtime": {"type": "uniform", "min": 60, "max": 1200},
+        "SMTBF": 3600, "repair_time": 60,
+        "max_simulated_time": 1000000
+    }
+    algos = ['conservative_bf', 'easy_bf_fast2', 'conservative_bf']
+    output_dir, _, _ = init_instance('synth-schedulers-in-one-process')
+    stats_filename = f'{output_dir}/stats.json'
+    ret = subprocess.run(['batsched-synth', '-v', ','.join(algos),
+        '--synth_options', json.dumps(synth_options),
+        '--output_folder', output_dir,
+        '--stats', stats_filename], timeout=60)
+    assert ret.returncode == 0
+    with open(stats_filename) as f:
+        stats = json.load(f)
+    assert [s['variant'] for s in stats] == algos
+    for algo, together in zip(algos, stats):
+        alone = run_synth(f'synth-{algo}-alone', algo, synth_options)
+        for key in ['finished', 'makespan', 'mean_waiting_time', 'nb_completed', 'nb_killed', 'nb_resubmitted']:
+            assert together[key] == alone[key]
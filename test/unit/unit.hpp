@@ -0,0 +1,43 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+#include "pempek_assert.hpp"
+
+// Unit tests of the scheduling core (batsched-unit), run by `meson test`.
+// A test checks with PPK_ASSERT_ERROR, so it stops at the first check that fails.
+// unit_main.cpp runs every test, reports the failed ones and fails if any did.
+
+namespace unit
+{
+    struct Test
+    {
+        std::string name;
+        std::function<void()> function;
+    };
+
+    /**
+     * @brief A new empty folder for the files the variants of a test write, with their out and log subfolders
+     */
+    std::string output_folder(const std::string & test_name);
+
+    /** @brief The path of a data file (topology...) given relative to the test folder of the sources */
+    std::string data_file(const std::string & relative_path);
+
+    /**
+     * @brief Appends an event to events, the "events" array of a Batsim message
+     * @param[in] data The data of the event, as a JSON object
+     */
+    void add_event(rapidjson::Document & events, double date, const std::string & type, const std::string & data);
+    /** @brief The events of a given type among the events of a Batsim message */
+    std::vector<const rapidjson::Value *> events_of_type(const rapidjson::Value & events, const std::string & type);
+
+    void add_locality_tests(std::vector<Test> & tests);
+    void add_metrics_tests(std::vector<Test> & tests);
+    void add_schedule_tests(std::vector<Test> & tests);
+    void add_shared_data_tests(std::vector<Test> & tests);
+}
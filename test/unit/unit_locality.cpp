@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+#include "json_workload.hpp"
+#include "locality.hpp"
+#include "scheduler.hpp"
+#include "synthetic_simulator.hpp"
+#include "unit.hpp"
+
+using namespace std;
+namespace r = rapidjson;
+
+namespace
+{
+    Job make_job(int nb_resources)
+    {
+        Job job;
+        job.id = "w0!" + std::to_string(nb_resources);
+        job.nb_requested_resources = nb_resources;
+        return job;
+    }
+
+    IntervalSet interval(int lower, int upper)
+    {
+        return IntervalSet(IntervalSet::ClosedInterval(lower, upper));
+    }
+
+    void free_block_index_split_and_coalesce()
+    {
+        FreeBlockIndex index;
+        index.assign(interval(0, 3) + interval(8, 15));
+        PPK_ASSERT_ERROR(index.nb_free() == 12 && index.nb_blocks() == 2 && index.largest_block() == 8);
+
+        index.remove(interval(10, 11));
+        PPK_ASSERT_ERROR(index.nb_free() == 10 && index.nb_blocks() == 3 && index.largest_block() == 4);
+
+        //4-7 joins 0-3 and 8-9 into one block
+        index.insert(interval(4, 7));
+        PPK_ASSERT_ERROR(index.nb_free() == 14 && index.nb_blocks() == 2 && index.largest_block() == 10);
+        PPK_ASSERT_ERROR(index.fragmentation() == 1.0 - 10.0 / 14.0);
+        PPK_ASSERT_ERROR(index.fragmentation() == FreeBlockIndex::fragmentation(interval(0, 9) + interval(12, 15)));
+
+        bool inserted_twice = true;
+        try
+        {
+            index.insert(interval(9, 10));
+        }
+        catch (const pempek::assert::AssertionException &)
+        {
+            inserted_twice = false;
+        }
+        PPK_ASSERT_ERROR(!inserted_twice, "Machines already free were inserted again");
+
+        index.remove(interval(0, 15));
+        PPK_ASSERT_ERROR(index.nb_free() == 0 && index.nb_blocks() == 0 && index.fragmentation() == 0);
+    }
+
+    void best_fit_takes_the_smallest_block()
+    {
+        FreeBlockIndex index;
+        index.assign(interval(0, 1) + interval(4, 8) + interval(12, 14));
+        IntervalSet allocated;
+
+        PPK_ASSERT_ERROR(index.best_fit(3, allocated) && allocated == interval(12, 14), "%s", allocated.to_string_hyphen().c_str());
+        PPK_ASSERT_ERROR(index.best_fit(2, allocated) && allocated == interval(0, 1), "%s", allocated.to_string_hyphen().c_str());
+        //no block left can hold 6 machines: nothing is taken
+        PPK_ASSERT_ERROR(!index.best_fit(6, allocated));
+        PPK_ASSERT_ERROR(index.nb_free() == 5 && index.nb_blocks() == 1);
+        PPK_ASSERT_ERROR(index.best_fit(4, allocated) && allocated == interval(4, 7), "%s", allocated.to_string_hyphen().c_str());
+    }
+
+    void best_fit_breaks_ties_on_the_lowest_block()
+    {
+        BestFitResourceSelector selector;
+        const IntervalSet available = interval(10, 12) + interval(0, 2) + interval(5, 7);
+        Job job = make_job(3);
+        IntervalSet allocated;
+
+        PPK_ASSERT_ERROR(selector.fit(&job, available, allocated) && allocated == interval(0, 2), "%s", allocated.to_string_hyphen().c_str());
+        //the usual next call, without the machines just allocated
+        PPK_ASSERT_ERROR(selector.fit(&job, available - allocated, allocated) && allocated == interval(5, 7), "%s", allocated.to_string_hyphen().c_str());
+        Job large = make_job(4);
+        PPK_ASSERT_ERROR(!selector.fit(&large, available, allocated));
+    }
+
+    void best_fit_follows_changing_available_sets()
+    {
+        //the available sets of successive time slices: a fresh selector on each set is the reference
+        mt19937 generator(42);
+        uniform_int_distribution<int> machine(0, 127);
+        uniform_int_distribution<int> length(1, 8);
+        uniform_int_distribution<int> size(1, 12);
+        BestFitResourceSelector selector;
+        IntervalSet available = interval(0, 127);
+        for (int step = 0; step < 2000; ++step)
+        {
+            int lower = machine(generator);
+            IntervalSet changed = interval(lower, std::min(127, lower + length(generator) - 1));
+            if (step % 2 == 0)
+                available -= changed;
+            else
+                available += changed;
+
+            Job job = make_job(size(generator));
+            IntervalSet allocated;
+            IntervalSet expected;
+            BestFitResourceSelector fresh;
+            bool fits = selector.fit(&job, available, allocated);
+            PPK_ASSERT_ERROR(fits == fresh.fit(&job, available, expected), "step %d", step);
+            PPK_ASSERT_ERROR(!fits || allocated == expected, "step %d: %s instead of %s", step,
+                             allocated.to_string_hyphen().c_str(), expected.to_string_hyphen().c_str());
+            PPK_ASSERT_ERROR(selector.fragmentation() == FreeBlockIndex::fragmentation(fits ? available - allocated : available),
+                             "step %d", step);
+            //a slice without the allocated machines comes next half of the time, as in the schedule
+            if (fits && step % 4 < 2)
+                available -= allocated;
+        }
+    }
+
+    //test/topologies/two_racks.json: switches of 8 machines, racks of 2 switches
+    const int switch_level = 0;
+    const int rack_level = 1;
+
+    void topology_fills_the_fullest_group_that_fits()
+    {
+        TopologyResourceSelector selector(unit::data_file("topologies/two_racks.json"));
+        PPK_ASSERT_ERROR(selector.nb_levels() == 2);
+        //0-5 are busy: the first switch has 2 free machines, the others 8
+        IntervalSet available = interval(6, 31);
+        IntervalSet allocated;
+
+        Job two = make_job(2);
+        PPK_ASSERT_ERROR(selector.fit(&two, available, allocated) && allocated == interval(6, 7), "%s", allocated.to_string_hyphen().c_str());
+        available -= allocated;
+
+        //no switch can hold 12 machines, the second rack can
+        Job twelve = make_job(12);
+        PPK_ASSERT_ERROR(selector.fit(&twelve, available, allocated) && allocated == interval(16, 27), "%s", allocated.to_string_hyphen().c_str());
+        PPK_ASSERT_ERROR(selector.nb_groups_spanned(allocated, rack_level) == 1);
+        PPK_ASSERT_ERROR(selector.nb_groups_spanned(allocated, switch_level) == 2);
+        available -= allocated;
+
+        //8-15 and 28-31 are left: the 5 machines go in the second switch, the only one that can hold them
+        Job five = make_job(5);
+        PPK_ASSERT_ERROR(selector.fit(&five, available, allocated) && allocated == interval(8, 12), "%s", allocated.to_string_hyphen().c_str());
+
+        //larger than any rack: both racks are used, the second one for what the first cannot hold
+        Job twenty = make_job(20);
+        PPK_ASSERT_ERROR(selector.fit(&twenty, interval(0, 31), allocated), "%s", allocated.to_string_hyphen().c_str());
+        PPK_ASSERT_ERROR(selector.nb_groups_spanned(allocated, rack_level) == 2);
+        PPK_ASSERT_ERROR(selector.nb_groups_spanned(allocated, switch_level) == 3);
+    }
+
+    void topology_stays_in_one_group_when_possible()
+    {
+        TopologyResourceSelector selector(unit::data_file("topologies/two_racks.json"));
+        const vector<IntervalSet> switches = {interval(0, 7), interval(8, 15), interval(16, 23), interval(24, 31)};
+        const vector<IntervalSet> racks = {interval(0, 15), interval(16, 31)};
+        auto largest_free = [](const vector<IntervalSet> & groups, const IntervalSet & available)
+        {
+            unsigned int largest = 0;
+            for (const IntervalSet & group : groups)
+                largest = std::max(largest, (group & available).size());
+            return (int)largest;
+        };
+
+        mt19937 generator(7);
+        uniform_int_distribution<int> machine(0, 31);
+        uniform_int_distribution<int> length(1, 6);
+        uniform_int_distribution<int> size(1, 20);
+        IntervalSet available = interval(0, 31);
+        for (int step = 0; step < 2000; ++step)
+        {
+            int lower = machine(generator);
+            IntervalSet changed = interval(lower, std::min(31, lower + length(generator) - 1));
+            if (step % 2 == 0)
+                available -= changed;
+            else
+                available += changed;
+
+            Job job = make_job(size(generator));
+            IntervalSet allocated;
+            if (!selector.fit(&job, available, allocated))
+            {
+                PPK_ASSERT_ERROR(job.nb_requested_resources > (int)available.size(), "step %d", step);
+                continue;
+            }
+            PPK_ASSERT_ERROR(allocated.size() == (unsigned int)job.nb_requested_resources && allocated.is_subset_of(available),
+                             "step %d: %s", step, allocated.to_string_hyphen().c_str());
+            if (job.nb_requested_resources <= largest_free(switches, available))
+                PPK_ASSERT_ERROR(selector.nb_groups_spanned(allocated, switch_level) == 1,
+                                 "step %d: %s spans several switches", step, allocated.to_string_hyphen().c_str());
+            else if (job.nb_requested_resources <= largest_free(racks, available))
+                PPK_ASSERT_ERROR(selector.nb_groups_spanned(allocated, rack_level) == 1,
+                                 "step %d: %s spans several racks", step, allocated.to_string_hyphen().c_str());
+            if (step % 4 < 2)
+                available -= allocated;
+        }
+    }
+
+    void fragmentation_notification()
+    {
+        SyntheticOptions options;
+        options.nb_machines = 8;
+        const string folder = unit::output_folder("fragmentation_notification");
+
+        SchedulerOptions scheduler_options;
+        scheduler_options.variant = "conservative_bf";
+        scheduler_options.selection_policy = "best_fit";
+        scheduler_options.variant_options = "{\"schedule_notifications\":[\"fragmentation\"]}";
+        Scheduler scheduler(scheduler_options);
+
+        r::Document events;
+        unit::add_event(events, 0, "SIMULATION_BEGINS", SyntheticSimulator::simulation_begins_data(options, folder));
+        unit::add_event(events, 0, "JOB_SUBMITTED", SyntheticJob{"w0!1", 2, 0, 10, 10}.to_json_string());
+        unit::add_event(events, 0, "JOB_SUBMITTED", SyntheticJob{"w0!2", 3, 0, 100, 100}.to_json_string());
+        const r::Value & decisions = scheduler.decide(0, events);
+        auto executed = unit::events_of_type(decisions, "EXECUTE_JOB");
+        PPK_ASSERT_ERROR(executed.size() == 2);
+        PPK_ASSERT_ERROR(string((*executed[0])["data"]["alloc"].GetString()) == "0-1");
+        PPK_ASSERT_ERROR(string((*executed[1])["data"]["alloc"].GetString()) == "2-4");
+
+        //w0!1 ends: 0-1 and 5-7 are free, the largest block holds 3 of the 5 free machines
+        r::Document completion;
+        unit::add_event(completion, 10, "JOB_COMPLETED", "{\"job_id\":\"w0!1\",\"job_state\":\"COMPLETED_SUCCESSFULLY\"}");
+        bool notified = false;
+        for (const r::Value * notify : unit::events_of_type(scheduler.decide(10, completion), "NOTIFY"))
+        {
+            if (string((*notify)["data"]["type"].GetString()) != "fragmentation")
+                continue;
+            notified = true;
+            PPK_ASSERT_ERROR(std::stod((*notify)["data"]["data"].GetString()) == 0.4, "%s", (*notify)["data"]["data"].GetString());
+        }
+        PPK_ASSERT_ERROR(notified, "No fragmentation notification");
+    }
+}
+
+void unit::add_locality_tests(vector<Test> & tests)
+{
+    tests.push_back({"locality/free_block_index_split_and_coalesce", free_block_index_split_and_coalesce});
+    tests.push_back({"locality/best_fit_takes_the_smallest_block", best_fit_takes_the_smallest_block});
+    tests.push_back({"locality/best_fit_breaks_ties_on_the_lowest_block", best_fit_breaks_ties_on_the_lowest_block});
+    tests.push_back({"locality/best_fit_follows_changing_available_sets", best_fit_follows_changing_available_sets});
+    tests.push_back({"locality/topology_fills_the_fullest_group_that_fits", topology_fills_the_fullest_group_that_fits});
+    tests.push_back({"locality/topology_stays_in_one_group_when_possible", topology_stays_in_one_group_when_possible});
+    tests.push_back({"locality/fragmentation_notification", fragmentation_notification});
+}
@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <exception>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+#include <loguru.hpp>
+
+#include "external/taywee_args.hpp"
+#include "pempek_assert.hpp"
+#include "unit.hpp"
+#if __has_include(<filesystem>)
+#include <filesystem>
+namespace fs = std::filesystem;
+#elif __has_include(<experimental/filesystem>)
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+
+using namespace std;
+namespace r = rapidjson;
+
+static string root_folder = "/tmp/batsched-unit";
+static string data_folder = "test";
+
+string unit::output_folder(const string & test_name)
+{
+    string folder = root_folder + "/" + test_name;
+    fs::remove_all(folder);
+    fs::create_directories(folder + "/out");
+    fs::create_directories(folder + "/log");
+    return folder;
+}
+
+void unit::add_event(r::Document & events, double date, const string & type, const string & data)
+{
+    if (!events.IsArray())
+        events.SetArray();
+    r::Document::AllocatorType & alloc = events.GetAllocator();
+    r::Document data_doc;
+    data_doc.Parse(data.c_str());
+    PPK_ASSERT_ERROR(!data_doc.HasParseError() && data_doc.IsObject(), "Invalid event data '%s'", data.c_str());
+
+    r::Value event(r::kObjectType);
+    event.AddMember("timestamp", r::Value().SetDouble(date), alloc);
+    event.AddMember("type", r::Value(type.c_str(), alloc), alloc);
+    r::Value event_data;
+    event_data.CopyFrom(data_doc, alloc);
+    event.AddMember("data", event_data, alloc);
+    events.PushBack(event, alloc);
+}
+
+string unit::data_file(const string & relative_path)
+{
+    return data_folder + "/" + relative_path;
+}
+
+vector<const r::Value *> unit::events_of_type(const r::Value & events, const string & type)
+{
+    vector<const r::Value *> found;
+    for (const r::Value & event : events.GetArray())
+        if (type == event["type"].GetString())
+            found.push_back(&event);
+    return found;
+}
+
+int main(int argc, char ** argv)
+{
+    args::ArgumentParser parser("Unit tests of the batsched scheduling core.");
+    args::HelpFlag flag_help(parser, "help", "Display this help menu", {'h', "help"});
+    args::ValueFlag<string> flag_filter(parser, "filter", "Only runs the tests whose name contains this string", {'f', "filter"}, "");
+    args::ValueFlag<string> flag_output_folder(parser, "folder", "Folder where the tests write their output files.", {'o', "output_folder"}, root_folder);
+    args::ValueFlag<string> flag_data_folder(parser, "folder", "Folder of the test data files (the test folder of the sources).", {'d', "data_folder"}, data_folder);
+    args::Flag flag_list(parser, "list", "Lists the tests and exits", {"list"});
+
+    try
+    {
+        parser.ParseCLI(argc, argv);
+    }
+    catch(args::Help&)
+    {
+        parser.helpParams.addDefault = true;
+        printf("%s", parser.Help().c_str());
+        return 0;
+    }
+    catch(args::ParseError & e)
+    {
+        printf("%s\n", e.what());
+        return 1;
+    }
+    // The variants log a lot at INFO level
+    loguru::g_stderr_verbosity = loguru::Verbosity_OFF;
+    root_folder = flag_output_folder.Get();
+    data_folder = flag_data_folder.Get();
+
+    vector<unit::Test> tests;
+    unit::add_locality_tests(tests);
+    unit::add_metrics_tests(tests);
+    unit::add_schedule_tests(tests);
+    unit::add_shared_data_tests(tests);
+
+    if (flag_list)
+    {
+        for (const unit::Test & test : tests)
+            printf("%s\n", test.name.c_str());
+        return 0;
+    }
+
+    int nb_run = 0;
+    int nb_failed = 0;
+    for (const unit::Test & test : tests)
+    {
+        if (test.name.find(flag_filter.Get()) == string::npos)
+            continue;
+        ++nb_run;
+        try
+        {
+            test.function();
+            printf("ok     %s\n", test.name.c_str());
+        }
+        catch (const pempek::assert::AssertionException & e)
+        {
+            ++nb_failed;
+            printf("FAILED %s: %s (%s:%d)\n", test.name.c_str(), e.what(), e.file(), e.line());
+        }
+        catch (const std::exception & e)
+        {
+            ++nb_failed;
+            printf("FAILED %s: %s\n", test.name.c_str(), e.what());
+        }
+    }
+    printf("%d tests, %d failed\n", nb_run, nb_failed);
+    return nb_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+#include "batsched_tools.hpp"
+#include "scheduler.hpp"
+#include "synthetic_simulator.hpp"
+#include "unit.hpp"
+
+using namespace std;
+namespace r = rapidjson;
+
+namespace
+{
+    //the rows of a metrics file, without its header
+    vector<string> read_rows(const string & filename)
+    {
+        ifstream file(filename);
+        PPK_ASSERT_ERROR(file.is_open(), "Couldn't open '%s'", filename.c_str());
+        vector<string> rows;
+        string line;
+        getline(file, line);
+        while (getline(file, line))
+            rows.push_back(line);
+        return rows;
+    }
+
+    //the state sampled at 100 by a variant on 8 machines: w0!1 runs from 0 to its walltime 500 at most,
+    //w0!2 needs every machine and waits for it
+    r::Document sampled_state(const string & variant, const string & test_name)
+    {
+        SyntheticOptions options;
+        options.nb_machines = 8;
+        const string folder = unit::output_folder(test_name);
+
+        SchedulerOptions scheduler_options;
+        scheduler_options.variant = variant;
+        scheduler_options.variant_options = "{\"metrics\":[\"state\"],\"metrics_period\":100}";
+        Scheduler scheduler(scheduler_options);
+
+        r::Document events;
+        unit::add_event(events, 0, "SIMULATION_BEGINS", SyntheticSimulator::simulation_begins_data(options, folder));
+        unit::add_event(events, 0, "JOB_SUBMITTED", SyntheticJob{"w0!1", 2, 0, 400, 500}.to_json_string());
+        unit::add_event(events, 0, "JOB_SUBMITTED", SyntheticJob{"w0!2", 8, 0, 300, 300}.to_json_string());
+        const r::Value & decisions = scheduler.decide(0, events);
+        PPK_ASSERT_ERROR(unit::events_of_type(decisions, "EXECUTE_JOB").size() == 1);
+
+        //the state is sampled by the metrics wakeup at the end of the first period
+        const r::Value * wakeup = nullptr;
+        for (const r::Value * call : unit::events_of_type(decisions, "CALL_ME_LATER"))
+            if ((*call)["data"]["forWhat"].GetInt() == static_cast<int>(batsched_tools::call_me_later_types::METRICS))
+                wakeup = call;
+        PPK_ASSERT_ERROR(wakeup != nullptr, "No metrics wakeup requested");
+        PPK_ASSERT_ERROR((*wakeup)["data"]["timestamp"].GetDouble() == 100, "%f", (*wakeup)["data"]["timestamp"].GetDouble());
+
+        r::Document requested_call;
+        unit::add_event(requested_call, 100, "REQUESTED_CALL",
+                        batsched_tools::string_format("{\"id\":%d,\"forWhat\":%d,\"extra_data\":\"%s\"}",
+                                                      (*wakeup)["data"]["id"].GetInt(), (*wakeup)["data"]["forWhat"].GetInt(),
+                                                      (*wakeup)["data"]["extra_data"].GetString()));
+        scheduler.decide(100, requested_call);
+
+        vector<string> rows = read_rows(folder + "/metrics_state.csv");
+        PPK_ASSERT_ERROR(rows.size() == 1, "%d rows", (int)rows.size());
+        //sim_time;hour;state
+        size_t state_begin = rows[0].find(';', rows[0].find(';') + 1) + 1;
+        PPK_ASSERT_ERROR(rows[0].substr(0, state_begin) == "100.000000;1;", "%s", rows[0].c_str());
+        r::Document state;
+        state.Parse(rows[0].substr(state_begin).c_str());
+        PPK_ASSERT_ERROR(!state.HasParseError(), "%s", rows[0].c_str());
+        return state;
+    }
+
+    void state_rows()
+    {
+        r::Document state = sampled_state("conservative_bf", "state_rows");
+        //the stop of a running job is its predicted end in the schedule, like the start and stop of the queued jobs
+        const r::Value & running = state["running"];
+        PPK_ASSERT_ERROR(running.Size() == 1 && running[0]["id"].GetInt() == 1 && running[0]["stop"].GetDouble() == 500);
+        const r::Value & queued = state["queued"];
+        PPK_ASSERT_ERROR(queued.Size() == 1 && queued[0]["id"].GetInt() == 2 && queued[0]["start"].GetDouble() == 500
+                         && queued[0]["stop"].GetDouble() == 800);
+    }
+
+    void state_rows_without_schedule()
+    {
+        r::Document state = sampled_state("easy_bf_fast2", "state_rows_without_schedule");
+        //no schedule: a running job stops at its start plus its walltime, no queued job has a predicted start
+        const r::Value & running = state["running"];
+        PPK_ASSERT_ERROR(running.Size() == 1 && running[0]["id"].GetInt() == 1 && running[0]["stop"].GetDouble() == 500);
+        PPK_ASSERT_ERROR(state["queued"].Size() == 0);
+    }
+}
+
+void unit::add_metrics_tests(vector<Test> & tests)
+{
+    tests.push_back({"metrics/state_rows", state_rows});
+    tests.push_back({"metrics/state_rows_without_schedule", state_rows_without_schedule});
+}
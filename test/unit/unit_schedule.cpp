@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "json_workload.hpp"
+#include "locality.hpp"
+#include "schedule.hpp"
+#include "unit.hpp"
+
+using namespace std;
+
+namespace
+{
+    //the jobs of a test, deleted with their allocations once the schedules that reference them are gone
+    class Jobs
+    {
+    public:
+        ~Jobs()
+        {
+            for (Job * job : _jobs)
+            {
+                for (auto & alloc : job->allocations)
+                    delete alloc.second;
+                delete job;
+            }
+        }
+
+        Job * make(int nb_resources, double walltime)
+        {
+            Job * job = new Job;
+            job->id = "w0!" + std::to_string(_jobs.size());
+            job->unique_number = (int)_jobs.size();
+            job->nb_requested_resources = nb_resources;
+            job->walltime = walltime;
+            job->has_walltime = true;
+            job->checkpoint_job_data = nullptr;
+            _jobs.push_back(job);
+            return job;
+        }
+
+    private:
+        vector<Job *> _jobs;
+    };
+
+    //a date in the first half of the first slice, or of its first 600 seconds if it is the last slice
+    Rational date_in_first_slice(Schedule & schedule, double fraction)
+    {
+        Rational begin = schedule.begin()->begin;
+        Rational end = schedule.begin()->end;
+        if (end > schedule.finite_horizon())
+            end = begin + 600;
+        return begin + (end - begin) * Rational(fraction / 2);
+    }
+
+    //the liquid load dates of the prefix schedule keeps up to date, against a copy that builds its prefix from scratch
+    void check_liquid_load_dates(const Schedule & schedule, int nb_machines, mt19937 & generator, int step)
+    {
+        Schedule fresh = schedule;
+        double begin = (double)schedule.first_slice_begin();
+        double horizon = (double)schedule.finite_horizon();
+        uniform_real_distribution<double> date(begin, horizon + 1);
+        uniform_real_distribution<double> area(0, (horizon + 1 - begin) * nb_machines);
+        for (int i = 0; i < 8; ++i)
+        {
+            double starting_time = std::min(date(generator), horizon);
+            double work = area(generator);
+            double cached = schedule.liquid_load_date(work, starting_time);
+            double expected = fresh.liquid_load_date(work, starting_time);
+            //both sums are in double precision, from different origins
+            PPK_ASSERT_ERROR(cached == expected || std::abs(cached - expected) <= 1e-9 * std::max(1.0, std::abs(expected)),
+                             "step %d: liquid_load_date(%f, %f) is %f instead of %f", step, work, starting_time, cached, expected);
+        }
+    }
+
+    void liquid_load_date_follows_the_schedule()
+    {
+        const int nb_machines = 32;
+        Jobs jobs;
+        Schedule schedule(nb_machines, 0);
+        BasicResourceSelector selector;
+        mt19937 generator(3);
+        uniform_int_distribution<int> size(1, nb_machines);
+        uniform_real_distribution<double> walltime(60, 3600);
+        uniform_real_distribution<double> unit_interval(0, 1);
+        uniform_int_distribution<int> operation(0, 4);
+        vector<const Job *> scheduled;
+
+        for (int step = 0; step < 1000; ++step)
+        {
+            switch (operation(generator))
+            {
+            case 0:
+            {
+                const Job * job = jobs.make(size(generator), walltime(generator));
+                schedule.add_job_first_fit(job, &selector);
+                scheduled.push_back(job);
+                break;
+            }
+            case 1:
+            {
+                if (scheduled.empty())
+                    break;
+                auto job = scheduled.begin() + (size_t)(unit_interval(generator) * scheduled.size());
+                schedule.remove_job(*job);
+                scheduled.erase(job);
+                break;
+            }
+            case 2:
+            {
+                //time moves forward inside the first slice, as between two decisions
+                schedule.update_first_slice(date_in_first_slice(schedule, unit_interval(generator)));
+                break;
+            }
+            case 3:
+            {
+                //a reservation probe splits the slices at its start and end
+                Job * reservation = jobs.make(size(generator), walltime(generator));
+                reservation->purpose = "reservation";
+                double begin = (double)schedule.first_slice_begin();
+                reservation->start = begin + 1 + unit_interval(generator) * ((double)schedule.finite_horizon() - begin);
+                Schedule::ReservedTimeSlice reserved = schedule.reserve_time_slice(reservation);
+                if (reserved.success)
+                    delete reserved.alloc;
+                break;
+            }
+            case 4:
+            {
+                //a what-if: the prefix must not keep what was rolled back
+                schedule.liquid_load_date(1, (double)schedule.first_slice_begin());
+                schedule.begin_transaction();
+                schedule.add_job_first_fit(jobs.make(size(generator), walltime(generator)), &selector);
+                schedule.update_first_slice(date_in_first_slice(schedule, unit_interval(generator)));
+                schedule.liquid_load_date(1, (double)schedule.first_slice_begin());
+                schedule.rollback();
+                break;
+            }
+            }
+            check_liquid_load_dates(schedule, nb_machines, generator, step);
+        }
+    }
+}
+
+void unit::add_schedule_tests(vector<Test> & tests)
+{
+    tests.push_back({"schedule/liquid_load_date_follows_the_schedule", liquid_load_date_follows_the_schedule});
+}
@@ -0,0 +1,148 @@
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+#include "machine.hpp"
+#include "scheduler.hpp"
+#include "shared_data.hpp"
+#include "synthetic_simulator.hpp"
+#include "unit.hpp"
+
+using namespace std;
+namespace r = rapidjson;
+
+namespace
+{
+    //8 machines of 4 cores, a0-a3 then b4-b7
+    r::Document simulation_begins_data()
+    {
+        SyntheticOptions options;
+        options.nb_machines = 8;
+        options.core_count = 4;
+        options.machine_prefixes = {"a", "b"};
+        r::Document data;
+        data.Parse(SyntheticSimulator::simulation_begins_data(options, unit::output_folder("shared_data")).c_str());
+        PPK_ASSERT_ERROR(!data.HasParseError());
+        return data;
+    }
+
+    void machines_copy_is_independent()
+    {
+        SharedData shared;
+        r::Document data = simulation_begins_data();
+        unique_ptr<Machines> first(shared.make_machines(data["compute_resources"], 0.5));
+        unique_ptr<Machines> second(shared.make_machines(data["compute_resources"], 0.5));
+        PPK_ASSERT_ERROR(first->nb_machines() == 8 && second->nb_machines() == 8);
+        PPK_ASSERT_ERROR(first->nb_prefixes() == 2 && second->nb_prefixes() == 2);
+
+        //the prefixes point to the machines of their own copy
+        for (Machines * machines : {first.get(), second.get()})
+        {
+            Machines * other = machines == first.get() ? second.get() : first.get();
+            for (int prefix_id = 0; prefix_id < machines->nb_prefixes(); ++prefix_id)
+            {
+                const Prefix & prefix = machines->prefix(prefix_id);
+                PPK_ASSERT_ERROR(prefix.machinesInPrefix.size() == 4, "prefix %s", prefix.name.c_str());
+                for (Machine * machine : prefix.machinesInPrefix)
+                {
+                    PPK_ASSERT_ERROR(machine == (*machines)[machine->id],
+                                     "machine %s of prefix %s is not in its copy", machine->name.c_str(), prefix.name.c_str());
+                    PPK_ASSERT_ERROR(machine != (*other)[machine->id],
+                                     "machine %s is shared by both copies", machine->name.c_str());
+                    PPK_ASSERT_ERROR(machine->prefix_id == prefix_id);
+                }
+            }
+        }
+
+        //a machine changed in one copy is unchanged in the other
+        (*first)("b", 5)->cores_available = 0;
+        (*first)[2]->repair_time = 1234;
+        PPK_ASSERT_ERROR((*second)("b", 5)->cores_available == (*second)("b", 5)->core_count / 2);
+        PPK_ASSERT_ERROR((*second)[2]->repair_time != 1234);
+        PPK_ASSERT_ERROR((*first)["b5"] == (*first)("b", 5) && (*second)["b5"] == (*second)("b", 5));
+
+        //the copies outlive the shared data they were made from
+        unique_ptr<Machines> third;
+        {
+            SharedData short_lived;
+            third.reset(short_lived.make_machines(data["compute_resources"], 1.0));
+        }
+        PPK_ASSERT_ERROR(third->nb_machines() == 8 && (*third)("a", 3)->cores_available == (*third)("a", 3)->core_count);
+    }
+
+    void repeated_keys_are_cached()
+    {
+        SharedData shared;
+        r::Document data = simulation_begins_data();
+        unique_ptr<Machines> machines(shared.make_machines(data["compute_resources"], 1.0));
+        PPK_ASSERT_ERROR(shared.nb_hits() == 0);
+        machines.reset(shared.make_machines(data["compute_resources"], 1.0));
+        PPK_ASSERT_ERROR(shared.nb_hits() == 1);
+        //another core percent is another platform
+        machines.reset(shared.make_machines(data["compute_resources"], 0.5));
+        PPK_ASSERT_ERROR(shared.nb_hits() == 1);
+        PPK_ASSERT_ERROR((*machines)[0]->cores_available == (*machines)[0]->core_count / 2);
+
+        const string topology_file = unit::data_file("topologies/two_racks.json");
+        const r::Document & topology = shared.topology(topology_file);
+        PPK_ASSERT_ERROR(&shared.topology(topology_file) == &topology, "The topology was parsed again");
+        PPK_ASSERT_ERROR(shared.nb_hits() == 2);
+
+        const string failure_file = unit::output_folder("shared_data_failures") + "/failures.txt";
+        {
+            ofstream file(failure_file);
+            file << "100.0 ||FAILURE SMTBF\n100.0 ||machine_down: 3\n250.5 ||machine_down: 5\n";
+        }
+        map<double,batsched_tools::failure_tuple> failures = shared.failure_map(failure_file);
+        PPK_ASSERT_ERROR(failures.size() == 2 && failures.at(250.5).machine_down == 5);
+        PPK_ASSERT_ERROR(shared.nb_hits() == 2);
+        //the file is read once: changing it does not change the map
+        {
+            ofstream file(failure_file);
+            file << "100.0 ||FAILURE SMTBF\n";
+        }
+        map<double,batsched_tools::failure_tuple> cached = shared.failure_map(failure_file);
+        PPK_ASSERT_ERROR(cached.size() == 2 && cached.at(100.0).machine_down == 3 && cached.at(250.5).machine_down == 5);
+        PPK_ASSERT_ERROR(shared.nb_hits() == 3);
+    }
+
+    void scheduler_serves_a_single_simulation()
+    {
+        SharedData shared;
+        SchedulerOptions options;
+        options.variant = "conservative_bf";
+        options.shared_data = &shared;
+        Scheduler scheduler(options);
+        SyntheticOptions synthetic_options;
+        synthetic_options.nb_machines = 8;
+        const string folder = unit::output_folder("scheduler_serves_a_single_simulation");
+
+        r::Document begins;
+        unit::add_event(begins, 0, "SIMULATION_BEGINS", SyntheticSimulator::simulation_begins_data(synthetic_options, folder));
+        scheduler.decide(0, begins);
+
+        r::Document begins_again;
+        unit::add_event(begins_again, 10, "SIMULATION_BEGINS", SyntheticSimulator::simulation_begins_data(synthetic_options, folder));
+        bool rejected = false;
+        try
+        {
+            scheduler.decide(10, begins_again);
+        }
+        catch (const pempek::assert::AssertionException &)
+        {
+            rejected = true;
+        }
+        PPK_ASSERT_ERROR(rejected, "A second SIMULATION_BEGINS was accepted");
+    }
+}
+
+void unit::add_shared_data_tests(vector<Test> & tests)
+{
+    tests.push_back({"shared_data/machines_copy_is_independent", machines_copy_is_independent});
+    tests.push_back({"shared_data/repeated_keys_are_cached", repeated_keys_are_cached});
+    tests.push_back({"shared_data/scheduler_serves_a_single_simulation", scheduler_serves_a_single_simulation});
+}